@@ -42,11 +42,26 @@ software or the use or other dealings in the Software.
 #endif
 
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdlib>
 #include <vector>
+#include <array>
+#include <optional>
 #include <set>
+#include <map>
+#include <unordered_set>
 #include <unordered_map>
 #include <type_traits>
+#include <tuple>
+#include <functional>
 #include <typeinfo>
+#include <new>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <string>
 #include <assert.h>
 
 //-----------------------------------------------------------------------------
@@ -59,6 +74,7 @@ namespace mirror {
 	// Forward Declarations & Types
 	//-----------------------------------------------------------------------------
 	typedef size_t TypeID;
+	typedef uint32_t TypeGroupID;
 	class TypeSet;
 	class Type;
 	class Class;
@@ -66,15 +82,27 @@ namespace mirror {
 	class Pointer;
 	class StaticFunction;
 	class FixedSizeArray;
+	class Sequence;
+	class Associative;
+	class Optional;
 	class ClassMember;
+	class Method;
+	class Constructor;
 	class EnumValue;
 	class VirtualTypeWrapper;
+	template <typename T, typename IsShallow = void> class TVirtualTypeWrapper;
 	struct MetaData;
 	struct MetaDataSet;
+	struct StaticRegistration;
 
 	typedef void* (*AllocateFunction)(size_t _size, void* _userData);
+	typedef void (*InstantiateCallback)(const Type* _type, void* _instance, void* _userData);
+	typedef void (*MethodInvoker)(void* _instance, void** _arguments, void* _returnValue);
+	typedef void (*ConstructorInvoker)(void* _memory, void** _arguments);
+	typedef void (*BatchConstructorInvoker)(void* _memory, size_t _count, void** _argumentColumns);
 
 	const TypeID UNDEFINED_TYPEID = 0;
+	const TypeGroupID NO_TYPEGROUP = 0;
 
 	//-----------------------------------------------------------------------------
 	// Enums
@@ -102,6 +130,9 @@ namespace mirror {
 		TypeInfo_FixedSizeArray,
 		TypeInfo_StaticFunction,
 		TypeInfo_Custom,
+		TypeInfo_Sequence,
+		TypeInfo_Associative,
+		TypeInfo_Optional,
 
 		TypeInfo_COUNT,
 	};
@@ -116,10 +147,33 @@ namespace mirror {
 	MIRROR_API uint32_t HashCString(const char* _str);
 	MIRROR_API const char* TypeInfoToString(TypeInfo _type);
 
+	// Integers of 1, 2, 4 or 8 bytes at possibly unaligned addresses, such as integer members and enums of any underlying type
+	MIRROR_API int64_t ReadInteger(const void* _data, size_t _size, bool _isSigned = true);
+	MIRROR_API void WriteInteger(void* _data, size_t _size, int64_t _value); // truncated to _size bytes
+	MIRROR_API int64_t TruncateInteger(int64_t _value, size_t _size); // as stored in _size bytes and read back sign extended
+
+	// Runs _task(0) to _task(_taskCount - 1) on the calling thread and a pool of persistent worker threads, and returns once they are all done.
+	// At most _threadCount tasks run at once (0 uses every hardware thread). RunParallel calls made from a task run on the calling thread.
+	MIRROR_API void RunParallel(size_t _taskCount, const std::function<void(size_t)>& _task, size_t _threadCount = 0);
+
 	//-----------------------------------------------------------------------------
 	// Global Functions
 	//-----------------------------------------------------------------------------
+	// Types are initialized on first access, InitNewTypes initializes all registered types at once
 	MIRROR_API void InitNewTypes();
+	MIRROR_API std::thread InitNewTypesAsync(); // Warms up all registered types from a background thread, the returned thread must be joined or detached
+
+	// Types registered by the calling thread between BeginTypeGroup and EndTypeGroup belong to the group, typically everything a module registers while loaded,
+	// including the types created on demand for its members (containers, optionals, functions...). Beginning a group with the name of an existing one reloads it.
+	MIRROR_API TypeGroupID BeginTypeGroup(const char* _name);
+	MIRROR_API void EndTypeGroup();
+	// Removes and deletes the types of the group created by static registration or on demand, the others are removed by their module's global destructors.
+	// To be called before unloading the module, in both registration modes.
+	MIRROR_API void UnloadTypeGroup(TypeGroupID _group);
+	MIRROR_API void InitTypeGroup(TypeGroupID _group);
+
+	// Called after every successful Type::instantiate, can be used to track live instances (see mirror_census.h)
+	MIRROR_API void SetInstantiateCallback(InstantiateCallback _callback, void* _userData = nullptr);
 
 	template <typename T> constexpr TypeID GetTypeID();
 	template <typename T> constexpr TypeID GetTypeID(T&);
@@ -136,6 +190,12 @@ namespace mirror {
 
 	template <typename DestType, typename SourceType> DestType Cast(SourceType _o);
 
+	// Static visitation of the members declared with MIRROR_CLASS, the MIRROR_CLASS declaration must be visible from the calling code.
+	// The visitor is called with a StaticClassMember descriptor and a reference to the member: _visitor(auto _member, auto& _value)
+	template <typename T, typename Visitor> void ForEachMember(T& _object, Visitor&& _visitor);
+	template <typename T, typename Visitor> constexpr void ForEachStaticMember(Visitor&& _visitor);
+	template <typename T> constexpr size_t GetStaticMemberCount();
+
 	MIRROR_API Type* FindTypeByName(const char* _name);
 	MIRROR_API Class* FindClassByName(const char* _name);
 	MIRROR_API Type* FindTypeByID(TypeID _id);
@@ -145,6 +205,13 @@ namespace mirror {
 	MIRROR_API Pointer* AsPointer(TypeID _id);
 	MIRROR_API StaticFunction* AsStaticFunction(TypeID _id);
 	MIRROR_API FixedSizeArray* AsFixedSizeArray(TypeID _id);
+	MIRROR_API Sequence* AsSequence(TypeID _id);
+	MIRROR_API Associative* AsAssociative(TypeID _id);
+	MIRROR_API Optional* AsOptional(TypeID _id);
+
+	// Class of the object at _instance when _type is a polymorphic class declaring MIRROR_GETCLASS_VIRTUAL(), _type otherwise.
+	// The object is expected to start at _instance, as with single inheritance.
+	MIRROR_API const Type* GetDynamicType(const Type* _type, void* _instance);
 
     MIRROR_API TypeSet& GetTypeSet();
 
@@ -174,15 +241,61 @@ namespace mirror {
 		const MetaData* findMetaData(const char* _key) const;
 
 	// internal
+		// The string is copied, and only parsed on first access
 		MetaDataSet(const char* _metaDataString);
 		MetaDataSet(const MetaDataSet& _other);
-		MetaDataSet& operator=(const MetaDataSet& _other) = default;
-		std::unordered_map<uint32_t, MetaData> m_metaData;
+		MetaDataSet& operator=(const MetaDataSet& _other);
+		void parse() const;
+
+		std::string m_metaDataString;
+		mutable std::atomic<bool> m_parsed = { false };
+		mutable std::unordered_map<uint32_t, MetaData> m_metaData;
 	};
 
 	//-----------------------------------------------------------------------------
 	// TypeSet
 	//-----------------------------------------------------------------------------
+	// Lookups (findTypeByID, findTypeByName) never lock and can run concurrently with registrations.
+	// Registrations, removals and initializations are serialized by the TypeSet mutex.
+	// A removed type is not returned by lookups anymore, but pointers obtained before stay valid as long as its owner keeps it alive.
+
+	// Open addressing map that can be read without locking while a single writer modifies it.
+	// Keys are never erased from a table: removing a type leaves its key with a null value, which is reused if the key comes back.
+	// Replaced tables are kept until destruction so that concurrent readers never access freed memory.
+	class MIRROR_API ConcurrentTypeMap
+	{
+	public:
+		ConcurrentTypeMap();
+		~ConcurrentTypeMap();
+
+		Type* find(size_t _key) const;
+
+		// Writer only
+		void set(size_t _key, Type* _type);
+		void reserve(size_t _count); // number of types the map can hold without rehashing
+
+	// internal
+		struct Slot
+		{
+			std::atomic<size_t> key;
+			std::atomic<Type*> value;
+		};
+
+		struct Table
+		{
+			size_t capacity; // power of two
+			Slot* slots;
+		};
+
+		static size_t Mix(size_t _key);
+		Table* createTable(size_t _capacity);
+
+		std::atomic<Table*> m_table;
+		std::atomic<Type*> m_zeroKeyValue; // 0 marks empty slots
+		std::vector<Table*> m_retiredTables;
+		size_t m_usedSlotCount = 0; // including removed keys
+		size_t m_count = 0;
+	};
 
 	class MIRROR_API TypeSet
 	{
@@ -190,25 +303,179 @@ namespace mirror {
 		~TypeSet();
 
 		Type* findTypeByID(TypeID _typeID) const;
+		// Names given at creation (classes, enums, fundamental types...) are indexed on registration. Names built from other
+		// types (pointers, arrays, containers) are only known once the type is initialized, e.g. after its first getName().
 		Type* findTypeByName(const char* _name) const;
 
 		void addType(Type* _type);
 		void addTypeName(Type* _type, const char* _name);
 		void removeType(Type* _type);
+		void registerStaticTypes(const StaticRegistration* _begin, const StaticRegistration* _end);
 
+		// Registers _type unless a type with the same ID is already there, and returns the registered one. The TypeSet takes ownership of _type.
+		// Lets several threads create the same type concurrently, the losers are expected to delete their instance.
+		Type* findOrAddType(Type* _type);
+
+		// Not safe to iterate while other threads register or remove types
 		const std::set<Type*>& getTypes() const;
 
+		void initType(Type* _type);
 		void initNewTypes();
 
+		TypeGroupID beginTypeGroup(const char* _name);
+		void endTypeGroup();
+		void unloadTypeGroup(TypeGroupID _group);
+		void initTypeGroup(TypeGroupID _group);
+		uint32_t getTypeGroupGeneration(TypeGroupID _group) const; // number of times the group has been loaded
+		uint32_t getGeneration() const { return m_generation; } // changes every time a registered type is added, removed or replaced
+
 	//private:
+		// Using dlls can result in multiple registrations of the same type. The first one is the registered type, the others are kept
+		// to replace it if it is removed first (e.g. when the module that registered it first is unloaded).
+		struct Registration
+		{
+			Type* type;
+			TypeGroupID group;
+			bool owned; // created by static registration or on demand, deleted when its group is unloaded
+		};
+
+		struct TypeGroup
+		{
+			std::string name;
+			uint32_t generation = 0;
+			std::set<Type*> types;
+		};
+
+		void addRegistration(Type* _type, bool _owned);
+		void installType(Type* _type);
+		void uninstallType(Type* _type);
+		void indexTypeName(Type* _type);
+		void linkClass(Class* _class);
+		void unlinkClass(Class* _class);
+		static TypeGroupID& CurrentTypeGroup();
+
+		mutable std::recursive_mutex m_mutex;
 		std::set<Type*> m_types;
-		std::unordered_map<TypeID, Type*> m_typesByID;
-		std::unordered_map<TypeID, int> m_typesRegistrationCount;
-		std::unordered_map<uint32_t, Type*> m_typesByName;
+		ConcurrentTypeMap m_typesByID;
+		std::unordered_map<TypeID, std::vector<Registration>> m_registrations;
+		std::vector<TypeGroup> m_groups; // indexed by TypeGroupID - 1
+		std::atomic<uint32_t> m_generation = { 0 };
+		ConcurrentTypeMap m_typesByName;
+		std::vector<TypeID> m_typesToInit; // registered types that initNewTypes has not initialized yet
+		std::unordered_map<TypeID, std::set<TypeID>> m_orphanChildren; // children of classes that are not registered yet
 	};
 
 	extern TypeSet* g_typeSetPtr;
 
+	//-----------------------------------------------------------------------------
+	// Type Caches
+	//-----------------------------------------------------------------------------
+	// Tools compile types into structures (blend plans, bitpack codecs...) that are cached per type. A cached structure records the types it was
+	// built from, and is rebuilt once one of them is removed or replaced (e.g. when its type group is reloaded). Structures are shared, so that
+	// the holders of a replaced one can keep using it.
+
+	class MIRROR_API TypeDependencies
+	{
+	public:
+		void add(const Type* _type);
+		void add(const TypeDependencies& _dependencies);
+		bool isValid() const; // false once one of the types is not the registered one anymore
+
+	// internal
+		struct Dependency
+		{
+			TypeID typeID;
+			const Type* type;
+			uint32_t installGeneration;
+		};
+
+		std::vector<Dependency> m_dependencies;
+	};
+
+	// T is built from a type with T(const Type*), and exposes its dependencies with getDependencies()
+	template <typename T>
+	class TypeCache
+	{
+	public:
+		std::shared_ptr<const T> get(const Type* _type)
+		{
+			assert(_type != nullptr);
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			uint32_t generation = GetTypeSet().getGeneration();
+			if (generation != m_generation)
+			{
+				for (auto it = m_entries.begin(); it != m_entries.end();)
+				{
+					it = it->second->getDependencies().isValid() ? std::next(it) : m_entries.erase(it);
+				}
+				m_generation = generation;
+			}
+
+			std::shared_ptr<const T>& entry = m_entries[_type];
+			if (entry == nullptr)
+			{
+				entry = std::make_shared<const T>(_type);
+			}
+			return entry;
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::unordered_map<const Type*, std::shared_ptr<const T>> m_entries;
+		uint32_t m_generation = 0;
+	};
+
+	//-----------------------------------------------------------------------------
+	// Static Registration
+	//-----------------------------------------------------------------------------
+	// When MIRROR_STATIC_REGISTRATION is defined (it must be defined for the whole project), reflection macros don't create global objects
+	// anymore. They place constant records in a dedicated linker section instead, and types are created from that table in one pass the first
+	// time the TypeSet is accessed. Modules loaded at runtime have their own table and must call RegisterStaticTypes() once loaded.
+
+	struct StaticRegistration
+	{
+		TypeID (*getTypeID)();
+		Type* (*create)();
+	};
+
+	template <typename T> struct StaticClassTag {};
+	template <typename T> Type* StaticClassCreator() { return CreateStaticClass(StaticClassTag<T>()); }
+
+#ifdef MIRROR_STATIC_REGISTRATION
+#if defined(_MSC_VER)
+	#pragma section("mirror$a", read)
+	#pragma section("mirror$m", read)
+	#pragma section("mirror$z", read)
+	#define MIRROR_STATIC_REGISTRATION_SECTION __declspec(allocate("mirror$m"))
+
+	// Sections are sorted by name after the $, so everything in mirror$m lives between these two markers
+	__declspec(allocate("mirror$a")) __declspec(selectany) extern const StaticRegistration g_staticRegistrationsBegin = { nullptr, nullptr };
+	__declspec(allocate("mirror$z")) __declspec(selectany) extern const StaticRegistration g_staticRegistrationsEnd = { nullptr, nullptr };
+
+	// static so that each module iterates its own table
+	static inline void RegisterStaticTypes()
+	{
+		GetTypeSet().registerStaticTypes(&g_staticRegistrationsBegin + 1, &g_staticRegistrationsEnd);
+	}
+#elif defined(__GNUC__) && !defined(__APPLE__)
+	#define MIRROR_STATIC_REGISTRATION_SECTION __attribute__((used, section("mirror_types")))
+
+	// Defined by the linker for each module, around the mirror_types section.
+	// Records must not be inline variables: GCC puts all the comdat variables of a section in the same group, which breaks their deduplication.
+	extern "C" const StaticRegistration __start_mirror_types[] __attribute__((weak, visibility("hidden")));
+	extern "C" const StaticRegistration __stop_mirror_types[] __attribute__((weak, visibility("hidden")));
+
+	// static so that each module iterates its own table
+	static inline void RegisterStaticTypes()
+	{
+		GetTypeSet().registerStaticTypes(__start_mirror_types, __stop_mirror_types);
+	}
+#else
+	#error "MIRROR_STATIC_REGISTRATION is not supported on this platform"
+#endif
+#endif
+
 	//-----------------------------------------------------------------------------
 	// Type
 	//-----------------------------------------------------------------------------
@@ -222,28 +489,41 @@ namespace mirror {
 		bool isCustomType(const char* _customTypeName) const;
 		TypeID getTypeID() const;
 		size_t getSize() const;
+		size_t getAlignment() const;
+		bool isTriviallyCopyable() const; // instances can be copied with memcpy
+		bool isCopyConstructible() const;
 
 		const Class* asClass() const;
 		const Enum* asEnum() const;
 		const Pointer* asPointer() const;
 		const StaticFunction* asStaticFunction() const;
 		const FixedSizeArray* asFixedSizeArray() const;
+		const Sequence* asSequence() const;
+		const Associative* asAssociative() const;
+		const Optional* asOptional() const;
 
 		Class* asClass();
 		Enum* asEnum();
 		Pointer* asPointer();
 		StaticFunction* asStaticFunction();
 		FixedSizeArray* asFixedSizeArray();
+		Sequence* asSequence();
+		Associative* asAssociative();
+		Optional* asOptional();
 
 		// @TODO(2021/02/15|Remi): Allow the user to choose their allocator
 		bool hasFactory() const;
 		void* instantiate(AllocateFunction _allocateFunction = nullptr, void* _userData = nullptr) const;
+		void destruct(void* _instances, size_t _count = 1) const; // Calls the destructor of contiguous instances, without freeing their memory
+		void copyConstruct(void* _destination, const void* _source, size_t _count = 1) const; // Copy constructs contiguous instances into uninitialized memory
+
+		// Called by the accessors that depend on init (such as getName), custom types may need to call it too
+		void ensureInitialized() const;
 
 	// internal
 		void setName(const char* _name);
 		void setCustomTypeName(const char* _name);
 
-		virtual void shutdown();
 		virtual void init();
 
 		Type(TypeInfo _typeInfo);
@@ -255,7 +535,8 @@ namespace mirror {
 		char* m_customTypeName = nullptr;
 		TypeInfo m_typeInfo = TypeInfo_none;
 		VirtualTypeWrapper* m_virtualTypeWrapper = nullptr;
-		bool m_initialized = false;
+		std::atomic<bool> m_initialized = { false };
+		uint32_t m_installGeneration = 0; // TypeSet generation when the type was last registered, guarded by the TypeSet mutex
 	};
 
 
@@ -265,15 +546,23 @@ namespace mirror {
 	public:
 		TypeID getTypeID() const { return m_typeID; }
 		size_t getSize() const { return m_size; }
+		size_t getAlignment() const { return m_alignment; }
+		bool isTriviallyCopyable() const { return m_triviallyCopyable; }
+		bool isCopyConstructible() const { return m_copyConstructible; }
 
 		virtual bool hasFactory() const { return false; }
 		virtual void* instantiate(AllocateFunction _allocateFunction = nullptr, void* _userData = nullptr) const { return nullptr; }
+		virtual void destruct(void*, size_t) const { assert(false && "type can't be destroyed"); }
+		virtual void copyConstruct(void*, const void*, size_t) const { assert(false && "type can't be copied"); }
 
 		virtual Class* unsafeVirtualGetClass(void* _object) const { return nullptr; }
 
 		virtual ~VirtualTypeWrapper() {}
 		TypeID m_typeID = UNDEFINED_TYPEID;
 		size_t m_size = 0;
+		size_t m_alignment = 1;
+		bool m_triviallyCopyable = false;
+		bool m_copyConstructible = false;
 	};
 
 	//-----------------------------------------------------------------------------
@@ -290,33 +579,56 @@ namespace mirror {
 		void getMembers(std::vector<ClassMember*>& _outMemberList, bool _includeInheritedMembers = true) const;
 		ClassMember* findMemberByName(const char* _name, bool _includeInheritedMembers = true) const;
 
+		std::vector<Method*> getMethods(bool _includeInheritedMethods = true) const;
+		Method* findMethodByName(const char* _name, bool _includeInheritedMethods = true) const;
+
+		// Constructors are not inherited
+		const std::vector<Constructor*>& getConstructors() const;
+		Constructor* findConstructor(const TypeID* _argumentTypes, size_t _argumentCount) const;
+		template <typename... Args> Constructor* findConstructor() const
+		{
+			TypeID argumentTypes[] = { GetTypeID<typename std::remove_cv<typename std::remove_reference<Args>::type>::type>()..., UNDEFINED_TYPEID };
+			return findConstructor(argumentTypes, sizeof...(Args));
+		}
+
 		Class* getParent() const;
 		TypeID getParentID() const;
 		const std::set<TypeID>& getParents() const;
-		const std::set<TypeID>& getChildren() const;
+		std::set<TypeID> getChildren() const; // copied under the TypeSet lock, children change when classes are registered or removed
 
 		bool isChildOf(const Class* _class, bool _checkSelf = true) const;
 
 		const MetaDataSet& getMetaDataSet() const;
 
+		// Default constructed instance, created by the first call. Null for classes without factory.
+		// Serializers can compare members against it to skip the ones that keep their default value.
+		const void* getDefaultInstance() const;
+		void resetToDefault(void* _instances, size_t _count = 1) const; // Copies the default instance over contiguous constructed instances
+
 		Class* unsafeVirtualGetClass(void* _object) const;
 
 	// internal
+		void releaseDefaultInstance();
+
 		void addMember(ClassMember* _member);
+		void addMethod(Method* _method);
+		void addConstructor(Constructor* _constructor);
 		void addParent(TypeID _parent);
 		Class(const char* _name, const char* _metaDataString);
 		Class(const char* _name, const MetaDataSet& _metaDataSet);
 
-		virtual void shutdown() override;
-		virtual void init() override;
-
 		virtual ~Class();
 
-		std::set<TypeID> m_parents;
-		std::set<TypeID> m_children;
+		std::set<TypeID> m_parents; // set before the class is registered, then read without lock
+		std::set<TypeID> m_children; // guarded by the TypeSet lock
 		std::vector<ClassMember*> m_members;
 		std::unordered_map<uint32_t, ClassMember*> m_membersByName;
+		std::vector<Method*> m_methods;
+		std::unordered_map<uint32_t, Method*> m_methodsByName;
+		std::vector<Constructor*> m_constructors;
 		MetaDataSet m_metaDataSet;
+		mutable void* m_defaultInstance = nullptr;
+		mutable std::atomic<bool> m_hasDefaultInstance = { false }; // set once m_defaultInstance is created, guarded by the TypeSet lock
 	};
 
 	class MIRROR_API ClassMember
@@ -341,6 +653,66 @@ namespace mirror {
 		MetaDataSet m_metaDataSet;
 	};
 
+	// --- Method
+	// Member or static function of a class, called through a type-erased thunk.
+	// _arguments[i] points to the value of the i-th argument (arguments taken by value are copied, rvalue references are moved from).
+	// _returnValue points to uninitialized storage for the return type, it is constructed in place and destroying it is up to the caller.
+	// Methods returning a reference write a pointer to the referenced object instead. _returnValue can be null to discard the result.
+	class MIRROR_API Method
+	{
+	public:
+		const char* getName() const;
+		Class* getOwnerClass() const;
+		bool isStatic() const { return m_isStatic; }
+		bool isConst() const { return m_isConst; }
+		bool returnsReference() const { return m_returnsReference; }
+
+		Type* getReturnType() const;
+		size_t getArgumentCount() const { return m_argumentTypes.size(); }
+		Type* getArgumentType(size_t _index) const;
+		const MetaDataSet& getMetaDataSet() const;
+
+		void invoke(void* _instance, void** _arguments, void* _returnValue) const { m_invoker(_instance, _arguments, _returnValue); } // _instance is ignored by static methods
+		MethodInvoker getInvoker() const { return m_invoker; }
+
+	// internal
+		Method(const char* _name, MethodInvoker _invoker, TypeID _returnType, std::vector<TypeID>&& _argumentTypes, bool _isStatic, bool _isConst, bool _returnsReference, const char* _metaDataString);
+		~Method();
+
+		Class* m_ownerClass = nullptr;
+		char* m_name;
+		MethodInvoker m_invoker;
+		TypeID m_returnType = UNDEFINED_TYPEID;
+		std::vector<TypeID> m_argumentTypes;
+		bool m_isStatic;
+		bool m_isConst;
+		bool m_returnsReference;
+		MetaDataSet m_metaDataSet;
+	};
+
+	// --- Constructor
+	// Constructs instances in place, in caller-provided memory. Arguments are given like for methods.
+	class MIRROR_API Constructor
+	{
+	public:
+		Class* getOwnerClass() const;
+		size_t getArgumentCount() const { return m_argumentTypes.size(); }
+		Type* getArgumentType(size_t _index) const;
+
+		void construct(void* _memory, void** _arguments) const { m_invoker(_memory, _arguments); }
+
+		// Constructs _count contiguous instances. _argumentColumns[i] points to an array of _count values of the i-th argument type.
+		void constructBatch(void* _memory, size_t _count, void** _argumentColumns) const { m_batchInvoker(_memory, _count, _argumentColumns); }
+
+	// internal
+		Constructor(ConstructorInvoker _invoker, BatchConstructorInvoker _batchInvoker, std::vector<TypeID>&& _argumentTypes);
+
+		Class* m_ownerClass = nullptr;
+		ConstructorInvoker m_invoker;
+		BatchConstructorInvoker m_batchInvoker;
+		std::vector<TypeID> m_argumentTypes;
+	};
+
 	struct ClassInitializerBase {};
 	template <typename T> struct ClassInitializer : public ClassInitializerBase {};
 
@@ -408,6 +780,172 @@ namespace mirror {
 		size_t m_elementCount;
 	};
 
+	// --- Sequence
+	// Contiguous container, such as std::vector or std::array. Elements are accessed in bulk through spans, so going through a
+	// container costs one indirect call instead of one per element. User containers can be reflected as sequences from their CustomTypeFactory.
+	struct SequenceSpan
+	{
+		void* data = nullptr;
+		size_t count = 0;
+		size_t stride = 0;
+
+		void* at(size_t _index) const { return static_cast<uint8_t*>(data) + _index * stride; }
+	};
+
+	struct SequenceFunctions
+	{
+		size_t (*getCount)(const void* _sequence) = nullptr;
+		void* (*getData)(void* _sequence) = nullptr;
+
+		// Dynamic sequences only
+		void (*reserve)(void* _sequence, size_t _capacity) = nullptr;
+		void (*resize)(void* _sequence, size_t _count) = nullptr; // new elements are value-initialized
+		void (*resizeUninitialized)(void* _sequence, size_t _count) = nullptr; // optional, new elements are left uninitialized
+		void (*append)(void* _sequence, const void* _elements, size_t _count) = nullptr; // copies contiguous elements at the end
+		void (*erase)(void* _sequence, size_t _index, size_t _count) = nullptr;
+	};
+
+	class MIRROR_API Sequence : public Type
+	{
+	public:
+		Type* getSubType() const;
+		size_t getElementStride() const { return m_elementStride; }
+		bool isFixedSize() const { return m_isFixedSize; }
+		size_t getFixedCount() const { return m_fixedCount; }
+
+		size_t getCount(const void* _sequence) const { return m_functions.getCount(_sequence); }
+		void* getData(void* _sequence) const { return m_functions.getData(_sequence); }
+		SequenceSpan getSpan(void* _sequence) const;
+
+		// Dynamic sequences only
+		void reserve(void* _sequence, size_t _capacity) const;
+		void resize(void* _sequence, size_t _count) const;
+		void* resizeUninitialized(void* _sequence, size_t _count) const; // Only for trivially copyable elements, to be overwritten right away. Returns the data.
+		void append(void* _sequence, const void* _elements, size_t _count) const;
+		void erase(void* _sequence, size_t _index, size_t _count) const;
+		void clear(void* _sequence) const { resize(_sequence, 0); }
+
+	// internal
+		Sequence(TypeID _subType, size_t _elementStride, const char* _namePrefix, const SequenceFunctions& _functions, bool _isFixedSize = false, size_t _fixedCount = 0);
+		virtual void init() override;
+
+		TypeID m_subType = UNDEFINED_TYPEID;
+		size_t m_elementStride; // known at creation, the element type may not be reflected
+		const char* m_namePrefix; // null when the name is given at creation
+		bool m_hasCustomParameters = false; // non default allocator or traits, the type ID is appended to the name to keep it unique
+		bool m_isFixedSize;
+		size_t m_fixedCount;
+		SequenceFunctions m_functions;
+	};
+
+	// --- Associative
+	// Key/value container, such as std::unordered_map, or key only container (set), such as std::unordered_set.
+	// Keys and values are passed by pointer, and copied when inserted. For sets, values are null and find returns the stored key, which must not be modified.
+	struct AssociativeFunctions
+	{
+		size_t (*getCount)(const void* _container) = nullptr;
+		void (*clear)(void* _container) = nullptr;
+		void (*reserve)(void* _container, size_t _count) = nullptr; // optional
+		void* (*find)(void* _container, const void* _key) = nullptr; // returns the value, or null
+		void* (*insert)(void* _container, const void* _key, const void* _value) = nullptr; // overwrites the value of an existing key, returns the stored value. Null if the key or the value can't be copied.
+		bool (*erase)(void* _container, const void* _key) = nullptr;
+
+		// Batches work on packed arrays of keys and values, strided by the key and value sizes
+		void (*insertBatch)(void* _container, const void* _keys, const void* _values, size_t _count) = nullptr;
+		size_t (*findBatch)(void* _container, const void* _keys, size_t _count, void** _outValues) = nullptr; // returns the number of keys found
+
+		// Cursors read the content by batches, the iterator lives in the cursor storage
+		void (*beginCursor)(void* _container, void* _cursorStorage) = nullptr;
+		void (*destroyCursor)(void* _cursorStorage) = nullptr;
+		size_t (*readCursor)(void* _container, void* _cursorStorage, const void** _outKeys, void** _outValues, size_t _maxCount) = nullptr;
+	};
+
+	class MIRROR_API Associative : public Type
+	{
+	public:
+		Type* getKeyType() const;
+		Type* getValueType() const; // null for sets
+		size_t getKeyStride() const { return m_keyStride; }
+		size_t getValueStride() const { return m_valueStride; } // 0 for sets
+		bool isSet() const { return m_valueType == UNDEFINED_TYPEID; }
+		bool isOrdered() const { return m_isOrdered; }
+
+		size_t getCount(const void* _container) const { return m_functions.getCount(_container); }
+		void clear(void* _container) const { m_functions.clear(_container); }
+		void reserve(void* _container, size_t _count) const;
+		void* find(void* _container, const void* _key) const { return m_functions.find(_container, _key); }
+		void* insert(void* _container, const void* _key, const void* _value) const { assert(m_functions.insert != nullptr); return m_functions.insert(_container, _key, _value); }
+		bool erase(void* _container, const void* _key) const { return m_functions.erase(_container, _key); }
+
+		// Inserts _count keys and values from packed arrays (_values is ignored for sets), reserving room for all of them first
+		void insertBatch(void* _container, const void* _keys, const void* _values, size_t _count) const;
+		// Looks up _count keys from a packed array, _outValues receives the found values or null. Returns the number of keys found.
+		size_t findBatch(void* _container, const void* _keys, size_t _count, void** _outValues) const;
+
+	// internal
+		Associative(TypeID _keyType, size_t _keyStride, TypeID _valueType, size_t _valueStride, const char* _namePrefix, const AssociativeFunctions& _functions, bool _isOrdered = false);
+		virtual void init() override;
+
+		TypeID m_keyType = UNDEFINED_TYPEID;
+		TypeID m_valueType = UNDEFINED_TYPEID;
+		size_t m_keyStride; // known at creation, the key and value types may not be reflected
+		size_t m_valueStride;
+		const char* m_namePrefix;
+		bool m_hasCustomParameters = false; // non default hash, comparison or allocator, the type ID is appended to the name to keep it unique
+		bool m_isOrdered;
+		AssociativeFunctions m_functions;
+	};
+
+	// Iterates over an associative container, one indirect call per batch of entries.
+	// The container must not be modified while a cursor is alive.
+	class MIRROR_API AssociativeCursor
+	{
+	public:
+		AssociativeCursor(const Associative* _type, void* _container);
+		~AssociativeCursor();
+		AssociativeCursor(const AssociativeCursor&) = delete;
+		AssociativeCursor& operator=(const AssociativeCursor&) = delete;
+
+		// Returns the number of entries read, 0 once everything has been read. _outValues can be null.
+		size_t read(const void** _outKeys, void** _outValues, size_t _maxCount);
+
+	// internal
+		static constexpr size_t StorageSize = 64;
+
+		const Associative* m_type;
+		void* m_container;
+		alignas(std::max_align_t) uint8_t m_storage[StorageSize];
+	};
+
+	// --- Optional
+	struct OptionalFunctions
+	{
+		bool (*hasValue)(const void* _optional) = nullptr;
+		void* (*getValue)(void* _optional) = nullptr; // null when empty
+		void* (*emplace)(void* _optional) = nullptr; // value-initializes the value, returns it
+		void (*assign)(void* _optional, const void* _value) = nullptr; // copies the value
+		void (*reset)(void* _optional) = nullptr;
+	};
+
+	class MIRROR_API Optional : public Type
+	{
+	public:
+		Type* getSubType() const;
+
+		bool hasValue(const void* _optional) const { return m_functions.hasValue(_optional); }
+		void* getValue(void* _optional) const { return m_functions.getValue(_optional); }
+		void* emplace(void* _optional) const;
+		void assign(void* _optional, const void* _value) const;
+		void reset(void* _optional) const { m_functions.reset(_optional); }
+
+	// internal
+		Optional(TypeID _subType, const OptionalFunctions& _functions);
+		virtual void init() override;
+
+		TypeID m_subType = UNDEFINED_TYPEID;
+		OptionalFunctions m_functions;
+	};
+
 } // namespace mirror
 
 //*****************************************************************************
@@ -436,41 +974,71 @@ _Pragma("GCC diagnostic pop")
 // Public Macros
 //-----------------------------------------------------------------------------
 
+// The member declarations of a class are expanded in a Declare function template, that is instantiated once at startup to register the runtime
+// Class, and again by ForEachMember to visit the members of a statically known type without going through the runtime descriptors.
+// Everything is defined inside the class body, so MIRROR_CLASS can also be used in a header to make the static member list visible everywhere.
 #define MIRROR_CLASS(_class, ...) \
 namespace mirror { \
+__MIRROR_CLASS_STATIC_REGISTRATION(_class) \
 template <> \
 struct ClassInitializer<_class> : public ClassInitializerBase \
 { \
-	ClassInitializer(); \
-	~ClassInitializer() \
-	{ \
-		GetTypeSet().removeType(clss); \
-		delete clss; \
-		clss = nullptr; \
-	} \
-	Class* clss = nullptr;\
-}; \
-ClassInitializer<_class> MIRROR_CAT(initializer_,__LINE__); \
-\
-ClassInitializer<_class>::ClassInitializer() \
-{ \
-	const char* metaDataString = #__VA_ARGS__""; \
-	mirror::MetaDataSet metaDataSet(metaDataString); \
-	clss = new ::mirror::Class(#_class, metaDataSet); \
-	clss->createVirtualTypeWrapper<_class>(); \
-	char fakePrototype[sizeof(_class)] = {}; \
-	_class* prototypePtr = reinterpret_cast<_class*>(fakePrototype); \
-	(void)prototypePtr; \
+	using ClassType = _class; \
+	static const char* GetName() { return #_class; } \
+	static const char* GetMetaDataString() { return #__VA_ARGS__""; } \
+	template <typename Declarer> \
+	static constexpr void Declare(Declarer& _declarer) \
 	{ \
+		(void)_declarer; \
 		__MIRROR_CLASS_CONTENT
 
 #define __MIRROR_CLASS_CONTENT(...) \
 		__VA_ARGS__ \
 	} \
-	GetTypeSet().addType(clss); \
-} \
+	static Type* Create() \
+	{ \
+		Class* clss = new ::mirror::Class(GetName(), GetMetaDataString()); \
+		clss->createVirtualTypeWrapper<ClassType>(); \
+		::mirror::ClassDeclarer<ClassType> declarer(clss); \
+		Declare(declarer); \
+		return clss; \
+	} \
+	__MIRROR_CLASS_REGISTRATION \
+}; \
 } \
 
+#ifdef MIRROR_STATIC_REGISTRATION
+// The record can't be named after the class body, so it points to a function that is declared before and defined as a friend of the class
+#define __MIRROR_CLASS_STATIC_REGISTRATION(_class) \
+Type* CreateStaticClass(StaticClassTag<_class>); \
+MIRROR_STATIC_REGISTRATION_SECTION static const StaticRegistration MIRROR_CAT(s_classRegistration_, __LINE__) = { &GetTypeID<_class>, &StaticClassCreator<_class> }; \
+
+#define __MIRROR_CLASS_REGISTRATION \
+	friend Type* CreateStaticClass(StaticClassTag<ClassType>) { return Create(); } \
+
+#else
+#define __MIRROR_CLASS_STATIC_REGISTRATION(_class)
+
+#define __MIRROR_CLASS_REGISTRATION \
+	struct Registrar \
+	{ \
+		Registrar() \
+		{ \
+			type = Create(); \
+			GetTypeSet().addType(type); \
+		} \
+		~Registrar() \
+		{ \
+			GetTypeSet().removeType(type); \
+			delete type; \
+			type = nullptr; \
+		} \
+		Type* type = nullptr; \
+	}; \
+	static inline Registrar s_registrar; \
+
+#endif
+
 #define MIRROR_GETCLASS_VIRTUAL() \
 MIRROR_PUSH_DISABLE_WARNINGS \
 public: \
@@ -483,53 +1051,78 @@ public: \
 
 #define MIRROR_FRIEND() \
 	friend struct ::mirror::ClassInitializerBase; \
+	template <typename> friend struct ::mirror::ClassInitializer; \
 
+// The strings are given through a local type too, so that static member descriptors can expose them as constexpr data
 #define MIRROR_MEMBER(_memberName, ...) \
-	{ \
-		::mirror::GetType(prototypePtr->_memberName); \
-		size_t offset = reinterpret_cast<size_t>(&(prototypePtr->_memberName)) - reinterpret_cast<size_t>(prototypePtr); \
-		const char* memberName = #_memberName; \
-		const char* metaDataString = #__VA_ARGS__""; \
-		::mirror::ClassMember* classMember = new ::mirror::ClassMember(memberName, offset, ::mirror::GetTypeID(prototypePtr->_memberName), metaDataString); \
-		clss->addMember(classMember); \
-	} \
+		{ \
+			struct MemberStrings \
+			{ \
+				static constexpr const char* GetName() { return #_memberName; } \
+				static constexpr const char* GetMetaDataString() { return #__VA_ARGS__""; } \
+			}; \
+			_declarer.template addMember<decltype(&ClassType::_memberName), &ClassType::_memberName, MemberStrings>(#_memberName, #__VA_ARGS__""); \
+		} \
 
 #define MIRROR_PARENT(_parentClass) \
-	{ \
-		clss->addParent(::mirror::GetTypeID<_parentClass>()); \
-	} \
+		_declarer.template addParent<_parentClass>(); \
+
+// Overloaded methods can't be reflected, their address is ambiguous
+#define MIRROR_METHOD(_methodName, ...) \
+		_declarer.template addMethod<decltype(&ClassType::_methodName), &ClassType::_methodName>(#_methodName, #__VA_ARGS__""); \
+
+// Takes the argument types of the constructor, e.g. MIRROR_CONSTRUCTOR(int, const char*)
+#define MIRROR_CONSTRUCTOR(...) \
+		_declarer.template addConstructor<__VA_ARGS__>(); \
 
 #define MIRROR_ENUM(_enumName) \
 	namespace MIRROR_CAT(__Mirror, _enumName) { \
 	struct Initializer \
 	{\
-		mirror::Enum* enm = nullptr; \
-		~Initializer() \
-		{ \
-			::mirror::GetTypeSet().removeType(enm); \
-			delete enm; \
-		} \
-		Initializer() \
+		static ::mirror::TypeID GetEnumTypeID() { return ::mirror::GetTypeID<_enumName>(); } \
+		static ::mirror::Type* Create() \
 		{ \
 			using enumType = _enumName; \
-			::mirror::Type* subType; \
+			::mirror::TypeID subType = ::mirror::UNDEFINED_TYPEID; \
 			switch(sizeof(enumType)) { \
-				case 1: subType = ::mirror::TypeGetter<int8_t>::Get(); break; \
-				case 2: subType = ::mirror::TypeGetter<int16_t>::Get(); break; \
-				case 4: subType = ::mirror::TypeGetter<int32_t>::Get(); break; \
-				case 8: subType = ::mirror::TypeGetter<int64_t>::Get(); break; \
+				case 1: subType = ::mirror::GetTypeID<int8_t>(); break; \
+				case 2: subType = ::mirror::GetTypeID<int16_t>(); break; \
+				case 4: subType = ::mirror::GetTypeID<int32_t>(); break; \
+				case 8: subType = ::mirror::GetTypeID<int64_t>(); break; \
 			} \
-			enm = new ::mirror::Enum(#_enumName, subType->getTypeID()); \
+			::mirror::Enum* enm = new ::mirror::Enum(#_enumName, subType); \
 			enm->createVirtualTypeWrapper<enumType>(); \
 			__MIRROR_ENUM_CONTENT
 
 #define __MIRROR_ENUM_CONTENT(...) \
 			__VA_ARGS__ \
-			mirror::GetTypeSet().addType(enm); \
-		}\
-	} initializer; \
+			return enm; \
+		} \
+	__MIRROR_ENUM_REGISTRATION \
 	} // namespace __Mirror##_enumName
 
+#ifdef MIRROR_STATIC_REGISTRATION
+#define __MIRROR_ENUM_REGISTRATION \
+	}; \
+	MIRROR_STATIC_REGISTRATION_SECTION static const ::mirror::StaticRegistration registration = { &Initializer::GetEnumTypeID, &Initializer::Create }; \
+
+#else
+#define __MIRROR_ENUM_REGISTRATION \
+		Initializer() \
+		{ \
+			enm = Create(); \
+			::mirror::GetTypeSet().addType(enm); \
+		} \
+		~Initializer() \
+		{ \
+			::mirror::GetTypeSet().removeType(enm); \
+			delete enm; \
+		} \
+		::mirror::Type* enm = nullptr; \
+	} initializer; \
+
+#endif
+
 #define MIRROR_ENUM_VALUE(_enumValue) \
 		enm->addValue(new ::mirror::EnumValue(#_enumValue, int64_t(_enumValue))); \
 
@@ -572,7 +1165,16 @@ namespace mirror {
 	//-----------------------------------------------------------------------------
 	// Virtual Type Wrapper
 	//-----------------------------------------------------------------------------
-	template <typename T, typename IsShallow = void>
+	// Polymorphic classes declaring MIRROR_GETCLASS_VIRTUAL() can tell the dynamic class of an instance
+	template <typename T, typename = void>
+	struct HasVirtualGetClass : std::false_type {};
+
+	template <typename T>
+	struct HasVirtualGetClass<T, decltype(void(std::declval<const T&>().getClass()))> : std::is_polymorphic<T> {};
+
+	template <typename T, size_t Depth = 0> constexpr bool IsCopyConstructible();
+
+	template <typename T, typename IsShallow>
 	class TVirtualTypeWrapper : public VirtualTypeWrapper
 	{
 	public:
@@ -580,6 +1182,9 @@ namespace mirror {
 		{
 			m_typeID = GetTypeID<T>();
 			m_size = sizeof(T);
+			m_alignment = alignof(T);
+			m_triviallyCopyable = std::is_trivially_copyable<T>::value;
+			m_copyConstructible = IsCopyConstructible<T>();
 		}
 
 		virtual bool hasFactory() const override { return true; }
@@ -596,6 +1201,54 @@ namespace mirror {
 				return memory;
 			}
 		}
+
+		virtual void destruct(void* _instances, size_t _count) const override
+		{
+			// Arrays are destroyed element by element
+			using ElementType = typename std::remove_all_extents<T>::type;
+			ElementType* instances = static_cast<ElementType*>(_instances);
+			size_t count = _count * (sizeof(T) / sizeof(ElementType));
+			for (size_t i = 0; i < count; ++i)
+			{
+				instances[i].~ElementType();
+			}
+		}
+
+		virtual void copyConstruct(void* _destination, const void* _source, size_t _count) const override
+		{
+			using ElementType = typename std::remove_all_extents<T>::type;
+			if constexpr (std::is_trivially_copyable<ElementType>::value)
+			{
+				memcpy(_destination, _source, _count * sizeof(T));
+			}
+			else if constexpr (IsCopyConstructible<ElementType>())
+			{
+				ElementType* destination = static_cast<ElementType*>(_destination);
+				const ElementType* source = static_cast<const ElementType*>(_source);
+				size_t count = _count * (sizeof(T) / sizeof(ElementType));
+				for (size_t i = 0; i < count; ++i)
+				{
+					new (destination + i) ElementType(source[i]);
+				}
+			}
+			else
+			{
+				assert(false && "type is not copy constructible");
+			}
+		}
+
+		virtual Class* unsafeVirtualGetClass(void* _object) const override
+		{
+			if constexpr (HasVirtualGetClass<T>::value)
+			{
+				return static_cast<T*>(_object)->getClass();
+			}
+			else
+			{
+				(void)_object;
+				return nullptr;
+			}
+		}
 	};
 
 	template <typename T>
@@ -639,7 +1292,14 @@ namespace mirror {
 				if (typeDesc != nullptr)
 				{
 					typeDesc->createVirtualTypeWrapper<T>();
-					GetTypeSet().addType(typeDesc);
+
+					// Another thread may have created it in the meantime
+					Type* registeredType = GetTypeSet().findOrAddType(typeDesc);
+					if (registeredType != typeDesc)
+					{
+						delete typeDesc;
+						typeDesc = registeredType;
+					}
 				}
 			}
 			return typeDesc;
@@ -680,7 +1340,8 @@ namespace mirror {
         PointerInitializer()
         {
             using type = typename std::remove_pointer<T>::type;
-            typeDesc = new Pointer(TypeGetter<type>::Get()->getTypeID());
+            TypeGetter<type>::Get(); // Ensures that subType reflection is correctly initialized, but it may not be registered yet (e.g. a class pointing to itself)
+            typeDesc = new Pointer(GetTypeID<type>());
 			typeDesc->createVirtualTypeWrapper<T>();
             GetTypeSet().addType(typeDesc);
         }
@@ -723,15 +1384,327 @@ namespace mirror {
 		}
 	};
 
-	// Type Desc Accesors
-	template<typename T>
-    Enum* GetEnum()
-    {
-        Type* type = TypeGetter<T>::Get();
-        if (type->getTypeInfo() != TypeInfo_Enum)
-            return nullptr;
+	// --- Standard containers
+	template <typename T, typename Allocator>
+	struct CustomTypeFactory<std::vector<T, Allocator>>
+	{
+		using VectorType = std::vector<T, Allocator>;
 
-        return static_cast<Enum*>(type);
+		static Type* Create()
+		{
+			// std::vector<bool> is not contiguous
+			if constexpr (std::is_same<T, bool>::value)
+			{
+				return nullptr;
+			}
+			else
+			{
+				SequenceFunctions functions;
+				functions.getCount = [](const void* _sequence) -> size_t { return static_cast<const VectorType*>(_sequence)->size(); };
+				functions.getData = [](void* _sequence) -> void* { return static_cast<VectorType*>(_sequence)->data(); };
+				functions.reserve = [](void* _sequence, size_t _capacity) { static_cast<VectorType*>(_sequence)->reserve(_capacity); };
+				functions.erase = [](void* _sequence, size_t _index, size_t _count)
+				{
+					VectorType* vector = static_cast<VectorType*>(_sequence);
+					vector->erase(vector->begin() + _index, vector->begin() + _index + _count);
+				};
+				if constexpr (std::is_default_constructible<T>::value)
+				{
+					functions.resize = [](void* _sequence, size_t _count) { static_cast<VectorType*>(_sequence)->resize(_count); };
+				}
+				if constexpr (IsCopyConstructible<T>())
+				{
+					functions.append = [](void* _sequence, const void* _elements, size_t _count)
+					{
+						const T* elements = static_cast<const T*>(_elements);
+						VectorType* vector = static_cast<VectorType*>(_sequence);
+						vector->insert(vector->end(), elements, elements + _count);
+					};
+				}
+
+				GetType<T>(); // Ensures that subType reflection is correctly initialized
+				Sequence* sequence = new Sequence(GetTypeID<T>(), sizeof(T), "vector", functions);
+				sequence->m_hasCustomParameters = !std::is_same<Allocator, std::allocator<T>>::value;
+				return sequence;
+			}
+		}
+	};
+
+	template <typename CharT, typename Traits, typename Allocator>
+	struct CustomTypeFactory<std::basic_string<CharT, Traits, Allocator>>
+	{
+		using StringType = std::basic_string<CharT, Traits, Allocator>;
+
+		static Type* Create()
+		{
+			SequenceFunctions functions;
+			functions.getCount = [](const void* _sequence) -> size_t { return static_cast<const StringType*>(_sequence)->size(); };
+			functions.getData = [](void* _sequence) -> void* { return &(*static_cast<StringType*>(_sequence))[0]; };
+			functions.reserve = [](void* _sequence, size_t _capacity) { static_cast<StringType*>(_sequence)->reserve(_capacity); };
+			functions.resize = [](void* _sequence, size_t _count) { static_cast<StringType*>(_sequence)->resize(_count); };
+			functions.append = [](void* _sequence, const void* _elements, size_t _count) { static_cast<StringType*>(_sequence)->append(static_cast<const CharT*>(_elements), _count); };
+			functions.erase = [](void* _sequence, size_t _index, size_t _count) { static_cast<StringType*>(_sequence)->erase(_index, _count); };
+
+			GetType<CharT>();
+			if (std::is_same<StringType, std::string>::value)
+			{
+				Sequence* sequence = new Sequence(GetTypeID<CharT>(), sizeof(CharT), nullptr, functions);
+				sequence->setName("string");
+				return sequence;
+			}
+			Sequence* sequence = new Sequence(GetTypeID<CharT>(), sizeof(CharT), "basic_string", functions);
+			sequence->m_hasCustomParameters = !std::is_same<StringType, std::basic_string<CharT>>::value;
+			return sequence;
+		}
+	};
+
+	template <typename T>
+	struct CustomTypeFactory<std::optional<T>>
+	{
+		using OptionalType = std::optional<T>;
+
+		static Type* Create()
+		{
+			OptionalFunctions functions;
+			functions.hasValue = [](const void* _optional) { return static_cast<const OptionalType*>(_optional)->has_value(); };
+			functions.getValue = [](void* _optional) -> void*
+			{
+				OptionalType* optional = static_cast<OptionalType*>(_optional);
+				return optional->has_value() ? &optional->value() : nullptr;
+			};
+			functions.reset = [](void* _optional) { static_cast<OptionalType*>(_optional)->reset(); };
+			if constexpr (std::is_default_constructible<T>::value)
+			{
+				functions.emplace = [](void* _optional) -> void* { return &static_cast<OptionalType*>(_optional)->emplace(); };
+			}
+			if constexpr (IsCopyConstructible<T>() && std::is_copy_assignable<T>::value)
+			{
+				functions.assign = [](void* _optional, const void* _value) { *static_cast<OptionalType*>(_optional) = *static_cast<const T*>(_value); };
+			}
+
+			GetType<T>();
+			return new Optional(GetTypeID<T>(), functions);
+		}
+	};
+
+	// Builds the function table of standard maps (Value is the mapped type) and sets (Value is void)
+	template <typename Container, typename Key, typename Value>
+	struct AssociativeFunctionsBuilder
+	{
+		static constexpr bool IsSet = std::is_void<Value>::value;
+		static constexpr bool IsCopyable = IsCopyConstructible<Key>() && (IsSet || (IsCopyConstructible<Value>() && std::is_copy_assignable<Value>::value));
+		using Iterator = typename Container::iterator;
+		static_assert(sizeof(Iterator) <= AssociativeCursor::StorageSize, "The iterator does not fit in the cursor storage");
+
+		static void* GetValue(Iterator _it)
+		{
+			if constexpr (IsSet)
+			{
+				return const_cast<Key*>(&*_it);
+			}
+			else
+			{
+				return &_it->second;
+			}
+		}
+
+		static void* Insert(Container* _container, const Key& _key, const void* _value)
+		{
+			if constexpr (IsSet)
+			{
+				return GetValue(_container->insert(_key).first);
+			}
+			else
+			{
+				return GetValue(_container->insert_or_assign(_key, *static_cast<const Value*>(_value)).first);
+			}
+		}
+
+		static AssociativeFunctions Build()
+		{
+			AssociativeFunctions functions;
+			functions.getCount = [](const void* _container) -> size_t { return static_cast<const Container*>(_container)->size(); };
+			functions.clear = [](void* _container) { static_cast<Container*>(_container)->clear(); };
+			functions.find = [](void* _container, const void* _key) -> void*
+			{
+				Container* container = static_cast<Container*>(_container);
+				auto it = container->find(*static_cast<const Key*>(_key));
+				return it != container->end() ? GetValue(it) : nullptr;
+			};
+			functions.erase = [](void* _container, const void* _key) { return static_cast<Container*>(_container)->erase(*static_cast<const Key*>(_key)) > 0; };
+			if constexpr (IsCopyable)
+			{
+				functions.insert = [](void* _container, const void* _key, const void* _value) -> void*
+				{
+					return Insert(static_cast<Container*>(_container), *static_cast<const Key*>(_key), _value);
+				};
+				functions.insertBatch = [](void* _container, const void* _keys, const void* _values, size_t _count)
+				{
+					Container* container = static_cast<Container*>(_container);
+					const Key* keys = static_cast<const Key*>(_keys);
+					for (size_t i = 0; i < _count; ++i)
+					{
+						if constexpr (IsSet)
+						{
+							container->insert(keys[i]);
+						}
+						else
+						{
+							container->insert_or_assign(keys[i], static_cast<const Value*>(_values)[i]);
+						}
+					}
+				};
+			}
+			functions.findBatch = [](void* _container, const void* _keys, size_t _count, void** _outValues) -> size_t
+			{
+				Container* container = static_cast<Container*>(_container);
+				const Key* keys = static_cast<const Key*>(_keys);
+				size_t foundCount = 0;
+				for (size_t i = 0; i < _count; ++i)
+				{
+					auto it = container->find(keys[i]);
+					if (it != container->end())
+					{
+						_outValues[i] = GetValue(it);
+						++foundCount;
+					}
+					else
+					{
+						_outValues[i] = nullptr;
+					}
+				}
+				return foundCount;
+			};
+			functions.beginCursor = [](void* _container, void* _cursorStorage) { new (_cursorStorage) Iterator(static_cast<Container*>(_container)->begin()); };
+			functions.destroyCursor = [](void* _cursorStorage) { static_cast<Iterator*>(_cursorStorage)->~Iterator(); };
+			functions.readCursor = [](void* _container, void* _cursorStorage, const void** _outKeys, void** _outValues, size_t _maxCount) -> size_t
+			{
+				Container* container = static_cast<Container*>(_container);
+				Iterator& it = *static_cast<Iterator*>(_cursorStorage);
+				size_t count = 0;
+				for (; count < _maxCount && it != container->end(); ++count, ++it)
+				{
+					if constexpr (IsSet)
+					{
+						_outKeys[count] = &*it;
+						if (_outValues != nullptr)
+						{
+							_outValues[count] = nullptr;
+						}
+					}
+					else
+					{
+						_outKeys[count] = &it->first;
+						if (_outValues != nullptr)
+						{
+							_outValues[count] = &it->second;
+						}
+					}
+				}
+				return count;
+			};
+			return functions;
+		}
+
+		static Type* Create(const char* _namePrefix, bool _isOrdered)
+		{
+			AssociativeFunctions functions = Build();
+			if constexpr (!IsSet)
+			{
+				GetType<Value>();
+			}
+			GetType<Key>();
+
+			if constexpr (IsSet)
+			{
+				return new Associative(GetTypeID<Key>(), sizeof(Key), UNDEFINED_TYPEID, 0, _namePrefix, functions, _isOrdered);
+			}
+			else
+			{
+				return new Associative(GetTypeID<Key>(), sizeof(Key), GetTypeID<Value>(), sizeof(Value), _namePrefix, functions, _isOrdered);
+			}
+		}
+	};
+
+	template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+	struct CustomTypeFactory<std::unordered_map<Key, Value, Hash, KeyEqual, Allocator>>
+	{
+		using MapType = std::unordered_map<Key, Value, Hash, KeyEqual, Allocator>;
+
+		static Type* Create()
+		{
+			Associative* associative = static_cast<Associative*>(AssociativeFunctionsBuilder<MapType, Key, Value>::Create("unordered_map", false));
+			associative->m_functions.reserve = [](void* _container, size_t _count) { static_cast<MapType*>(_container)->reserve(_count); };
+			associative->m_hasCustomParameters = !std::is_same<MapType, std::unordered_map<Key, Value>>::value;
+			return associative;
+		}
+	};
+
+	template <typename Key, typename Hash, typename KeyEqual, typename Allocator>
+	struct CustomTypeFactory<std::unordered_set<Key, Hash, KeyEqual, Allocator>>
+	{
+		using SetType = std::unordered_set<Key, Hash, KeyEqual, Allocator>;
+
+		static Type* Create()
+		{
+			Associative* associative = static_cast<Associative*>(AssociativeFunctionsBuilder<SetType, Key, void>::Create("unordered_set", false));
+			associative->m_functions.reserve = [](void* _container, size_t _count) { static_cast<SetType*>(_container)->reserve(_count); };
+			associative->m_hasCustomParameters = !std::is_same<SetType, std::unordered_set<Key>>::value;
+			return associative;
+		}
+	};
+
+	template <typename Key, typename Value, typename Compare, typename Allocator>
+	struct CustomTypeFactory<std::map<Key, Value, Compare, Allocator>>
+	{
+		using MapType = std::map<Key, Value, Compare, Allocator>;
+
+		static Type* Create()
+		{
+			Associative* associative = static_cast<Associative*>(AssociativeFunctionsBuilder<MapType, Key, Value>::Create("map", true));
+			associative->m_hasCustomParameters = !std::is_same<MapType, std::map<Key, Value>>::value;
+			return associative;
+		}
+	};
+
+	template <typename Key, typename Compare, typename Allocator>
+	struct CustomTypeFactory<std::set<Key, Compare, Allocator>>
+	{
+		using SetType = std::set<Key, Compare, Allocator>;
+
+		static Type* Create()
+		{
+			Associative* associative = static_cast<Associative*>(AssociativeFunctionsBuilder<SetType, Key, void>::Create("set", true));
+			associative->m_hasCustomParameters = !std::is_same<SetType, std::set<Key>>::value;
+			return associative;
+		}
+	};
+
+	template <typename T, size_t N>
+	struct CustomTypeFactory<std::array<T, N>>
+	{
+		using ArrayType = std::array<T, N>;
+
+		static Type* Create()
+		{
+			SequenceFunctions functions;
+			functions.getCount = [](const void*) -> size_t { return N; };
+			functions.getData = [](void* _sequence) -> void* { return static_cast<ArrayType*>(_sequence)->data(); };
+
+			GetType<T>();
+			return new Sequence(GetTypeID<T>(), sizeof(T), "stdarray", functions, true, N);
+		}
+	};
+
+	// Type Desc Accesors
+	template<typename T>
+    Enum* GetEnum()
+    {
+        Type* type = TypeGetter<T>::Get();
+        if (type->getTypeInfo() != TypeInfo_Enum)
+            return nullptr;
+
+        return static_cast<Enum*>(type);
     }
 
     template<typename T>
@@ -769,107 +1742,521 @@ namespace mirror {
 		return GetClass<T>();
 	}
 
-	// --- Cast
-	template <typename DestType, typename SourceType, typename IsDestLastPointer = void, typename IsSourceLastPointer = void>
-	struct CastClassesUnpiler
+	// --- Class declaration
+	template <typename T>
+	struct MemberPointerTraits {};
+
+	template <typename C, typename M>
+	struct MemberPointerTraits<M C::*>
 	{
-		static_assert(std::is_pointer<DestType>::value, "Mismatching pointer count between cast source and cast destination (DestType is not a pointer).");
-		static_assert(std::is_pointer<SourceType>::value, "Mismatching pointer count between cast source and cast destination (SourceType is not a pointer).");
+		using ClassType = C;
+		using MemberType = M;
+	};
 
-		static bool Unpile(SourceType& _o, Class** _destClass, Class** _sourceClass)
+	constexpr bool StaticMetaDataHasKey(const char* _metaDataString, const char* _key)
+	{
+		// Same grammar as MetaDataSet: comma separated "key" or "key = value", spaces around keys are ignored
+		const char* cur = _metaDataString;
+		while (*cur != 0)
 		{
-			using source_t = typename std::remove_pointer<SourceType>::type;
-			using dest_t   = typename std::remove_pointer<DestType>::type;
-			return CastClassesUnpiler<dest_t, source_t>::Unpile(*_o, _destClass, _sourceClass);
+			while (*cur == ' ') ++cur;
+			const char* k = _key;
+			while (*k != 0 && *cur == *k) { ++cur; ++k; }
+			if (*k == 0)
+			{
+				while (*cur == ' ') ++cur;
+				if (*cur == 0 || *cur == ',' || *cur == '=')
+					return true;
+			}
+			while (*cur != 0 && *cur != ',') ++cur;
+			if (*cur == ',') ++cur;
 		}
+		return false;
+	}
+
+	template <typename MemberPointer, MemberPointer Pointer, typename Strings>
+	struct StaticClassMember
+	{
+		using ClassType = typename MemberPointerTraits<MemberPointer>::ClassType;
+		using MemberType = typename MemberPointerTraits<MemberPointer>::MemberType;
+		static constexpr MemberPointer pointer = Pointer;
+		static constexpr const char* name = Strings::GetName();
+		static constexpr const char* metaDataString = Strings::GetMetaDataString();
+
+		static constexpr bool hasMetaData(const char* _key) { return StaticMetaDataHasKey(metaDataString, _key); }
 	};
 
-	template <typename DestType, typename SourceType>
-	struct CastClassesUnpiler<DestType, SourceType, std::enable_if_t<!std::is_pointer<DestType>::value>, std::enable_if_t<!std::is_pointer<SourceType>::value>>
+	template <typename T>
+	struct MethodTraits {};
+
+	template <typename R, typename... Args>
+	struct MethodTraits<R(*)(Args...)>
 	{
-		static bool Unpile(SourceType& _o, Class** _destClass, Class** _sourceClass)
-		{
-			*_destClass = GetClass<DestType>();
-			*_sourceClass = _o.getClass();
+		using ClassType = void;
+		using ReturnType = R;
+		using Arguments = std::tuple<Args...>;
+		static constexpr bool isStatic = true;
+		static constexpr bool isConst = false;
+	};
 
-			return true;
-		}
+	template <typename R, typename... Args>
+	struct MethodTraits<R(*)(Args...) noexcept> : MethodTraits<R(*)(Args...)> {};
+
+	template <typename C, typename R, typename... Args>
+	struct MethodTraits<R(C::*)(Args...)>
+	{
+		using ClassType = C;
+		using ReturnType = R;
+		using Arguments = std::tuple<Args...>;
+		static constexpr bool isStatic = false;
+		static constexpr bool isConst = false;
 	};
 
-	template <typename DestType, typename SourceType>
-	DestType Cast(SourceType _o)
+	template <typename C, typename R, typename... Args>
+	struct MethodTraits<R(C::*)(Args...) const> : MethodTraits<R(C::*)(Args...)>
 	{
-		Class* destClass = nullptr;
-		Class* sourceClass = nullptr;
-		if (CastClassesUnpiler<DestType, SourceType>::Unpile(_o, &destClass, &sourceClass))
+		using ClassType = const C;
+		static constexpr bool isConst = true;
+	};
+
+	template <typename C, typename R, typename... Args>
+	struct MethodTraits<R(C::*)(Args...) noexcept> : MethodTraits<R(C::*)(Args...)> {};
+
+	template <typename C, typename R, typename... Args>
+	struct MethodTraits<R(C::*)(Args...) const noexcept> : MethodTraits<R(C::*)(Args...) const> {};
+
+	template <typename T>
+	using MethodValue_T = typename std::remove_cv<typename std::remove_reference<T>::type>::type;
+
+	// Arguments passed by value or lvalue reference are given as lvalues (so by-value arguments are copied), rvalue references are moved from
+	template <typename Argument>
+	using ForwardedArgument_T = typename std::conditional<std::is_rvalue_reference<Argument>::value, Argument, typename std::remove_reference<Argument>::type&>::type;
+
+	template <typename Argument>
+	ForwardedArgument_T<Argument> GetArgument(void* _argument)
+	{
+		using ValueType = typename std::remove_reference<Argument>::type;
+		return static_cast<ForwardedArgument_T<Argument>>(*static_cast<ValueType*>(_argument));
+	}
+
+	// Generated once per reflected method, the arguments are forwarded straight from the pointer array without building any intermediate tuple
+	template <typename MethodPointer, MethodPointer Pointer>
+	struct MethodThunk
+	{
+		using Traits = MethodTraits<MethodPointer>;
+		using ReturnType = typename Traits::ReturnType;
+
+		template <size_t... I>
+		static ReturnType Call(void* _instance, void** _arguments, std::index_sequence<I...>)
 		{
-			if (destClass != nullptr && sourceClass != nullptr)
+			(void)_instance;
+			(void)_arguments;
+			if constexpr (Traits::isStatic)
 			{
-				if (destClass->isChildOf(sourceClass) // upcast
-				|| sourceClass->isChildOf(destClass)) // downcast
+				return Pointer(GetArgument<typename std::tuple_element<I, typename Traits::Arguments>::type>(_arguments[I])...);
+			}
+			else
+			{
+				using ClassType = typename Traits::ClassType;
+				return (static_cast<ClassType*>(_instance)->*Pointer)(GetArgument<typename std::tuple_element<I, typename Traits::Arguments>::type>(_arguments[I])...);
+			}
+		}
+
+		static void Invoke(void* _instance, void** _arguments, void* _returnValue)
+		{
+			auto indices = std::make_index_sequence<std::tuple_size<typename Traits::Arguments>::value>();
+			if constexpr (std::is_void<ReturnType>::value)
+			{
+				(void)_returnValue;
+				Call(_instance, _arguments, indices);
+			}
+			else if constexpr (std::is_reference<ReturnType>::value)
+			{
+				auto* result = &Call(_instance, _arguments, indices);
+				if (_returnValue != nullptr)
 				{
-					return reinterpret_cast<DestType>(_o);
+					*static_cast<decltype(result)*>(_returnValue) = result;
 				}
 			}
+			else if (_returnValue != nullptr)
+			{
+				new (_returnValue) ReturnType(Call(_instance, _arguments, indices));
+			}
+			else
+			{
+				Call(_instance, _arguments, indices);
+			}
 		}
-		return nullptr;
-	}
+	};
 
-	// --- Enum
-	template <typename T>
-	bool Enum::getValueFromString(const char* _string, T& _outValue) const
+	template <typename T, typename... Args>
+	struct ConstructorThunk
 	{
-		if (_string == nullptr)
-			return false;
-
-		size_t hash = HashCString(_string);
-		auto it = m_valuesByNameHash.find(hash);
-		if (it != m_valuesByNameHash.end())
+		template <size_t... I>
+		static void Construct(void* _memory, void** _arguments, std::index_sequence<I...>)
 		{
-			_outValue = static_cast<T>(it->second->getValue());
-			return true;
+			(void)_arguments;
+			new (_memory) T(GetArgument<Args>(_arguments[I])...);
 		}
-		return false;
-	}
 
-	template <typename T>
-	bool Enum::getStringFromValue(T _value, const char*& _outString) const
-	{
-		int64_t value = static_cast<int64_t>(_value);
-		for (auto it = m_values.begin(); it != m_values.end(); ++it)
+		template <size_t... I>
+		static void ConstructBatch(void* _memory, size_t _count, void** _argumentColumns, std::index_sequence<I...>)
 		{
-			EnumValue* enumValue = *it;
-			if (enumValue->getValue() == value)
+			(void)_argumentColumns;
+			T* instances = static_cast<T*>(_memory);
+			for (size_t i = 0; i < _count; ++i)
 			{
-				_outString = enumValue->getName();
-				return true;
+				new (instances + i) T(GetArgument<Args>(static_cast<MethodValue_T<Args>*>(_argumentColumns[I]) + i)...);
 			}
 		}
-		return false;
-	}
-
-	//-----------------------------------------------------------------------------
-	// Types Initialization
-	//-----------------------------------------------------------------------------
 
-	template <typename T>
-	struct TypeInitializer
-	{
-		TypeInitializer(TypeInfo _typeInfo, const char* _name)
+		static void Invoke(void* _memory, void** _arguments)
 		{
-			typeDesc = new Type(_typeInfo, _name);
-			typeDesc->createVirtualTypeWrapper<T>();
-			GetTypeSet().addType(typeDesc);
+			Construct(_memory, _arguments, std::index_sequence_for<Args...>());
 		}
-		~TypeInitializer()
+
+		static void InvokeBatch(void* _memory, size_t _count, void** _argumentColumns)
 		{
-			GetTypeSet().removeType(typeDesc);
-			delete typeDesc;
+			ConstructBatch(_memory, _count, _argumentColumns, std::index_sequence_for<Args...>());
 		}
-		Type* typeDesc = nullptr;
 	};
 
-	#define TYPEDESCINITIALIZER_DECLARE(_type) extern TypeInitializer<_type> g_##_type##TypeInitializer
+	template <typename... Args>
+	std::vector<TypeID> GetArgumentTypeIDs(std::tuple<Args...>*)
+	{
+		// Ensures that the argument types are registered, like members
+		(void)std::initializer_list<int>{ (GetType<MethodValue_T<Args>>(), 0)... };
+		return std::vector<TypeID>{ GetTypeID<MethodValue_T<Args>>()... };
+	}
+
+	// Registers the members of a runtime Class
+	template <typename T>
+	struct ClassDeclarer
+	{
+		ClassDeclarer(Class* _class) : clss(_class) {}
+
+		template <typename MemberPointer, MemberPointer Pointer, typename Strings>
+		void addMember(const char* _name, const char* _metaDataString)
+		{
+			using MemberType = typename std::remove_cv<typename MemberPointerTraits<MemberPointer>::MemberType>::type;
+
+			GetType<MemberType>();
+			alignas(T) char fakePrototype[sizeof(T)] = {};
+			T* prototypePtr = reinterpret_cast<T*>(fakePrototype);
+			size_t offset = reinterpret_cast<size_t>(&(prototypePtr->*Pointer)) - reinterpret_cast<size_t>(prototypePtr);
+			clss->addMember(new ClassMember(_name, offset, GetTypeID<MemberType>(), _metaDataString));
+		}
+
+		template <typename MethodPointer, MethodPointer Pointer>
+		void addMethod(const char* _name, const char* _metaDataString)
+		{
+			using Traits = MethodTraits<MethodPointer>;
+			using ReturnType = MethodValue_T<typename Traits::ReturnType>;
+
+			GetType<ReturnType>();
+			std::vector<TypeID> argumentTypes = GetArgumentTypeIDs(static_cast<typename Traits::Arguments*>(nullptr));
+			bool returnsReference = std::is_reference<typename Traits::ReturnType>::value;
+			clss->addMethod(new Method(_name, &MethodThunk<MethodPointer, Pointer>::Invoke, GetTypeID<ReturnType>(), std::move(argumentTypes), Traits::isStatic, Traits::isConst, returnsReference, _metaDataString));
+		}
+
+		template <typename... Args>
+		void addConstructor()
+		{
+			std::vector<TypeID> argumentTypes = GetArgumentTypeIDs(static_cast<std::tuple<Args...>*>(nullptr));
+			clss->addConstructor(new Constructor(&ConstructorThunk<T, Args...>::Invoke, &ConstructorThunk<T, Args...>::InvokeBatch, std::move(argumentTypes)));
+		}
+
+		template <typename Parent>
+		void addParent()
+		{
+			clss->addParent(GetTypeID<Parent>());
+		}
+
+		Class* clss;
+	};
+
+	template <typename T, typename = void>
+	struct HasStaticMembers : std::false_type {};
+
+	template <typename T>
+	struct HasStaticMembers<T, decltype(void(&ClassInitializer<T>::GetMetaDataString))> : std::true_type {};
+
+	// --- Copyability
+	// std::is_copy_constructible is true for containers of move-only types (e.g. std::vector<std::unique_ptr<T>>) and for classes holding
+	// them, but their copy does not compile. IsCopyConstructible also looks into the elements of containers, the members of pairs and the
+	// members of classes whose MIRROR_CLASS declaration is visible. Recursive types are assumed copyable past a few levels.
+	static const size_t MAX_COPYABILITY_CHECK_DEPTH = 8;
+
+	template <typename T, typename = void>
+	struct HasValueType : std::false_type {};
+
+	template <typename T>
+	struct HasValueType<T, std::void_t<typename T::value_type>> : std::true_type {};
+
+	template <typename T, typename = void>
+	struct HasMappedType : std::false_type {};
+
+	template <typename T>
+	struct HasMappedType<T, std::void_t<typename T::key_type, typename T::mapped_type>> : std::true_type {};
+
+	template <typename T, typename = void>
+	struct IsPair : std::false_type {};
+
+	template <typename T>
+	struct IsPair<T, std::void_t<typename T::first_type, typename T::second_type>> : std::true_type {};
+
+	template <size_t Depth>
+	struct CopyConstructibleMembersChecker
+	{
+		template <typename MemberPointer, MemberPointer Pointer, typename Strings>
+		constexpr void addMember(const char*, const char*) { result = result && IsCopyConstructible<typename MemberPointerTraits<MemberPointer>::MemberType, Depth>(); }
+
+		template <typename MethodPointer, MethodPointer Pointer>
+		constexpr void addMethod(const char*, const char*) {}
+
+		template <typename... Args>
+		constexpr void addConstructor() {}
+
+		template <typename Parent>
+		constexpr void addParent() { result = result && IsCopyConstructible<Parent, Depth>(); }
+
+		bool result = true;
+	};
+
+	template <typename T, size_t Depth>
+	constexpr bool IsCopyConstructible()
+	{
+		using ValueType = typename std::remove_cv<typename std::remove_all_extents<T>::type>::type;
+		if constexpr (!std::is_copy_constructible<ValueType>::value)
+		{
+			return false;
+		}
+		else if constexpr (std::is_trivially_copyable<ValueType>::value || Depth >= MAX_COPYABILITY_CHECK_DEPTH)
+		{
+			return true;
+		}
+		else if constexpr (HasMappedType<ValueType>::value)
+		{
+			return IsCopyConstructible<typename ValueType::key_type, Depth + 1>() && IsCopyConstructible<typename ValueType::mapped_type, Depth + 1>();
+		}
+		else if constexpr (HasValueType<ValueType>::value)
+		{
+			return IsCopyConstructible<typename ValueType::value_type, Depth + 1>();
+		}
+		else if constexpr (IsPair<ValueType>::value)
+		{
+			return IsCopyConstructible<typename ValueType::first_type, Depth + 1>() && IsCopyConstructible<typename ValueType::second_type, Depth + 1>();
+		}
+		else if constexpr (HasStaticMembers<ValueType>::value)
+		{
+			CopyConstructibleMembersChecker<Depth + 1> checker;
+			ClassInitializer<ValueType>::Declare(checker);
+			return checker.result;
+		}
+		else
+		{
+			return true;
+		}
+	}
+
+	template <typename T, typename Visitor>
+	struct StaticMemberVisitor
+	{
+		template <typename MemberPointer, MemberPointer Pointer, typename Strings>
+		void addMember(const char*, const char*)
+		{
+			visitor(StaticClassMember<MemberPointer, Pointer, Strings>{}, object.*Pointer);
+		}
+
+		template <typename MethodPointer, MethodPointer Pointer>
+		void addMethod(const char*, const char*) {}
+
+		template <typename... Args>
+		void addConstructor() {}
+
+		template <typename Parent>
+		void addParent()
+		{
+			using ParentType = typename std::conditional<std::is_const<T>::value, const Parent, Parent>::type;
+			ForEachMember(static_cast<ParentType&>(object), visitor);
+		}
+
+		T& object;
+		Visitor& visitor;
+	};
+
+	template <typename Visitor>
+	struct StaticMemberDescriptorVisitor
+	{
+		template <typename MemberPointer, MemberPointer Pointer, typename Strings>
+		constexpr void addMember(const char*, const char*)
+		{
+			visitor(StaticClassMember<MemberPointer, Pointer, Strings>{});
+		}
+
+		template <typename MethodPointer, MethodPointer Pointer>
+		constexpr void addMethod(const char*, const char*) {}
+
+		template <typename... Args>
+		constexpr void addConstructor() {}
+
+		template <typename Parent>
+		constexpr void addParent()
+		{
+			ForEachStaticMember<Parent>(visitor);
+		}
+
+		Visitor& visitor;
+	};
+
+	struct StaticMemberCounter
+	{
+		template <typename MemberPointer, MemberPointer Pointer, typename Strings>
+		constexpr void addMember(const char*, const char*) { ++count; }
+
+		template <typename MethodPointer, MethodPointer Pointer>
+		constexpr void addMethod(const char*, const char*) {}
+
+		template <typename... Args>
+		constexpr void addConstructor() {}
+
+		template <typename Parent>
+		constexpr void addParent() { count += GetStaticMemberCount<Parent>(); }
+
+		size_t count = 0;
+	};
+
+	template <typename T, typename Visitor>
+	void ForEachMember(T& _object, Visitor&& _visitor)
+	{
+		using ClassType = typename std::remove_const<T>::type;
+		static_assert(HasStaticMembers<ClassType>::value, "The MIRROR_CLASS declaration of this type (or of one of its parents) is not visible from here.");
+
+		StaticMemberVisitor<T, Visitor> declarer{ _object, _visitor };
+		ClassInitializer<ClassType>::Declare(declarer);
+	}
+
+	template <typename T, typename Visitor>
+	constexpr void ForEachStaticMember(Visitor&& _visitor)
+	{
+		static_assert(HasStaticMembers<T>::value, "The MIRROR_CLASS declaration of this type (or of one of its parents) is not visible from here.");
+
+		StaticMemberDescriptorVisitor<Visitor> declarer{ _visitor };
+		ClassInitializer<T>::Declare(declarer);
+	}
+
+	template <typename T>
+	constexpr size_t GetStaticMemberCount()
+	{
+		static_assert(HasStaticMembers<T>::value, "The MIRROR_CLASS declaration of this type (or of one of its parents) is not visible from here.");
+
+		StaticMemberCounter counter;
+		ClassInitializer<T>::Declare(counter);
+		return counter.count;
+	}
+
+	// --- Cast
+	template <typename DestType, typename SourceType, typename IsDestLastPointer = void, typename IsSourceLastPointer = void>
+	struct CastClassesUnpiler
+	{
+		static_assert(std::is_pointer<DestType>::value, "Mismatching pointer count between cast source and cast destination (DestType is not a pointer).");
+		static_assert(std::is_pointer<SourceType>::value, "Mismatching pointer count between cast source and cast destination (SourceType is not a pointer).");
+
+		static bool Unpile(SourceType& _o, Class** _destClass, Class** _sourceClass)
+		{
+			using source_t = typename std::remove_pointer<SourceType>::type;
+			using dest_t   = typename std::remove_pointer<DestType>::type;
+			return CastClassesUnpiler<dest_t, source_t>::Unpile(*_o, _destClass, _sourceClass);
+		}
+	};
+
+	template <typename DestType, typename SourceType>
+	struct CastClassesUnpiler<DestType, SourceType, std::enable_if_t<!std::is_pointer<DestType>::value>, std::enable_if_t<!std::is_pointer<SourceType>::value>>
+	{
+		static bool Unpile(SourceType& _o, Class** _destClass, Class** _sourceClass)
+		{
+			*_destClass = GetClass<DestType>();
+			*_sourceClass = _o.getClass();
+
+			return true;
+		}
+	};
+
+	template <typename DestType, typename SourceType>
+	DestType Cast(SourceType _o)
+	{
+		Class* destClass = nullptr;
+		Class* sourceClass = nullptr;
+		if (CastClassesUnpiler<DestType, SourceType>::Unpile(_o, &destClass, &sourceClass))
+		{
+			if (destClass != nullptr && sourceClass != nullptr)
+			{
+				if (destClass->isChildOf(sourceClass) // upcast
+				|| sourceClass->isChildOf(destClass)) // downcast
+				{
+					return reinterpret_cast<DestType>(_o);
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	// --- Enum
+	template <typename T>
+	bool Enum::getValueFromString(const char* _string, T& _outValue) const
+	{
+		if (_string == nullptr)
+			return false;
+
+		size_t hash = HashCString(_string);
+		auto it = m_valuesByNameHash.find(hash);
+		if (it != m_valuesByNameHash.end())
+		{
+			_outValue = static_cast<T>(it->second->getValue());
+			return true;
+		}
+		return false;
+	}
+
+	template <typename T>
+	bool Enum::getStringFromValue(T _value, const char*& _outString) const
+	{
+		int64_t value = static_cast<int64_t>(_value);
+		for (auto it = m_values.begin(); it != m_values.end(); ++it)
+		{
+			EnumValue* enumValue = *it;
+			if (enumValue->getValue() == value)
+			{
+				_outString = enumValue->getName();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//-----------------------------------------------------------------------------
+	// Types Initialization
+	//-----------------------------------------------------------------------------
+
+	template <typename T>
+	struct TypeInitializer
+	{
+		TypeInitializer(TypeInfo _typeInfo, const char* _name)
+		{
+			typeDesc = new Type(_typeInfo, _name);
+			typeDesc->createVirtualTypeWrapper<T>();
+			GetTypeSet().addType(typeDesc);
+		}
+		~TypeInitializer()
+		{
+			GetTypeSet().removeType(typeDesc);
+			delete typeDesc;
+		}
+		Type* typeDesc = nullptr;
+	};
+
+#ifndef MIRROR_STATIC_REGISTRATION
+	#define TYPEDESCINITIALIZER_DECLARE(_type) extern TypeInitializer<_type> g_##_type##TypeInitializer
 
 	TYPEDESCINITIALIZER_DECLARE(void);
 	TYPEDESCINITIALIZER_DECLARE(bool);
@@ -886,6 +2273,7 @@ namespace mirror {
 	TYPEDESCINITIALIZER_DECLARE(double);
 
 	#undef TYPEDESCINITIALIZER_DECLARE
+#endif
 
 	// === Static Function (WIP) ===
 	// @TODO: refactor this so that we can have a full return type + argument type list at construction time, so that we can generate a unique name
@@ -921,552 +2309,1358 @@ namespace mirror {
 	template<typename NotAFunction>
 	struct FunctionTraits {}; /// #1
 
-	template<typename R, typename... Args>
-	struct FunctionTraits<R(*)(Args...)> {
-		using result = R;
-		using args = std::tuple<Args...>;
-	};
+	template<typename R, typename... Args>
+	struct FunctionTraits<R(*)(Args...)> {
+		using result = R;
+		using args = std::tuple<Args...>;
+	};
+
+	template<typename F>
+	using FunctionArguments_T = typename FunctionTraits<F>::args;
+
+	template <std::size_t N, typename F>
+	using FunctionArgument_T = typename std::tuple_element<N, FunctionArguments_T<F>>::type;
+
+	template <typename F, typename T, T I, T Top>
+	struct FunctionArgumentsUnpiler
+	{
+		static void Unpile(class StaticFunction* _function)
+		{
+			using ArgumentType = FunctionArgument_T<I, F>;
+			_function->addArgument<ArgumentType>();
+			FunctionArgumentsUnpiler<F, T, I + 1u, Top>::Unpile(_function);
+		}
+	};
+
+	template <typename F, typename T, T I>
+	struct FunctionArgumentsUnpiler<F, T, I, I>
+	{
+		static void Unpile(class StaticFunction* _function) {}
+	};
+
+	template<typename F>
+	FunctionArguments_T<F> MakeFunctionArgumentsTuple(F _function)
+	{
+		return FunctionArguments_T<F>{};
+	}
+
+	template<typename Function, typename Tuple, size_t ... I>
+	auto CallFunction(Function f, Tuple t, std::index_sequence<I ...>)
+	{
+		return f(std::get<I>(t) ...);
+	}
+
+	template<typename Function, typename Tuple>
+	auto CallFunction(Function f, Tuple t)
+	{
+		static constexpr auto size = std::tuple_size<Tuple>::value;
+		return CallFunction(f, t, std::make_index_sequence<size>{});
+	}
+
+	// Member names are resolved to offsets and checked against the argument types once, then the function can be called on any number of
+	// instances with its arguments read in place (arguments taken by reference refer directly to the members).
+	template <typename F>
+	struct ClassMembersBinding
+	{
+		using Result = typename FunctionTraits<F>::result;
+		using Arguments = typename FunctionTraits<F>::args;
+		static constexpr size_t ArgumentCount = std::tuple_size<Arguments>::value;
+
+		bool isValid() const { return function != nullptr; }
+
+		Result call(void* _instance) const
+		{
+			return Call(_instance, std::make_index_sequence<ArgumentCount>());
+		}
+
+		// _stride defaults to the size of the bound class. _outResults can be null, and is ignored for functions returning void.
+		void callBatch(void* _instances, size_t _instanceCount, size_t _stride = 0, Result* _outResults = nullptr) const
+		{
+			uint8_t* instance = static_cast<uint8_t*>(_instances);
+			size_t stride = _stride != 0 ? _stride : classSize;
+			for (size_t i = 0; i < _instanceCount; ++i, instance += stride)
+			{
+				if constexpr (std::is_void<Result>::value)
+				{
+					(void)_outResults;
+					call(instance);
+				}
+				else if (_outResults != nullptr)
+				{
+					_outResults[i] = call(instance);
+				}
+				else
+				{
+					call(instance);
+				}
+			}
+		}
+
+		template <size_t... I>
+		Result Call(void* _instance, std::index_sequence<I...>) const
+		{
+			assert(isValid());
+			uint8_t* base = static_cast<uint8_t*>(_instance);
+			(void)base;
+			return function(*reinterpret_cast<MethodValue_T<typename std::tuple_element<I, Arguments>::type>*>(base + offsets[I])...);
+		}
+
+		F function = nullptr;
+		size_t classSize = 0;
+		size_t offsets[ArgumentCount > 0 ? ArgumentCount : 1] = {};
+	};
+
+	template <size_t I, typename F>
+	bool BindClassMemberArgument(ClassMembersBinding<F>& _binding, const Class* _class, const char* _memberName)
+	{
+		using Argument_T = MethodValue_T<typename std::tuple_element<I, typename ClassMembersBinding<F>::Arguments>::type>;
+
+		ClassMember* member = _class->findMemberByName(_memberName);
+		assert(member != nullptr);
+		if (member == nullptr)
+			return false;
+
+		// Compared by ID so that binding does not depend on the argument type being registered
+		assert(member->m_typeInfo == GetTypeID<Argument_T>());
+		if (member->m_typeInfo != GetTypeID<Argument_T>())
+			return false;
+
+		_binding.offsets[I] = member->getOffset();
+		return true;
+	}
+
+	template <typename F, size_t... I>
+	bool BindClassMemberArguments(ClassMembersBinding<F>& _binding, const Class* _class, const char** _memberNames, std::index_sequence<I...>)
+	{
+		bool results[] = { true, BindClassMemberArgument<I>(_binding, _class, _memberNames[I])... };
+		for (bool result : results)
+		{
+			if (!result)
+				return false;
+		}
+		return true;
+	}
+
+	// Returns an invalid binding if a member is missing or does not match the type of its argument
+	template <typename F>
+	ClassMembersBinding<F> BindClassMembersToFunction(F _functionPointer, const Class* _class, const char** _memberNames, size_t _memberCount)
+	{
+		ClassMembersBinding<F> binding;
+		assert(_class != nullptr);
+		assert(_functionPointer != nullptr);
+		assert(ClassMembersBinding<F>::ArgumentCount == _memberCount);
+		if (_class == nullptr || ClassMembersBinding<F>::ArgumentCount != _memberCount)
+			return binding;
+
+		if (BindClassMemberArguments(binding, _class, _memberNames, std::make_index_sequence<ClassMembersBinding<F>::ArgumentCount>()))
+		{
+			binding.function = _functionPointer;
+			binding.classSize = _class->getSize();
+		}
+		return binding;
+	}
+
+	// One-shot version, prefer binding once with BindClassMembersToFunction when calling repeatedly.
+	// If a member is missing or does not match its argument, the function is not called and the result is value initialized
+	// (the program is aborted when the result can't be, e.g. for references).
+	template<typename F, typename C>
+	typename FunctionTraits<F>::result CallFunctionWithClassMembersAsArguments(F _functionPointer, C* _classInstance, const char** _memberNames, size_t _memberCount)
+	{
+		using Result = typename FunctionTraits<F>::result;
+		using ClassType = typename std::remove_const<C>::type;
+		assert(_classInstance != nullptr);
+
+		ClassMembersBinding<F> binding = BindClassMembersToFunction(_functionPointer, GetClass<ClassType>(), _memberNames, _memberCount);
+		if (!binding.isValid() || _classInstance == nullptr)
+		{
+			if constexpr (std::is_void<Result>::value)
+			{
+				return;
+			}
+			else if constexpr (!std::is_reference<Result>::value && std::is_default_constructible<Result>::value)
+			{
+				return Result();
+			}
+			else
+			{
+				std::abort();
+			}
+		}
+		return binding.call(const_cast<ClassType*>(_classInstance));
+	}
+
+	template <typename T>
+	struct TypeGetter<T, void, void, void, std::enable_if_t<std::is_function<T>::value>>
+	{
+		static Type* Get()
+		{
+			Type* typeDesc = GetTypeSet().findTypeByID(GetTypeID<T>());
+			if (typeDesc == nullptr)
+			{
+				using function_pointer_t = typename std::add_pointer<T>::type;
+
+				StaticFunction* staticFunction = new class StaticFunction();
+				staticFunction->createVirtualTypeWrapper<T>();
+
+				// Return type
+				using ReturnType = typename FunctionTraits<function_pointer_t>::result;
+				staticFunction->setReturnType<ReturnType>();
+
+				// Arguments
+				constexpr size_t argumentsCount = std::tuple_size<FunctionArguments_T<function_pointer_t>>::value;
+				FunctionArgumentsUnpiler<function_pointer_t, std::size_t, 0, argumentsCount>::Unpile(staticFunction);
+
+				// Another thread may have created it in the meantime
+				typeDesc = GetTypeSet().findOrAddType(staticFunction);
+				if (typeDesc != staticFunction)
+				{
+					delete staticFunction;
+				}
+			}
+			return typeDesc;
+		}
+	};
+
+	template <typename F>
+	StaticFunction* GetStaticFunctionType(F* _function)
+	{
+		return static_cast<StaticFunction*>(TypeGetter<F>::Get());
+	}
+
+} // namespace mirror
+
+// Include to add custom types in. Just '#define MIRROR_EXTENSION_FILE "myfilename.h"' from your build system
+#ifdef MIRROR_EXTENSION_FILE
+#include MIRROR_EXTENSION_FILE
+#endif
+
+//*****************************************************************************
+// Implementation
+//*****************************************************************************
+
+#ifdef MIRROR_IMPLEMENTATION
+
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <condition_variable>
+
+namespace mirror {
+
+	//-----------------------------------------------------------------------------
+	// Helpers & Tools
+	//-----------------------------------------------------------------------------
+
+	#define ALLOCATE_AND_COPY_STRING(_dst, _src) { _dst = (char*)malloc(strlen(_src) + 1); strcpy(_dst, _src); }
+
+	uint32_t Hash32(const void* _data, size_t _size)
+	{
+		const uint32_t OFFSET_BASIS = 2166136261;
+		const uint32_t FNV_PRIME = 16777619;
+
+		if (_size == 0)
+		{
+			return 0;
+		}
+
+		// FNV-1a algorithm
+		// http://isthe.com/chongo/tech/comp/fnv/
+		uint32_t hash = OFFSET_BASIS;
+		const uint8_t* buf = static_cast<const uint8_t*>(_data);
+		for (uint32_t i = 0u; i < _size; i++)
+		{
+			hash = hash * FNV_PRIME;
+			hash = hash ^ *buf;
+			++buf;
+		}
+		return hash;
+	}
+
+	uint32_t HashCString(const char* _str)
+	{
+		return Hash32(_str, strlen(_str));
+	}
+
+	int64_t ReadInteger(const void* _data, size_t _size, bool _isSigned)
+	{
+		switch (_size)
+		{
+			case 1: { uint8_t v; memcpy(&v, _data, 1); return _isSigned ? int64_t(int8_t(v)) : int64_t(v); }
+			case 2: { uint16_t v; memcpy(&v, _data, 2); return _isSigned ? int64_t(int16_t(v)) : int64_t(v); }
+			case 4: { uint32_t v; memcpy(&v, _data, 4); return _isSigned ? int64_t(int32_t(v)) : int64_t(v); }
+			case 8: { int64_t v; memcpy(&v, _data, 8); return v; }
+		}
+		return 0;
+	}
+
+	void WriteInteger(void* _data, size_t _size, int64_t _value)
+	{
+		// Little endian: the low bytes hold the truncated value
+		uint64_t value = uint64_t(_value);
+		switch (_size)
+		{
+			case 1: { uint8_t v = uint8_t(value); memcpy(_data, &v, 1); } break;
+			case 2: { uint16_t v = uint16_t(value); memcpy(_data, &v, 2); } break;
+			case 4: { uint32_t v = uint32_t(value); memcpy(_data, &v, 4); } break;
+			case 8: memcpy(_data, &value, 8); break;
+		}
+	}
+
+	int64_t TruncateInteger(int64_t _value, size_t _size)
+	{
+		uint8_t data[8];
+		WriteInteger(data, _size, _value);
+		return ReadInteger(data, _size, true);
+	}
+
+	// Workers are created on demand and wait for the next job, one job runs at a time
+	class ParallelTaskPool
+	{
+	public:
+		~ParallelTaskPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_isStopping = true;
+			}
+			m_wakeCondition.notify_all();
+			for (std::thread& worker : m_workers)
+			{
+				worker.join();
+			}
+		}
+
+		void run(size_t _taskCount, const std::function<void(size_t)>& _task, size_t _helperCount)
+		{
+			std::lock_guard<std::mutex> jobLock(m_jobMutex);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				while (m_workers.size() < _helperCount)
+				{
+					m_workers.emplace_back(&ParallelTaskPool::runWorker, this, m_workers.size());
+				}
+				m_task = &_task;
+				m_taskCount = _taskCount;
+				m_nextTask = 0;
+				m_helperCount = _helperCount;
+				m_busyHelperCount = _helperCount;
+				++m_jobID;
+			}
+			m_wakeCondition.notify_all();
+
+			runTasks();
+
+			// Every helper of the job takes part before the next one can start
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_doneCondition.wait(lock, [this]() { return m_busyHelperCount == 0; });
+		}
+
+		static bool& IsRunningTask()
+		{
+			static thread_local bool s_isRunningTask = false;
+			return s_isRunningTask;
+		}
+
+	private:
+		void runTasks()
+		{
+			IsRunningTask() = true;
+			for (size_t task = m_nextTask++; task < m_taskCount; task = m_nextTask++)
+			{
+				(*m_task)(task);
+			}
+			IsRunningTask() = false;
+		}
+
+		void runWorker(size_t _workerIndex)
+		{
+			uint64_t lastJobID = 0;
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while (true)
+			{
+				m_wakeCondition.wait(lock, [this, lastJobID]() { return m_isStopping || m_jobID != lastJobID; });
+				if (m_isStopping)
+					return;
+
+				lastJobID = m_jobID;
+				if (_workerIndex >= m_helperCount)
+					continue;
+
+				lock.unlock();
+				runTasks();
+				lock.lock();
+				if (--m_busyHelperCount == 0)
+				{
+					m_doneCondition.notify_all();
+				}
+			}
+		}
+
+		std::mutex m_jobMutex;
+		std::mutex m_mutex;
+		std::condition_variable m_wakeCondition;
+		std::condition_variable m_doneCondition;
+		std::vector<std::thread> m_workers;
+		const std::function<void(size_t)>* m_task = nullptr;
+		size_t m_taskCount = 0;
+		std::atomic<size_t> m_nextTask = { 0 };
+		size_t m_helperCount = 0;
+		size_t m_busyHelperCount = 0;
+		uint64_t m_jobID = 0;
+		bool m_isStopping = false;
+	};
+
+	void RunParallel(size_t _taskCount, const std::function<void(size_t)>& _task, size_t _threadCount)
+	{
+		size_t threadCount = _threadCount != 0 ? _threadCount : std::max(1u, std::thread::hardware_concurrency());
+		size_t helperCount = std::min(threadCount, _taskCount) - (_taskCount > 0 ? 1 : 0);
+		if (helperCount == 0 || ParallelTaskPool::IsRunningTask())
+		{
+			for (size_t task = 0; task < _taskCount; ++task)
+			{
+				_task(task);
+			}
+			return;
+		}
+
+		static ParallelTaskPool s_pool;
+		s_pool.run(_taskCount, _task, helperCount);
+	}
+
+	const char* TypeInfoToString(TypeInfo _type)
+	{
+		switch(_type)
+		{
+			case TypeInfo_none: return "none";
+			case TypeInfo_void: return "void";
+			case TypeInfo_bool: return "bool";
+			case TypeInfo_char: return "char";
+			case TypeInfo_int8: return "int8";
+			case TypeInfo_int16: return "int16";
+			case TypeInfo_int32: return "int32";
+			case TypeInfo_int64: return "int64";
+			case TypeInfo_uint8: return "uint8";
+			case TypeInfo_uint16: return "uint16";
+			case TypeInfo_uint32: return "uint32";
+			case TypeInfo_uint64: return "uint64";
+			case TypeInfo_float: return "float";
+			case TypeInfo_double: return "double";
+			case TypeInfo_Enum: return "Enum";
+			case TypeInfo_Class: return "Class";
+			case TypeInfo_Pointer: return "Pointer";
+			case TypeInfo_FixedSizeArray: return "FixedSizeArray";
+			case TypeInfo_StaticFunction: return "StaticFunction";
+			case TypeInfo_Sequence: return "Sequence";
+			case TypeInfo_Associative: return "Associative";
+			case TypeInfo_Optional: return "Optional";
+			case TypeInfo_Custom: return "Custom";
+			case TypeInfo_COUNT: return "COUNT";
+			default: assert(false);
+		}
+		return "";
+	}
+
+	//-----------------------------------------------------------------------------
+	// Global Functions
+	//-----------------------------------------------------------------------------
+	void InitNewTypes()
+	{
+		GetTypeSet().initNewTypes();
+	}
+
+	std::thread InitNewTypesAsync()
+	{
+		return std::thread([]()
+		{
+			GetTypeSet().initNewTypes();
+		});
+	}
+
+	TypeGroupID BeginTypeGroup(const char* _name)
+	{
+		return GetTypeSet().beginTypeGroup(_name);
+	}
+
+	void EndTypeGroup()
+	{
+		GetTypeSet().endTypeGroup();
+	}
+
+	void UnloadTypeGroup(TypeGroupID _group)
+	{
+		GetTypeSet().unloadTypeGroup(_group);
+	}
+
+	void InitTypeGroup(TypeGroupID _group)
+	{
+		GetTypeSet().initTypeGroup(_group);
+	}
+
+	static InstantiateCallback s_instantiateCallback = nullptr;
+	static void* s_instantiateCallbackUserData = nullptr;
+
+	void SetInstantiateCallback(InstantiateCallback _callback, void* _userData)
+	{
+		s_instantiateCallback = _callback;
+		s_instantiateCallbackUserData = _userData;
+	}
+
+	Type* FindTypeByName(const char* _name)
+	{
+		return GetTypeSet().findTypeByName(_name);
+	}
+
+	Class* FindClassByName(const char* _name)
+	{
+		Type* type = FindTypeByName(_name);
+		return type != nullptr ? type->asClass() : nullptr;
+	}
+
+	Type* FindTypeByID(TypeID _id)
+	{
+		return GetTypeSet().findTypeByID(_id);
+	}
+
+	Type* GetType(TypeID _id)
+	{
+		return GetTypeSet().findTypeByID(_id);
+	}
+
+	Class* AsClass(TypeID _id)
+	{
+		Type* type = GetType(_id);
+		return type != nullptr ? type->asClass() : nullptr;
+	}
+
+	Enum* AsEnum(TypeID _id)
+	{
+		Type* type = GetType(_id);
+		return type != nullptr ? type->asEnum() : nullptr;
+	}
+
+	Pointer* AsPointer(TypeID _id)
+	{
+		Type* type = GetType(_id);
+		return type != nullptr ? type->asPointer() : nullptr;
+	}
+
+	StaticFunction* AsStaticFunction(TypeID _id)
+	{
+		Type* type = GetType(_id);
+		return type != nullptr ? type->asStaticFunction() : nullptr;
+	}
+
+	FixedSizeArray* AsFixedSizeArray(TypeID _id)
+	{
+		Type* type = GetType(_id);
+		return type != nullptr ? type->asFixedSizeArray() : nullptr;
+	}
+
+	Sequence* AsSequence(TypeID _id)
+	{
+		Type* type = GetType(_id);
+		return type != nullptr ? type->asSequence() : nullptr;
+	}
+
+	Associative* AsAssociative(TypeID _id)
+	{
+		Type* type = GetType(_id);
+		return type != nullptr ? type->asAssociative() : nullptr;
+	}
+
+	Optional* AsOptional(TypeID _id)
+	{
+		Type* type = GetType(_id);
+		return type != nullptr ? type->asOptional() : nullptr;
+	}
+
+	const Type* GetDynamicType(const Type* _type, void* _instance)
+	{
+		if (_type == nullptr || _instance == nullptr || _type->getTypeInfo() != TypeInfo_Class)
+			return _type;
+
+		Class* dynamicClass = _type->asClass()->unsafeVirtualGetClass(_instance);
+		return dynamicClass != nullptr ? dynamicClass : _type;
+	}
+
+	TypeSet& GetTypeSet()
+    {
+		// Only published once fully created, g_typeSetPtr is visible earlier to the creating thread so that static registration can reenter
+		static std::atomic<TypeSet*> s_typeSet = { nullptr };
+		TypeSet* typeSet = s_typeSet.load(std::memory_order_acquire);
+		if (typeSet != nullptr)
+			return *typeSet;
+
+		static std::recursive_mutex s_mutex;
+		std::lock_guard<std::recursive_mutex> lock(s_mutex);
+		if (g_typeSetPtr == nullptr)
+		{
+			g_typeSetPtr = new TypeSet(); // This will leak for now, but it's not a big deal
+#ifdef MIRROR_STATIC_REGISTRATION
+			RegisterStaticTypes();
+#endif
+			s_typeSet.store(g_typeSetPtr, std::memory_order_release);
+		}
+        return *g_typeSetPtr;
+    }
+
+	//-----------------------------------------------------------------------------
+	// Meta Data
+	//-----------------------------------------------------------------------------
+
+	const char* MetaData::getName() const
+	{
+		return m_name;
+	}
+
+	bool MetaData::asBool() const
+	{
+		return strcmp("true", m_data) == 0;
+	}
+
+	int MetaData::asInt() const
+	{
+		return atoi(m_data);
+	}
+
+	float MetaData::asFloat() const
+	{
+		return atof(m_data);
+	}
+
+	const char* MetaData::asString() const
+	{
+		return m_data;
+	}
+
+	MetaData::MetaData(const char* _name, const char* _data)
+	{
+		ALLOCATE_AND_COPY_STRING(m_name, _name);
+        ALLOCATE_AND_COPY_STRING(m_data, _data);
+	}
+
+	MetaData::MetaData(const MetaData& _other)
+		: MetaData(_other.m_name, _other.m_data)
+	{
+	}
+
+	MetaData::~MetaData()
+    {
+        free(m_name);
+        free(m_data);
+    }
+
+    const mirror::MetaData* MetaDataSet::findMetaData(const char* _key) const
+	{
+		if (_key == nullptr)
+			return nullptr;
+
+		if (!m_parsed.load(std::memory_order_acquire))
+		{
+			// Parsing is rare enough to share a lock between all the sets
+			static std::mutex s_parseMutex;
+			std::lock_guard<std::mutex> lock(s_parseMutex);
+			if (!m_parsed.load(std::memory_order_relaxed))
+			{
+				parse();
+			}
+		}
+
+		uint32_t hash = HashCString(_key);
+		auto it = m_metaData.find(hash);
+		if (it == m_metaData.end())
+			return nullptr;
+
+		return &it->second;
+	}
+
+    MetaDataSet::MetaDataSet(const char* _metaDataString)
+	{
+		assert(_metaDataString != nullptr);
+		m_metaDataString = _metaDataString;
+	}
+
+	MetaDataSet::MetaDataSet(const MetaDataSet& _other)
+		: m_metaDataString(_other.m_metaDataString)
+		, m_parsed(_other.m_parsed.load())
+		, m_metaData(_other.m_metaData)
+	{
+	}
+
+	MetaDataSet& MetaDataSet::operator=(const MetaDataSet& _other)
+	{
+		m_metaDataString = _other.m_metaDataString;
+		m_metaData = _other.m_metaData;
+		m_parsed = _other.m_parsed.load();
+		return *this;
+	}
+
+	void MetaDataSet::parse() const
+	{
+		auto sanitizeMetaDataString = [](char* _buf)
+		{
+			assert(_buf);
+
+			bool hasFirstChar = false;
+			char* firstChar = _buf;
+			char* lastChar = _buf;
+			for (char* cur = _buf; *cur != 0; ++cur)
+			{
+				if (*cur != ' ')
+				{
+					if (!hasFirstChar)
+					{
+						firstChar = cur;
+						lastChar = cur + 1;
+						hasFirstChar = true;
+					}
+					else
+					{
+						lastChar = cur + 1;
+					}
+
+				}
+			}
+
+			// Source and destination overlap, the trimmed string is moved to the start of the buffer
+			size_t len = lastChar - firstChar;
+			memmove(_buf, firstChar, len);
+			_buf[len] = 0;
+		};
+
+		// Parse meta data
+		const char* metaDataString = m_metaDataString.c_str();
+		size_t len = m_metaDataString.size();
+
+		const char* key = metaDataString;
+		size_t keyLen = 0;
+		const char* value = nullptr;
+		size_t valueLen = 0;
+		for (const char* cur = metaDataString; cur <= metaDataString + len; ++cur)
+		{
+			if (*cur == ',' || cur == metaDataString + len)
+			{
+				if (value == nullptr)
+				{
+					keyLen = cur - key;
+				}
+				else
+				{
+					valueLen = cur - value;
+				}
+
+				if (keyLen == 0)
+					continue;
+
+				assert(keyLen < 256);
+				char keyBuf[256];
+				char valueBuf[256];
+
+				strncpy(keyBuf, key, keyLen);
+				keyBuf[keyLen] = 0;
+
+				if (value)
+				{
+					strncpy(valueBuf, value, valueLen);
+				}
+				valueBuf[valueLen] = 0;
 
-	template<typename F>
-	using FunctionArguments_T = typename FunctionTraits<F>::args;
+				sanitizeMetaDataString(keyBuf);
+				sanitizeMetaDataString(valueBuf);
 
-	template <std::size_t N, typename F>
-	using FunctionArgument_T = typename std::tuple_element<N, FunctionArguments_T<F>>::type;
+				MetaData metaData(keyBuf, valueBuf);
+				m_metaData.insert(std::make_pair(HashCString(metaData.getName()), metaData));
 
-	template <typename F, typename T, T I, T Top>
-	struct FunctionArgumentsUnpiler
-	{
-		static void Unpile(class StaticFunction* _function)
-		{
-			using ArgumentType = FunctionArgument_T<I, F>;
-			_function->addArgument<ArgumentType>();
-			FunctionArgumentsUnpiler<F, T, I + 1u, Top>::Unpile(_function);
+				key = cur + 1;
+				value = nullptr;
+				valueLen = 0;
+			}
+			else if (value == nullptr && *cur == '=')
+			{
+				keyLen = cur - key;
+				value = cur + 1;
+			}
 		}
-	};
-
-	template <typename F, typename T, T I>
-	struct FunctionArgumentsUnpiler<F, T, I, I>
-	{
-		static void Unpile(class StaticFunction* _function) {}
-	};
 
-	template<typename F>
-	FunctionArguments_T<F> MakeFunctionArgumentsTuple(F _function)
-	{
-		return FunctionArguments_T<F>{};
+		// Set last so that lock-free readers only see a complete map
+		m_parsed.store(true, std::memory_order_release);
 	}
 
-	template<typename Function, typename Tuple, size_t ... I>
-	auto CallFunction(Function f, Tuple t, std::index_sequence<I ...>)
-	{
-		return f(std::get<I>(t) ...);
-	}
+	//-----------------------------------------------------------------------------
+	// TypeSet
+	//-----------------------------------------------------------------------------
 
-	template<typename Function, typename Tuple>
-	auto CallFunction(Function f, Tuple t)
+	//-----------------------------------------------------------------------------
+	// ConcurrentTypeMap
+	//-----------------------------------------------------------------------------
+
+	ConcurrentTypeMap::ConcurrentTypeMap()
+		: m_table(createTable(16))
+		, m_zeroKeyValue(nullptr)
 	{
-		static constexpr auto size = std::tuple_size<Tuple>::value;
-		return CallFunction(f, t, std::make_index_sequence<size>{});
 	}
 
-	template <size_t I, size_t Top>
-	struct FunctionArgumentsFiller
+	ConcurrentTypeMap::~ConcurrentTypeMap()
 	{
-		template <typename C, typename ...ArgumentsTypes>
-		static void Fill(C* _classInstance, const char** _memberNames, size_t _memberCount, std::tuple<ArgumentsTypes...>& _arguments)
+		m_retiredTables.push_back(m_table.load());
+		for (Table* table : m_retiredTables)
 		{
-			using Argument_T = typename std::tuple_element<I, std::tuple<ArgumentsTypes...>>::type;
-
-			assert(_classInstance != nullptr);
-			Class* c = _classInstance->GetClass();
-			ClassMember* member = c->findMemberByName(_memberNames[I]);
-			assert(member != nullptr);
-			assert(member->getType() == TypeGetter<Argument_T>::Get());
-
-			std::get<I>(_arguments) = *reinterpret_cast<Argument_T*>(member->getInstanceMemberPointer(_classInstance));
-
-			FunctionArgumentsFiller<I + 1u, Top>::Fill(_classInstance, _memberNames, _memberCount, _arguments);
+			delete[] table->slots;
+			delete table;
 		}
-	};
+	}
 
-	template <size_t I>
-	struct FunctionArgumentsFiller<I, I>
+	Type* ConcurrentTypeMap::find(size_t _key) const
 	{
-		template <typename C, typename ...ArgumentsTypes>
-		static void Fill(C* _classInstance, const char** _memberNames, size_t _memberCount, std::tuple<ArgumentsTypes...>& _arguments)
+		if (_key == 0)
+			return m_zeroKeyValue.load(std::memory_order_acquire);
+
+		const Table* table = m_table.load(std::memory_order_acquire);
+		size_t mask = table->capacity - 1;
+		for (size_t i = Mix(_key) & mask;; i = (i + 1) & mask)
 		{
+			size_t key = table->slots[i].key.load(std::memory_order_acquire);
+			if (key == _key)
+				return table->slots[i].value.load(std::memory_order_acquire);
+			if (key == 0)
+				return nullptr;
 		}
-	};
-
-	template<typename F, typename C>
-	typename FunctionTraits<F>::result CallFunctionWithClassMembersAsArguments(F _functionPointer, C* _classInstance, const char** _memberNames, size_t _memberCount)
-	{
-		auto arguments = MakeFunctionArgumentsTuple(_functionPointer);
-
-		constexpr size_t argumentsCount = std::tuple_size<typename FunctionTraits<F>::args>::value;
-		assert(argumentsCount == _memberCount);
-		FunctionArgumentsFiller<0, argumentsCount>::Fill(_classInstance, _memberNames, _memberCount, arguments);
-
-		return CallFunction(_functionPointer, arguments);
 	}
 
-	template <typename T>
-	struct TypeGetter<T, void, void, void, std::enable_if_t<std::is_function<T>::value>>
+	void ConcurrentTypeMap::set(size_t _key, Type* _type)
 	{
-		static Type* Get()
+		if (_key == 0)
 		{
-			Type* typeDesc = GetTypeSet().findTypeByID(GetTypeID<T>());
-			if (typeDesc == nullptr)
-			{
-				using function_pointer_t = typename std::add_pointer<T>::type;
-
-				StaticFunction* staticFunction = new class StaticFunction();
-				staticFunction->createVirtualTypeWrapper<T>();
-				GetTypeSet().addType(staticFunction);
-
-				// Return type
-				using ReturnType = typename FunctionTraits<function_pointer_t>::result;
-				StaticFunction->setReturnType<ReturnType>();
-
-				// Arguments
-				constexpr size_t argumentsCount = std::tuple_size<FunctionArguments_T<function_pointer_t>>::value;
-				FunctionArgumentsUnpiler<function_pointer_t, std::size_t, 0, argumentsCount>::Unpile(StaticFunction);
+			m_zeroKeyValue.store(_type, std::memory_order_release);
+			return;
+		}
 
-				typeDesc = StaticFunction;
+		Table* table = m_table.load(std::memory_order_relaxed);
+		size_t mask = table->capacity - 1;
+		size_t i = Mix(_key) & mask;
+		for (;; i = (i + 1) & mask)
+		{
+			size_t key = table->slots[i].key.load(std::memory_order_relaxed);
+			if (key == _key)
+			{
+				Type* previousType = table->slots[i].value.load(std::memory_order_relaxed);
+				m_count += (_type != nullptr) - (previousType != nullptr);
+				table->slots[i].value.store(_type, std::memory_order_release);
+				return;
 			}
-			return typeDesc;
+			if (key == 0)
+				break;
 		}
-	};
 
-	template <typename F>
-	StaticFunction* GetStaticFunctionType(F* _function)
-	{
-		return static_cast<StaticFunction*>(TypeGetter<F>::Get());
-	}
-
-} // namespace mirror
-
-// Include to add custom types in. Just '#define MIRROR_EXTENSION_FILE "myfilename.h"' from your build system
-#ifdef MIRROR_EXTENSION_FILE
-#include MIRROR_EXTENSION_FILE
-#endif
-
-//*****************************************************************************
-// Implementation
-//*****************************************************************************
-
-#ifdef MIRROR_IMPLEMENTATION
-
-#include <cstring>
-#include <string>
-
-namespace mirror {
+		if (_type == nullptr)
+			return;
 
-	//-----------------------------------------------------------------------------
-	// Helpers & Tools
-	//-----------------------------------------------------------------------------
+		if ((m_usedSlotCount + 1) * 4 > table->capacity * 3)
+		{
+			reserve(m_count + 1);
+			set(_key, _type);
+			return;
+		}
 
-	#define ALLOCATE_AND_COPY_STRING(_dst, _src) { _dst = (char*)malloc(strlen(_src) + 1); strcpy(_dst, _src); }
+		// Value first, readers that see the key must see its value
+		table->slots[i].value.store(_type, std::memory_order_relaxed);
+		table->slots[i].key.store(_key, std::memory_order_release);
+		++m_usedSlotCount;
+		++m_count;
+	}
 
-	uint32_t Hash32(const void* _data, size_t _size)
+	void ConcurrentTypeMap::reserve(size_t _count)
 	{
-		const uint32_t OFFSET_BASIS = 2166136261;
-		const uint32_t FNV_PRIME = 16777619;
+		Table* table = m_table.load(std::memory_order_relaxed);
+		size_t newKeyCount = _count > m_count ? _count - m_count : 0;
+		if ((m_usedSlotCount + newKeyCount) * 4 <= table->capacity * 3)
+			return;
 
-		if (_size == 0)
+		// Removed keys are dropped when rehashing, so with a lot of unregistrations the capacity may not grow
+		size_t capacity = 16;
+		while (std::max(_count, m_count) * 2 > capacity)
 		{
-			return 0;
+			capacity *= 2;
 		}
 
-		// FNV-1a algorithm
-		// http://isthe.com/chongo/tech/comp/fnv/
-		uint32_t hash = OFFSET_BASIS;
-		const uint8_t* buf = static_cast<const uint8_t*>(_data);
-		for (uint32_t i = 0u; i < _size; i++)
+		Table* newTable = createTable(capacity);
+		size_t mask = capacity - 1;
+		for (size_t i = 0; i < table->capacity; ++i)
 		{
-			hash = hash * FNV_PRIME;
-			hash = hash ^ *buf;
-			++buf;
+			size_t key = table->slots[i].key.load(std::memory_order_relaxed);
+			Type* value = table->slots[i].value.load(std::memory_order_relaxed);
+			if (key == 0 || value == nullptr)
+				continue;
+
+			size_t j = Mix(key) & mask;
+			while (newTable->slots[j].key.load(std::memory_order_relaxed) != 0)
+			{
+				j = (j + 1) & mask;
+			}
+			newTable->slots[j].key.store(key, std::memory_order_relaxed);
+			newTable->slots[j].value.store(value, std::memory_order_relaxed);
 		}
-		return hash;
+
+		m_usedSlotCount = m_count;
+		m_retiredTables.push_back(table);
+		m_table.store(newTable, std::memory_order_release);
 	}
 
-	uint32_t HashCString(const char* _str)
+	size_t ConcurrentTypeMap::Mix(size_t _key)
 	{
-		return Hash32(_str, strlen(_str));
+		// TypeIDs are hash codes, but they may be poorly distributed on the low bits
+		uint64_t h = uint64_t(_key);
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		return size_t(h);
 	}
 
-	const char* TypeInfoToString(TypeInfo _type)
+	ConcurrentTypeMap::Table* ConcurrentTypeMap::createTable(size_t _capacity)
 	{
-		switch(_type)
+		Table* table = new Table();
+		table->capacity = _capacity;
+		table->slots = new Slot[_capacity];
+		for (size_t i = 0; i < _capacity; ++i)
 		{
-			case TypeInfo_none: return "none";
-			case TypeInfo_void: return "void";
-			case TypeInfo_bool: return "bool";
-			case TypeInfo_char: return "char";
-			case TypeInfo_int8: return "int8";
-			case TypeInfo_int16: return "int16";
-			case TypeInfo_int32: return "int32";
-			case TypeInfo_int64: return "int64";
-			case TypeInfo_uint8: return "uint8";
-			case TypeInfo_uint16: return "uint16";
-			case TypeInfo_uint32: return "uint32";
-			case TypeInfo_uint64: return "uint64";
-			case TypeInfo_float: return "float";
-			case TypeInfo_double: return "double";
-			case TypeInfo_Enum: return "Enum";
-			case TypeInfo_Class: return "Class";
-			case TypeInfo_Pointer: return "Pointer";
-			case TypeInfo_FixedSizeArray: return "FixedSizeArray";
-			case TypeInfo_StaticFunction: return "StaticFunction";
-			case TypeInfo_Custom: return "Custom";
-			case TypeInfo_COUNT: return "COUNT";
-			default: assert(false);
+			table->slots[i].key.store(0, std::memory_order_relaxed);
+			table->slots[i].value.store(nullptr, std::memory_order_relaxed);
 		}
-		return "";
+		return table;
 	}
 
 	//-----------------------------------------------------------------------------
-	// Global Functions
+	// TypeSet
 	//-----------------------------------------------------------------------------
-	void InitNewTypes()
-	{
-		GetTypeSet().initNewTypes();
-	}
 
-	Type* FindTypeByName(const char* _name)
+	TypeSet::~TypeSet()
 	{
-		return GetTypeSet().findTypeByName(_name);
+		for (Type* type : m_types)
+		{
+			delete type;
+		}
+		m_types.clear();
 	}
 
-	Class* FindClassByName(const char* _name)
+	Type* TypeSet::findTypeByID(TypeID _typeID) const
 	{
-		Type* type = FindTypeByName(_name);
-		return type != nullptr ? type->asClass() : nullptr;
+		return m_typesByID.find(_typeID);
 	}
 
-	Type* FindTypeByID(TypeID _id)
+	mirror::Type* TypeSet::findTypeByName(const char* _name) const
 	{
-		return GetTypeSet().findTypeByID(_id);
+		return m_typesByName.find(HashCString(_name));
 	}
 
-	Type* GetType(TypeID _id)
+	void TypeSet::addType(Type* _type)
 	{
-		return GetTypeSet().findTypeByID(_id);
+		addRegistration(_type, false);
 	}
 
-	Class* AsClass(TypeID _id)
+	void TypeSet::addTypeName(Type* _type, const char* _name)
 	{
-		Type* type = GetType(_id);
-		return type != nullptr ? type->asClass() : nullptr;
-	}
+		assert(_type);
+		assert(_name);
+		std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-	Enum* AsEnum(TypeID _id)
-	{
-		Type* type = GetType(_id);
-		return type != nullptr ? type->asEnum() : nullptr;
+		uint32_t nameHash = HashCString(_name);
+		assert(m_typesByName.find(nameHash) == nullptr);
+		m_typesByName.set(nameHash, _type);
 	}
 
-	Pointer* AsPointer(TypeID _id)
+	Type* TypeSet::findOrAddType(Type* _type)
 	{
-		Type* type = GetType(_id);
-		return type != nullptr ? type->asPointer() : nullptr;
-	}
+		assert(_type);
+		std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-	StaticFunction* AsStaticFunction(TypeID _id)
-	{
-		Type* type = GetType(_id);
-		return type != nullptr ? type->asStaticFunction() : nullptr;
+		Type* registeredType = m_typesByID.find(_type->getTypeID());
+		if (registeredType != nullptr)
+			return registeredType;
+
+		// Nothing else removes types created on demand, and their functions live in the module that created them
+		addRegistration(_type, true);
+		return _type;
 	}
 
-	FixedSizeArray* AsFixedSizeArray(TypeID _id)
+	void TypeSet::removeType(Type* _type)
 	{
-		Type* type = GetType(_id);
-		return type != nullptr ? type->asFixedSizeArray() : nullptr;
-	}
+		assert(_type);
+		std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-	TypeSet& GetTypeSet()
-    {
-		if (g_typeSetPtr == nullptr)
+		// Types of an unloaded group are not registered anymore when their module removes them
+		auto it = m_registrations.find(_type->getTypeID());
+		if (it == m_registrations.end())
+			return;
+
+		std::vector<Registration>& registrations = it->second;
+		auto registrationIt = std::find_if(registrations.begin(), registrations.end(), [_type](const Registration& _registration) { return _registration.type == _type; });
+		if (registrationIt == registrations.end())
 		{
-			g_typeSetPtr = new TypeSet(); // This will leak for now, but it's not a big deal
+			// Removing a pointer that was not registered drops the last registration of its type
+			registrationIt = registrations.end() - 1;
 		}
-        return *g_typeSetPtr;
-    }
-
-	//-----------------------------------------------------------------------------
-	// Meta Data
-	//-----------------------------------------------------------------------------
 
-	const char* MetaData::getName() const
-	{
-		return m_name;
-	}
+		Registration registration = *registrationIt;
+		bool isRegisteredType = registrationIt == registrations.begin();
+		registrations.erase(registrationIt);
+		if (registration.group != NO_TYPEGROUP)
+		{
+			m_groups[registration.group - 1].types.erase(registration.type);
+		}
 
-	bool MetaData::asBool() const
-	{
-		return strcmp("true", m_data) == 0;
-	}
+		if (!isRegisteredType)
+			return;
 
-	int MetaData::asInt() const
-	{
-		return atoi(m_data);
+		uninstallType(registration.type);
+		if (registrations.empty())
+		{
+			m_registrations.erase(it);
+		}
+		else
+		{
+			installType(registrations.front().type);
+		}
 	}
 
-	float MetaData::asFloat() const
+	void TypeSet::registerStaticTypes(const StaticRegistration* _begin, const StaticRegistration* _end)
 	{
-		return atof(m_data);
-	}
+		std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-	const char* MetaData::asString() const
-	{
-		return m_data;
-	}
+		size_t count = _end - _begin;
+		m_typesByID.reserve(m_types.size() + count);
+		m_registrations.reserve(m_registrations.size() + count);
 
-	MetaData::MetaData(const char* _name, const char* _data)
-	{
-		ALLOCATE_AND_COPY_STRING(m_name, _name);
-        ALLOCATE_AND_COPY_STRING(m_data, _data);
+		TypeGroupID group = CurrentTypeGroup();
+		for (const StaticRegistration* registration = _begin; registration < _end; ++registration)
+		{
+			// Linkers may pad the section with zeros
+			if (registration->create == nullptr)
+				continue;
+
+			// Records can be duplicated when declared in headers, or when a module is registered twice.
+			// Inside a group, a type also registered by another group is registered again so that it survives the unloading of either group.
+			auto it = m_registrations.find(registration->getTypeID());
+			if (it != m_registrations.end())
+			{
+				if (group == NO_TYPEGROUP)
+					continue;
+
+				bool isInGroup = std::find_if(it->second.begin(), it->second.end(), [group](const Registration& _registration) { return _registration.group == group; }) != it->second.end();
+				if (isInGroup)
+					continue;
+			}
+
+			addRegistration(registration->create(), true);
+		}
 	}
 
-	MetaData::MetaData(const MetaData& _other)
-		: MetaData(_other.m_name, _other.m_data)
+	const std::set<Type*>& TypeSet::getTypes() const
 	{
+		return m_types;
 	}
 
-	MetaData::~MetaData()
-    {
-        free(m_name);
-        free(m_data);
-    }
-
-    const mirror::MetaData* MetaDataSet::findMetaData(const char* _key) const
+	void TypeSet::initType(Type* _type)
 	{
-		if (_key == nullptr)
-			return nullptr;
+		assert(_type);
+		std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-		uint32_t hash = HashCString(_key);
-		auto it = m_metaData.find(hash);
-		if (it == m_metaData.end())
-			return nullptr;
+		if (!_type->m_initialized)
+		{
+			_type->init();
+			_type->m_initialized.store(true, std::memory_order_release);
 
-		return &it->second;
+			// Names built from other types are set by init
+			indexTypeName(_type);
+		}
 	}
 
-    MetaDataSet::MetaDataSet(const char* _metaDataString)
+	void TypeSet::initNewTypes()
 	{
-		auto sanitizeMetaDataString = [](char* _buf)
+		std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+		// Initializing a type can register new ones
+		while (!m_typesToInit.empty())
 		{
-			assert(_buf);
+			std::vector<TypeID> typesToInit;
+			typesToInit.swap(m_typesToInit);
 
-			bool hasFirstChar = false;
-			char* firstChar = _buf;
-			char* lastChar = _buf;
-			for (char* cur = _buf; *cur != 0; ++cur)
+			for (TypeID typeID : typesToInit)
 			{
-				if (*cur != ' ')
+				// The type may have been removed since, or removed and added again (then its ID is listed twice)
+				Type* type = m_typesByID.find(typeID);
+				if (type != nullptr)
 				{
-					if (!hasFirstChar)
-					{
-						firstChar = cur;
-						lastChar = cur + 1;
-						hasFirstChar = true;
-					}
-					else
-					{
-						lastChar = cur + 1;
-					}
-
+					type->ensureInitialized();
 				}
 			}
+		}
+	}
 
-			size_t len = lastChar - firstChar;
-			strncpy(_buf, firstChar, len);
-			_buf[len] = 0;
-		};
-
-		// Parse meta data
-		assert(_metaDataString != nullptr);
-		size_t len = strlen(_metaDataString);
+	TypeGroupID TypeSet::beginTypeGroup(const char* _name)
+	{
+		assert(_name != nullptr);
+		assert(CurrentTypeGroup() == NO_TYPEGROUP); // groups can't be nested
+		std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-		const char* key = _metaDataString;
-		size_t keyLen = 0;
-		const char* value = nullptr;
-		size_t valueLen = 0;
-		for (const char* cur = _metaDataString; cur <= _metaDataString + len; ++cur)
+		TypeGroupID group = NO_TYPEGROUP;
+		for (size_t i = 0; i < m_groups.size(); ++i)
 		{
-			if (*cur == ',' || cur == _metaDataString + len)
+			if (m_groups[i].name == _name)
 			{
-				if (value == nullptr)
-				{
-					keyLen = cur - key;
-				}
-				else
-				{
-					valueLen = cur - value;
-				}
+				group = TypeGroupID(i + 1);
+				break;
+			}
+		}
 
-				if (keyLen == 0)
-					continue;
+		if (group == NO_TYPEGROUP)
+		{
+			m_groups.push_back(TypeGroup());
+			m_groups.back().name = _name;
+			group = TypeGroupID(m_groups.size());
+		}
 
-				assert(keyLen < 256);
-				char keyBuf[256];
-				char valueBuf[256];
+		++m_groups[group - 1].generation;
+		CurrentTypeGroup() = group;
+		return group;
+	}
 
-				strncpy(keyBuf, key, keyLen);
-				keyBuf[keyLen] = 0;
+	void TypeSet::endTypeGroup()
+	{
+		assert(CurrentTypeGroup() != NO_TYPEGROUP);
+		CurrentTypeGroup() = NO_TYPEGROUP;
+	}
 
-				if (value)
+	void TypeSet::unloadTypeGroup(TypeGroupID _group)
+	{
+		assert(_group != NO_TYPEGROUP && _group <= m_groups.size());
+		std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+		// Copied because removeType updates the group
+		std::vector<Type*> types(m_groups[_group - 1].types.begin(), m_groups[_group - 1].types.end());
+		for (Type* type : types)
+		{
+			bool owned = false;
+			for (const Registration& registration : m_registrations[type->getTypeID()])
+			{
+				if (registration.type == type)
 				{
-					strncpy(valueBuf, value, valueLen);
+					owned = registration.owned;
+					break;
 				}
-				valueBuf[valueLen] = 0;
-
-				sanitizeMetaDataString(keyBuf);
-				sanitizeMetaDataString(valueBuf);
-
-				MetaData metaData(keyBuf, valueBuf);
-				m_metaData.insert(std::make_pair(HashCString(metaData.getName()), metaData));
-
-				key = cur + 1;
-				value = nullptr;
 			}
-			else if (value == nullptr && *cur == '=')
+
+			// Types created by global objects of the module still belong to them, and the module may not even be unloaded
+			if (owned)
 			{
-				keyLen = cur - key;
-				value = cur + 1;
+				removeType(type);
+				delete type;
 			}
 		}
 	}
 
-	MetaDataSet::MetaDataSet(const MetaDataSet& _other)
+	void TypeSet::initTypeGroup(TypeGroupID _group)
 	{
-		m_metaData = _other.m_metaData;
-	}
-
-	//-----------------------------------------------------------------------------
-	// TypeSet
-	//-----------------------------------------------------------------------------
+		assert(_group != NO_TYPEGROUP && _group <= m_groups.size());
+		std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-	TypeSet::~TypeSet()
-	{
-		for (Type* type : m_types)
+		for (Type* type : m_groups[_group - 1].types)
 		{
-			delete type;
+			if (m_typesByID.find(type->getTypeID()) == type)
+			{
+				type->ensureInitialized();
+			}
 		}
-		m_types.clear();
-		m_typesByID.clear();
-		m_typesByName.clear();
-	}
-
-	Type* TypeSet::findTypeByID(TypeID _typeID) const
-	{
-		auto it = m_typesByID.find(_typeID);
-		return it != m_typesByID.end() ? it->second : nullptr;
 	}
 
-	mirror::Type* TypeSet::findTypeByName(const char* _name) const
+	uint32_t TypeSet::getTypeGroupGeneration(TypeGroupID _group) const
 	{
-		uint32_t nameHash = HashCString(_name);
-		auto it = m_typesByName.find(nameHash);
-		return it != m_typesByName.end() ? it->second : nullptr;
+		assert(_group != NO_TYPEGROUP && _group <= m_groups.size());
+		std::lock_guard<std::recursive_mutex> lock(m_mutex);
+		return m_groups[_group - 1].generation;
 	}
 
-	void TypeSet::addType(Type* _type)
+	void TypeSet::addRegistration(Type* _type, bool _owned)
 	{
 		assert(_type);
+		std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-		// Using dlls can result in multiple registration the same type. We accept the first type and screen all others
-		auto result = m_typesRegistrationCount.insert(std::make_pair(_type->getTypeID(), 0));
-		++result.first->second;
-		if (result.first->second > 1)
+		TypeGroupID group = CurrentTypeGroup();
+		std::vector<Registration>& registrations = m_registrations[_type->getTypeID()];
+		registrations.push_back({ _type, group, _owned });
+		if (group != NO_TYPEGROUP)
 		{
-			return;
+			m_groups[group - 1].types.insert(_type);
+		}
+
+		if (registrations.size() == 1)
+		{
+			installType(_type);
 		}
+	}
 
+	void TypeSet::installType(Type* _type)
+	{
 		// Checks if a type with the same typeID does not already exists
-		assert(m_typesByID.find(_type->getTypeID()) == m_typesByID.end());
+		assert(m_typesByID.find(_type->getTypeID()) == nullptr);
 		assert(m_types.find(_type) == m_types.end());
 
-		m_typesByID.insert(std::make_pair(_type->getTypeID(), _type));
+		m_typesByID.set(_type->getTypeID(), _type);
 		m_types.emplace(_type);
+		m_typesToInit.push_back(_type->getTypeID());
+		indexTypeName(_type);
+
+		if (Class* clss = _type->asClass())
+		{
+			linkClass(clss);
+		}
+		_type->m_installGeneration = ++m_generation;
 	}
 
-	void TypeSet::addTypeName(Type* _type, const char* _name)
+	void TypeSet::uninstallType(Type* _type)
 	{
-		assert(_type);
-		assert(_name);
+		assert(m_typesByID.find(_type->getTypeID()) == _type);
+		m_typesByID.set(_type->getTypeID(), nullptr);
 
-		uint32_t nameHash = HashCString(_name);
-		assert(m_typesByName.find(nameHash) == m_typesByName.end());
-		m_typesByName.insert(std::make_pair(nameHash, _type));
+		// Classes, pointers and arrays refer to other types by ID, so they follow a replaced type without patching. Only the children sets need it.
+		if (Class* clss = _type->asClass())
+		{
+			unlinkClass(clss);
+		}
+
+		// The type stays initialized: other threads may still use it, and its name and default instance live as long as it does
+		uint32_t nameHash = HashCString(_type->m_name);
+		if (m_typesByName.find(nameHash) == _type)
+		{
+			m_typesByName.set(nameHash, nullptr);
+		}
+
+		m_types.erase(_type);
+		++m_generation;
 	}
 
-	void TypeSet::removeType(Type* _type)
+	TypeGroupID& TypeSet::CurrentTypeGroup()
 	{
-		assert(_type);
+		static thread_local TypeGroupID s_currentGroup = NO_TYPEGROUP;
+		return s_currentGroup;
+	}
 
-		// Using dlls can result in multiple registration the same type. We accept the first type and screen all others
-		auto registrationCountIt = m_typesRegistrationCount.find(_type->getTypeID());		
-		assert(registrationCountIt != m_typesRegistrationCount.end());
-		--registrationCountIt->second;
-		if (registrationCountIt->second > 0)
-		{
+	void TypeSet::indexTypeName(Type* _type)
+	{
+		// Types that are not registered (or not anymore) keep their name out of the index, and empty names are not known yet
+		if (m_typesByID.find(_type->getTypeID()) != _type || _type->m_name == nullptr || _type->m_name[0] == '\0')
+			return;
+
+		uint32_t nameHash = HashCString(_type->m_name);
+		Type* namedType = m_typesByName.find(nameHash);
+		if (namedType == _type)
 			return;
+
+		assert(namedType == nullptr);
+		m_typesByName.set(nameHash, _type);
+	}
+
+	void TypeSet::linkClass(Class* _class)
+	{
+		TypeID classID = _class->getTypeID();
+		for (TypeID parentID : _class->m_parents)
+		{
+			Type* parentType = m_typesByID.find(parentID);
+			Class* parent = parentType != nullptr ? parentType->asClass() : nullptr;
+			if (parent != nullptr)
+			{
+				parent->m_children.insert(classID);
+			}
+			else
+			{
+				m_orphanChildren[parentID].insert(classID);
+			}
 		}
 
-		// Checks if a type with the same typeID already exists
+		auto it = m_orphanChildren.find(classID);
+		if (it != m_orphanChildren.end())
 		{
-			auto it = m_typesByID.find(_type->getTypeID());
-			assert(it != m_typesByID.end());
-			m_typesByID.erase(it);
+			_class->m_children.insert(it->second.begin(), it->second.end());
+			m_orphanChildren.erase(it);
 		}
+	}
 
-		if (_type->m_initialized)
+	void TypeSet::unlinkClass(Class* _class)
+	{
+		TypeID classID = _class->getTypeID();
+		for (TypeID parentID : _class->m_parents)
 		{
-			uint32_t nameHash = HashCString(_type->getName());
-			auto it = m_typesByName.find(nameHash);
-			if (it != m_typesByName.end())
+			Type* parentType = m_typesByID.find(parentID);
+			Class* parent = parentType != nullptr ? parentType->asClass() : nullptr;
+			if (parent != nullptr)
+			{
+				parent->m_children.erase(classID);
+			}
+			else
 			{
-				m_typesByName.erase(it);
+				auto orphansIt = m_orphanChildren.find(parentID);
+				if (orphansIt != m_orphanChildren.end())
+				{
+					orphansIt->second.erase(classID);
+					if (orphansIt->second.empty())
+						m_orphanChildren.erase(orphansIt);
+				}
 			}
-			_type->shutdown();
-			_type->m_initialized = false;
 		}
-		
+
+		// Children stay registered, they will be given back to the class if it is registered again
+		if (!_class->m_children.empty())
 		{
-			// because of the dll multiple loading thing, last removed type won't necessary be the same pointer, that's why we compare ids (although, if the dll has been unloaded, the call to getType will probably crash)
-			auto it = std::find_if(m_types.begin(), m_types.end(),
-				[_type](Type* _t) { return _t->getTypeID() == _type->getTypeID(); }
-			);
-			assert(it != m_types.end());
-			m_types.erase(it);
+			m_orphanChildren[classID].insert(_class->m_children.begin(), _class->m_children.end());
+			_class->m_children.clear();
 		}
 	}
 
-	const std::set<Type*>& TypeSet::getTypes() const
+	TypeSet* g_typeSetPtr = nullptr;
+
+	//-----------------------------------------------------------------------------
+	// Type Caches
+	//-----------------------------------------------------------------------------
+	void TypeDependencies::add(const Type* _type)
 	{
-		return m_types;
+		if (_type == nullptr)
+			return;
+
+		for (const Dependency& dependency : m_dependencies)
+		{
+			if (dependency.type == _type)
+				return;
+		}
+
+		std::lock_guard<std::recursive_mutex> lock(GetTypeSet().m_mutex);
+		m_dependencies.push_back({ _type->getTypeID(), _type, _type->m_installGeneration });
 	}
 
-	void TypeSet::initNewTypes()
+	void TypeDependencies::add(const TypeDependencies& _dependencies)
 	{
-		for (Type* type : m_types)
+		for (const Dependency& dependency : _dependencies.m_dependencies)
 		{
-			if (!type->m_initialized)
+			auto isSameType = [&dependency](const Dependency& _other) { return _other.type == dependency.type; };
+			if (std::find_if(m_dependencies.begin(), m_dependencies.end(), isSameType) == m_dependencies.end())
 			{
-				type->init();
-
-				uint32_t nameHash = HashCString(type->getName());
-				assert(m_typesByName.find(nameHash) == m_typesByName.end());
-				m_typesByName.insert(std::make_pair(nameHash, type));
-
-				type->m_initialized = true;
+				m_dependencies.push_back(dependency);
 			}
 		}
 	}
 
-	TypeSet* g_typeSetPtr = nullptr;
+	bool TypeDependencies::isValid() const
+	{
+		TypeSet& typeSet = GetTypeSet();
+		std::lock_guard<std::recursive_mutex> lock(typeSet.m_mutex);
+
+		// Types are only dereferenced once found registered, removed ones may have been deleted
+		for (const Dependency& dependency : m_dependencies)
+		{
+			const Type* type = typeSet.findTypeByID(dependency.typeID);
+			if (type != dependency.type || type->m_installGeneration != dependency.installGeneration)
+				return false;
+		}
+		return true;
+	}
 
 
 	//-----------------------------------------------------------------------------
@@ -1480,17 +3674,31 @@ namespace mirror {
 
 	const char* Type::getName() const
 	{
+		ensureInitialized();
 		return m_name;
 	}
 
 	const char* Type::getCustomTypeName() const
 	{
+		ensureInitialized();
 		return m_customTypeName;
 	}
 
 	bool Type::isCustomType(const char* _customTypeName) const
 	{
-		return m_typeInfo == TypeInfo_Custom && strcmp(_customTypeName, m_customTypeName) == 0;
+		if (m_typeInfo != TypeInfo_Custom)
+			return false;
+
+		ensureInitialized();
+		return m_customTypeName != nullptr && strcmp(_customTypeName, m_customTypeName) == 0;
+	}
+
+	void Type::ensureInitialized() const
+	{
+		if (!m_initialized.load(std::memory_order_acquire))
+		{
+			GetTypeSet().initType(const_cast<Type*>(this));
+		}
 	}
 
 	TypeID Type::getTypeID() const
@@ -1503,6 +3711,21 @@ namespace mirror {
 		return m_virtualTypeWrapper->getSize();
 	}
 
+	size_t Type::getAlignment() const
+	{
+		return m_virtualTypeWrapper->getAlignment();
+	}
+
+	bool Type::isTriviallyCopyable() const
+	{
+		return m_virtualTypeWrapper->isTriviallyCopyable();
+	}
+
+	bool Type::isCopyConstructible() const
+	{
+		return m_virtualTypeWrapper->isCopyConstructible();
+	}
+
 	const Class* Type::asClass() const
 	{
 		if (getTypeInfo() == TypeInfo_Class)
@@ -1548,6 +3771,33 @@ namespace mirror {
 		return nullptr;
 	}
 
+	const Sequence* Type::asSequence() const
+	{
+		if (getTypeInfo() == TypeInfo_Sequence)
+		{
+			return static_cast<const Sequence*>(this);
+		}
+		return nullptr;
+	}
+
+	const Associative* Type::asAssociative() const
+	{
+		if (getTypeInfo() == TypeInfo_Associative)
+		{
+			return static_cast<const Associative*>(this);
+		}
+		return nullptr;
+	}
+
+	const Optional* Type::asOptional() const
+	{
+		if (getTypeInfo() == TypeInfo_Optional)
+		{
+			return static_cast<const Optional*>(this);
+		}
+		return nullptr;
+	}
+
 	Class* Type::asClass()
 	{
 		if (getTypeInfo() == TypeInfo_Class)
@@ -1588,7 +3838,34 @@ namespace mirror {
 	{
 		if (getTypeInfo() == TypeInfo_FixedSizeArray)
 		{
-			return static_cast<FixedSizeArray*>(this);
+			return static_cast<FixedSizeArray*>(this);
+		}
+		return nullptr;
+	}
+
+	Sequence* Type::asSequence()
+	{
+		if (getTypeInfo() == TypeInfo_Sequence)
+		{
+			return static_cast<Sequence*>(this);
+		}
+		return nullptr;
+	}
+
+	Associative* Type::asAssociative()
+	{
+		if (getTypeInfo() == TypeInfo_Associative)
+		{
+			return static_cast<Associative*>(this);
+		}
+		return nullptr;
+	}
+
+	Optional* Type::asOptional()
+	{
+		if (getTypeInfo() == TypeInfo_Optional)
+		{
+			return static_cast<Optional*>(this);
 		}
 		return nullptr;
 	}
@@ -1606,12 +3883,22 @@ namespace mirror {
 
 	void* Type::instantiate(AllocateFunction _allocateFunction, void* _userData) const
 	{
-		return m_virtualTypeWrapper->instantiate(_allocateFunction, _userData);
+		void* instance = m_virtualTypeWrapper->instantiate(_allocateFunction, _userData);
+		if (instance != nullptr && s_instantiateCallback != nullptr)
+		{
+			s_instantiateCallback(this, instance, s_instantiateCallbackUserData);
+		}
+		return instance;
 	}
 
-	void Type::shutdown()
+	void Type::destruct(void* _instances, size_t _count) const
 	{
+		m_virtualTypeWrapper->destruct(_instances, _count);
+	}
 
+	void Type::copyConstruct(void* _destination, const void* _source, size_t _count) const
+	{
+		m_virtualTypeWrapper->copyConstruct(_destination, _source, _count);
 	}
 
 	void Type::init()
@@ -1727,6 +4014,59 @@ namespace mirror {
 		return nullptr;
 	}
 
+	std::vector<Method*> Class::getMethods(bool _includeInheritedMethods) const
+	{
+		std::vector<Method*> methods = m_methods;
+		if (_includeInheritedMethods)
+		{
+			for (TypeID parentID : m_parents)
+			{
+				Class* parent = AsClass(parentID);
+				assert(parent != nullptr);
+				std::vector<Method*> parentMethods = parent->getMethods(true);
+				methods.insert(methods.end(), parentMethods.begin(), parentMethods.end());
+			}
+		}
+		return methods;
+	}
+
+	Method* Class::findMethodByName(const char* _name, bool _includeInheritedMethods) const
+	{
+		uint32_t nameHash = HashCString(_name);
+		auto it = m_methodsByName.find(nameHash);
+		if (it != m_methodsByName.end())
+		{
+			return it->second;
+		}
+		if (_includeInheritedMethods)
+		{
+			for (TypeID parentID : m_parents)
+			{
+				Class* parent = AsClass(parentID);
+				assert(parent != nullptr);
+				Method* method = parent->findMethodByName(_name);
+				if (method)
+					return method;
+			}
+		}
+		return nullptr;
+	}
+
+	const std::vector<Constructor*>& Class::getConstructors() const
+	{
+		return m_constructors;
+	}
+
+	Constructor* Class::findConstructor(const TypeID* _argumentTypes, size_t _argumentCount) const
+	{
+		for (Constructor* constructor : m_constructors)
+		{
+			if (constructor->m_argumentTypes.size() == _argumentCount && std::equal(constructor->m_argumentTypes.begin(), constructor->m_argumentTypes.end(), _argumentTypes))
+				return constructor;
+		}
+		return nullptr;
+	}
+
 	Class* Class::getParent() const
 	{
 		Type* parentType = FindTypeByID(getParentID());
@@ -1743,8 +4083,9 @@ namespace mirror {
 		return m_parents;
 	}
 
-	const std::set<TypeID>& Class::getChildren() const
+	std::set<TypeID> Class::getChildren() const
 	{
+		std::lock_guard<std::recursive_mutex> lock(GetTypeSet().m_mutex);
 		return m_children;
 	}
 
@@ -1767,6 +4108,76 @@ namespace mirror {
 		return m_metaDataSet;
 	}
 
+	static void* AllocateDefaultInstance(size_t _size, void* _userData)
+	{
+		const Class* clss = static_cast<const Class*>(_userData);
+		return ::operator new(_size, std::align_val_t(clss->getAlignment()));
+	}
+
+	const void* Class::getDefaultInstance() const
+	{
+		// The constructor is user code, it only runs for classes whose default instance is actually used
+		if (!m_hasDefaultInstance.load(std::memory_order_acquire))
+		{
+			std::lock_guard<std::recursive_mutex> lock(GetTypeSet().m_mutex);
+			if (!m_hasDefaultInstance.load(std::memory_order_relaxed))
+			{
+				if (m_virtualTypeWrapper->hasFactory())
+				{
+					m_defaultInstance = m_virtualTypeWrapper->instantiate(&AllocateDefaultInstance, const_cast<Class*>(this));
+				}
+				m_hasDefaultInstance.store(true, std::memory_order_release);
+			}
+		}
+		return m_defaultInstance;
+	}
+
+	void Class::resetToDefault(void* _instances, size_t _count) const
+	{
+		const void* defaultInstance = getDefaultInstance();
+		assert(defaultInstance != nullptr);
+		if (_count == 0)
+			return;
+
+		uint8_t* instances = static_cast<uint8_t*>(_instances);
+		size_t size = getSize();
+		if (isTriviallyCopyable())
+		{
+			// Copies the default instance once, then doubles the initialized range
+			memcpy(instances, defaultInstance, size);
+			size_t copied = 1;
+			while (copied < _count)
+			{
+				size_t count = std::min(copied, _count - copied);
+				memcpy(instances + copied * size, instances, count * size);
+				copied += count;
+			}
+			return;
+		}
+
+		assert(isCopyConstructible());
+		for (size_t i = 0; i < _count; ++i)
+		{
+			void* instance = instances + i * size;
+			if (instance != defaultInstance)
+			{
+				destruct(instance);
+				copyConstruct(instance, defaultInstance);
+			}
+		}
+	}
+
+	void Class::releaseDefaultInstance()
+	{
+		if (m_defaultInstance != nullptr)
+		{
+			destruct(m_defaultInstance);
+			::operator delete(m_defaultInstance, std::align_val_t(getAlignment()));
+			m_defaultInstance = nullptr;
+		}
+		m_hasDefaultInstance.store(false, std::memory_order_release);
+	}
+
 	mirror::Class* Class::unsafeVirtualGetClass(void* _object) const
 	{
 		return m_virtualTypeWrapper->unsafeVirtualGetClass(_object);
@@ -1784,27 +4195,32 @@ namespace mirror {
 		m_membersByName.insert(std::make_pair(nameHash, _member));
 	}
 
-	void Class::addParent(TypeID _parent)
+	void Class::addMethod(Method* _method)
 	{
-		assert(_parent != UNDEFINED_TYPEID);
-		assert(std::find(m_parents.begin(), m_parents.end(), _parent) == m_parents.end());
+		assert(_method);
+		uint32_t nameHash = HashCString(_method->getName());
+		assert(m_methodsByName.find(nameHash) == m_methodsByName.end());
 
-		m_parents.insert(_parent);
+		_method->m_ownerClass = this;
+		m_methods.push_back(_method);
+		m_methodsByName.insert(std::make_pair(nameHash, _method));
 	}
 
-	void Class::shutdown()
+	void Class::addConstructor(Constructor* _constructor)
 	{
-		m_children.clear();
+		assert(_constructor);
+		assert(findConstructor(_constructor->m_argumentTypes.data(), _constructor->m_argumentTypes.size()) == nullptr);
+
+		_constructor->m_ownerClass = this;
+		m_constructors.push_back(_constructor);
 	}
 
-	void Class::init()
+	void Class::addParent(TypeID _parent)
 	{
-		for (TypeID parentID : m_parents)
-		{
-			Class* parent = AsClass(parentID);
-			assert(parent != nullptr);
-			parent->m_children.insert(getTypeID());
-		}
+		assert(_parent != UNDEFINED_TYPEID);
+		assert(std::find(m_parents.begin(), m_parents.end(), _parent) == m_parents.end());
+
+		m_parents.insert(_parent);
 	}
 
 	Class::Class(const char* _name, const char* _metaDataString)
@@ -1822,10 +4238,19 @@ namespace mirror {
 
 	Class::~Class()
 	{
+		releaseDefaultInstance();
 		for (ClassMember* member : m_members)
 		{
 			delete member;
 		}
+		for (Method* method : m_methods)
+		{
+			delete method;
+		}
+		for (Constructor* constructor : m_constructors)
+		{
+			delete constructor;
+		}
 	}
 
 	const char* ClassMember::getName() const
@@ -1871,6 +4296,72 @@ namespace mirror {
 		free(m_name);
 	}
 
+	// --- Method
+	const char* Method::getName() const
+	{
+		return m_name;
+	}
+
+	Class* Method::getOwnerClass() const
+	{
+		return m_ownerClass;
+	}
+
+	Type* Method::getReturnType() const
+	{
+		return GetTypeSet().findTypeByID(m_returnType);
+	}
+
+	Type* Method::getArgumentType(size_t _index) const
+	{
+		assert(_index < m_argumentTypes.size());
+		return GetTypeSet().findTypeByID(m_argumentTypes[_index]);
+	}
+
+	const MetaDataSet& Method::getMetaDataSet() const
+	{
+		return m_metaDataSet;
+	}
+
+	Method::Method(const char* _name, MethodInvoker _invoker, TypeID _returnType, std::vector<TypeID>&& _argumentTypes, bool _isStatic, bool _isConst, bool _returnsReference, const char* _metaDataString)
+		: m_invoker(_invoker)
+		, m_returnType(_returnType)
+		, m_argumentTypes(std::move(_argumentTypes))
+		, m_isStatic(_isStatic)
+		, m_isConst(_isConst)
+		, m_returnsReference(_returnsReference)
+		, m_metaDataSet(_metaDataString)
+	{
+		assert(_invoker != nullptr);
+		ALLOCATE_AND_COPY_STRING(m_name, _name);
+	}
+
+	Method::~Method()
+	{
+		free(m_name);
+	}
+
+	// --- Constructor
+	Class* Constructor::getOwnerClass() const
+	{
+		return m_ownerClass;
+	}
+
+	Type* Constructor::getArgumentType(size_t _index) const
+	{
+		assert(_index < m_argumentTypes.size());
+		return GetTypeSet().findTypeByID(m_argumentTypes[_index]);
+	}
+
+	Constructor::Constructor(ConstructorInvoker _invoker, BatchConstructorInvoker _batchInvoker, std::vector<TypeID>&& _argumentTypes)
+		: m_invoker(_invoker)
+		, m_batchInvoker(_batchInvoker)
+		, m_argumentTypes(std::move(_argumentTypes))
+	{
+		assert(_invoker != nullptr);
+		assert(_batchInvoker != nullptr);
+	}
+
 	// --- Enum
 	const std::vector<EnumValue*>& Enum::getValues() const
 	{
@@ -1928,6 +4419,18 @@ namespace mirror {
 		free(m_name);
 	}
 
+	// Pointees and container elements are not necessarily reflected, their ID keeps the names unique
+	static std::string GetSubTypeName(TypeID _subType)
+	{
+		Type* subType = GetTypeSet().findTypeByID(_subType);
+		if (subType != nullptr)
+			return subType->getName();
+
+		char buf[32];
+		snprintf(buf, sizeof(buf), "%zx", size_t(_subType));
+		return buf;
+	}
+
 	// --- Pointer
 	Type* Pointer::getSubType() const
 	{
@@ -1943,7 +4446,7 @@ namespace mirror {
 	void Pointer::init()
 	{
 		Type::init();
-		setName((std::string("pointer_") + std::string(FindTypeByID(m_subType)->getName())).c_str());
+		setName((std::string("pointer_") + GetSubTypeName(m_subType)).c_str());
 	}
 
 	// --- Fixed Size Array
@@ -1979,11 +4482,281 @@ namespace mirror {
 		setName(name.c_str());
 	}
 
+	// --- Sequence
+	Type* Sequence::getSubType() const
+	{
+		return GetTypeSet().findTypeByID(m_subType);
+	}
+
+	SequenceSpan Sequence::getSpan(void* _sequence) const
+	{
+		SequenceSpan span;
+		span.data = m_functions.getData(_sequence);
+		span.count = m_functions.getCount(_sequence);
+		span.stride = m_elementStride;
+		return span;
+	}
+
+	void Sequence::reserve(void* _sequence, size_t _capacity) const
+	{
+		if (m_functions.reserve != nullptr)
+		{
+			m_functions.reserve(_sequence, _capacity);
+		}
+	}
+
+	void Sequence::resize(void* _sequence, size_t _count) const
+	{
+		assert(m_functions.resize != nullptr);
+		m_functions.resize(_sequence, _count);
+	}
+
+	void* Sequence::resizeUninitialized(void* _sequence, size_t _count) const
+	{
+		Type* subType = getSubType();
+		assert(subType == nullptr || subType->isTriviallyCopyable());
+		(void)subType;
+
+		if (m_functions.resizeUninitialized != nullptr)
+		{
+			m_functions.resizeUninitialized(_sequence, _count);
+		}
+		else
+		{
+			resize(_sequence, _count);
+		}
+		return m_functions.getData(_sequence);
+	}
+
+	void Sequence::append(void* _sequence, const void* _elements, size_t _count) const
+	{
+		if (_count == 0)
+			return;
+
+		if (m_functions.append != nullptr)
+		{
+			m_functions.append(_sequence, _elements, _count);
+			return;
+		}
+
+		// Containers without bulk insertion can still be appended trivially copyable elements
+		Type* subType = getSubType();
+		assert(subType != nullptr && subType->isTriviallyCopyable());
+		size_t count = getCount(_sequence);
+		uint8_t* data = static_cast<uint8_t*>(resizeUninitialized(_sequence, count + _count));
+		memcpy(data + count * m_elementStride, _elements, _count * m_elementStride);
+	}
+
+	void Sequence::erase(void* _sequence, size_t _index, size_t _count) const
+	{
+		assert(m_functions.erase != nullptr);
+		assert(_index + _count <= getCount(_sequence));
+		m_functions.erase(_sequence, _index, _count);
+	}
+
+	Sequence::Sequence(TypeID _subType, size_t _elementStride, const char* _namePrefix, const SequenceFunctions& _functions, bool _isFixedSize, size_t _fixedCount)
+		: Type(TypeInfo_Sequence, "")
+		, m_subType(_subType)
+		, m_elementStride(_elementStride)
+		, m_namePrefix(_namePrefix)
+		, m_isFixedSize(_isFixedSize)
+		, m_fixedCount(_fixedCount)
+		, m_functions(_functions)
+	{
+		assert(_functions.getCount != nullptr);
+		assert(_functions.getData != nullptr);
+	}
+
+	void Sequence::init()
+	{
+		Type::init();
+
+		Type* subType = GetTypeSet().findTypeByID(m_subType);
+		assert(subType == nullptr || subType->getSize() == m_elementStride);
+		(void)subType;
+		if (m_namePrefix == nullptr)
+			return;
+
+		char buf[512];
+		if (m_isFixedSize)
+		{
+			snprintf(buf, sizeof(buf), "%s%zu_%s", m_namePrefix, m_fixedCount, GetSubTypeName(m_subType).c_str());
+		}
+		else
+		{
+			snprintf(buf, sizeof(buf), "%s_%s", m_namePrefix, GetSubTypeName(m_subType).c_str());
+		}
+		if (m_hasCustomParameters)
+		{
+			size_t length = strlen(buf);
+			snprintf(buf + length, sizeof(buf) - length, "_%zx", size_t(getTypeID()));
+		}
+		setName(buf);
+	}
+
+	// --- Associative
+	Type* Associative::getKeyType() const
+	{
+		return GetTypeSet().findTypeByID(m_keyType);
+	}
+
+	Type* Associative::getValueType() const
+	{
+		return GetTypeSet().findTypeByID(m_valueType);
+	}
+
+	void Associative::reserve(void* _container, size_t _count) const
+	{
+		if (m_functions.reserve != nullptr)
+		{
+			m_functions.reserve(_container, _count);
+		}
+	}
+
+	void Associative::insertBatch(void* _container, const void* _keys, const void* _values, size_t _count) const
+	{
+		assert(m_functions.insert != nullptr);
+		assert(isSet() || _values != nullptr || _count == 0);
+		reserve(_container, getCount(_container) + _count);
+
+		if (m_functions.insertBatch != nullptr)
+		{
+			m_functions.insertBatch(_container, _keys, _values, _count);
+			return;
+		}
+
+		for (size_t i = 0; i < _count; ++i)
+		{
+			const void* key = static_cast<const uint8_t*>(_keys) + i * m_keyStride;
+			const void* value = isSet() ? nullptr : static_cast<const uint8_t*>(_values) + i * m_valueStride;
+			m_functions.insert(_container, key, value);
+		}
+	}
+
+	size_t Associative::findBatch(void* _container, const void* _keys, size_t _count, void** _outValues) const
+	{
+		if (m_functions.findBatch != nullptr)
+			return m_functions.findBatch(_container, _keys, _count, _outValues);
+
+		size_t foundCount = 0;
+		for (size_t i = 0; i < _count; ++i)
+		{
+			_outValues[i] = m_functions.find(_container, static_cast<const uint8_t*>(_keys) + i * m_keyStride);
+			foundCount += _outValues[i] != nullptr ? 1 : 0;
+		}
+		return foundCount;
+	}
+
+	Associative::Associative(TypeID _keyType, size_t _keyStride, TypeID _valueType, size_t _valueStride, const char* _namePrefix, const AssociativeFunctions& _functions, bool _isOrdered)
+		: Type(TypeInfo_Associative, "")
+		, m_keyType(_keyType)
+		, m_valueType(_valueType)
+		, m_keyStride(_keyStride)
+		, m_valueStride(_valueStride)
+		, m_namePrefix(_namePrefix)
+		, m_isOrdered(_isOrdered)
+		, m_functions(_functions)
+	{
+		assert(_functions.getCount != nullptr);
+		assert(_functions.find != nullptr);
+		assert(_functions.beginCursor != nullptr && _functions.destroyCursor != nullptr && _functions.readCursor != nullptr);
+	}
+
+	void Associative::init()
+	{
+		Type::init();
+
+		Type* keyType = GetTypeSet().findTypeByID(m_keyType);
+		assert(keyType == nullptr || keyType->getSize() == m_keyStride);
+		(void)keyType;
+
+		char buf[512];
+		if (isSet())
+		{
+			snprintf(buf, sizeof(buf), "%s_%s", m_namePrefix, GetSubTypeName(m_keyType).c_str());
+		}
+		else
+		{
+			snprintf(buf, sizeof(buf), "%s_%s_%s", m_namePrefix, GetSubTypeName(m_keyType).c_str(), GetSubTypeName(m_valueType).c_str());
+		}
+		if (m_hasCustomParameters)
+		{
+			size_t length = strlen(buf);
+			snprintf(buf + length, sizeof(buf) - length, "_%zx", size_t(getTypeID()));
+		}
+		setName(buf);
+	}
+
+	AssociativeCursor::AssociativeCursor(const Associative* _type, void* _container)
+		: m_type(_type)
+		, m_container(_container)
+	{
+		assert(_type != nullptr);
+		m_type->m_functions.beginCursor(m_container, m_storage);
+	}
+
+	AssociativeCursor::~AssociativeCursor()
+	{
+		m_type->m_functions.destroyCursor(m_storage);
+	}
+
+	size_t AssociativeCursor::read(const void** _outKeys, void** _outValues, size_t _maxCount)
+	{
+		return m_type->m_functions.readCursor(m_container, m_storage, _outKeys, _outValues, _maxCount);
+	}
+
+	// --- Optional
+	Type* Optional::getSubType() const
+	{
+		return GetTypeSet().findTypeByID(m_subType);
+	}
+
+	void* Optional::emplace(void* _optional) const
+	{
+		assert(m_functions.emplace != nullptr);
+		return m_functions.emplace(_optional);
+	}
+
+	void Optional::assign(void* _optional, const void* _value) const
+	{
+		assert(m_functions.assign != nullptr);
+		m_functions.assign(_optional, _value);
+	}
+
+	Optional::Optional(TypeID _subType, const OptionalFunctions& _functions)
+		: Type(TypeInfo_Optional, "")
+		, m_subType(_subType)
+		, m_functions(_functions)
+	{
+		assert(_functions.hasValue != nullptr && _functions.getValue != nullptr && _functions.reset != nullptr);
+	}
+
+	void Optional::init()
+	{
+		Type::init();
+
+		char buf[512];
+		snprintf(buf, sizeof(buf), "optional_%s", GetSubTypeName(m_subType).c_str());
+		setName(buf);
+	}
+
 	//-----------------------------------------------------------------------------
 	// Types Implementation
 	//-----------------------------------------------------------------------------
 
+#ifdef MIRROR_STATIC_REGISTRATION
+	#define __MIRROR_TYPEDESCINITIALIZER_DEFINE(_type, _mirrorType) \
+	static TypeID GetTypeID_##_type() { return GetTypeID<_type>(); } \
+	static Type* CreateType_##_type() \
+	{ \
+		Type* typeDesc = new Type(_mirrorType, #_type); \
+		typeDesc->createVirtualTypeWrapper<_type>(); \
+		return typeDesc; \
+	} \
+	MIRROR_STATIC_REGISTRATION_SECTION static const StaticRegistration g_##_type##StaticRegistration = { &GetTypeID_##_type, &CreateType_##_type }
+#else
 	#define __MIRROR_TYPEDESCINITIALIZER_DEFINE(_type, _mirrorType) ::mirror::TypeInitializer<_type> g_##_type##TypeInitializer(_mirrorType, #_type)
+#endif
 
 	__MIRROR_TYPEDESCINITIALIZER_DEFINE(void, TypeInfo_void);
 	__MIRROR_TYPEDESCINITIALIZER_DEFINE(bool, TypeInfo_bool);
@@ -0,0 +1,1281 @@
+#pragma once
+
+//*****************************************************************************
+// mirror bitpack - quantized bit-packed encoding of reflected instances
+//*****************************************************************************
+/*
+Encodes reflected instances into a tightly packed bitstream, using member metadata to
+reduce the number of bits of each value:
+- Min, Max: range of a number. Floats are quantized over it, integers are clamped to it and
+  encoded with the bits needed by (Max - Min).
+- Bits: number of bits of a quantized float, or of an integer without range (signed integers
+  are sign extended when decoded).
+- Precision: alternative to Bits for floats, the bits are deduced from the range.
+- MaxCount: maximum element count of a sequence (std::vector, std::string...), which sets
+  the bits of its count. Decoding rejects larger counts, and counts whose elements can't fit
+  in the rest of the data, before resizing the sequence.
+Metadata given to a member applies to its nested members (e.g. the components of a vector).
+Enums are encoded as the index of their value, with the bits needed by their value count,
+and bools with a single bit. Members without metadata are encoded with all their bits,
+pointers and other members that can't be encoded are skipped.
+
+	struct Player
+	{
+		Vector3 position;
+		float health;
+		Team team;
+		std::string name;
+	};
+	MIRROR_CLASS(Player)
+	(
+		MIRROR_MEMBER(position, Min = -1024, Max = 1024, Precision = 0.01);
+		MIRROR_MEMBER(health, Min = 0, Max = 100, Bits = 7);
+		MIRROR_MEMBER(team);
+		MIRROR_MEMBER(name, MaxCount = 31);
+	);
+
+	mirror::BitWriter writer;
+	mirror::GetBitPackCodec(mirror::GetType<Player>())->encode(&player, writer);
+	writer.flush();
+	send(writer.getData(), writer.getByteCount());
+
+	mirror::BitReader reader(data, size);
+	bool valid = mirror::GetBitPackCodec(mirror::GetType<Player>())->decode(reader, &player);
+
+The codec of a type is compiled once. Bits are written least significant first.
+
+Most instances keep the default value of most of their members: the sparse functions start
+with a bitmask of the members that differ from the default instance of the class (see
+Class::getDefaultInstance), and only encode these. Decoding resets the other members to
+their default value.
+
+	codec->encodeSparse(&player, writer);
+	codec->decodeSparse(reader, &player);
+
+Large arrays of instances can be encoded and decoded on several threads: the array is split
+in chunks that are encoded into separate buffers, sized from the bits of the fixed part of the
+type, then stitched after an index of the chunks that lets the decoder process them in
+parallel too.
+
+	std::vector<uint8_t> data;
+	codec->encodeArray(entities.data(), entities.size(), data);
+
+	std::vector<Entity> decoded(mirror::BitPackCodec::ReadArrayCount(data.data(), data.size()));
+	codec->decodeArray(data.data(), data.size(), decoded.data());
+
+BitPackStreamDecoder decodes instances from input given in any number of parts (e.g. as
+asynchronous reads complete), and can be stopped after a number of fields to spread the work
+over several frames. Its state (the fields being decoded and the sequences they belong to) is
+an explicit stack, so decoding resumes in the middle of an instance when more input arrives.
+
+	mirror::BitPackStreamDecoder decoder(codec);
+	decoder.begin(&level);
+	// when a read completes
+	decoder.feed(buffer, size);
+	// every frame
+	switch (decoder.step(1000))
+	{
+		case mirror::BitPackStreamDecoder::Status_Done: ... // decoder.begin(&nextLevel) to decode the next instance of the stream
+		case mirror::BitPackStreamDecoder::Status_Error: ... // the input ended in the middle of an instance, or is invalid
+		default: break; // more input or time is needed
+	}
+
+Like mirror.h, the implementation is compiled in the file that defines MIRROR_IMPLEMENTATION.
+*/
+
+#include "mirror.h"
+
+namespace mirror {
+
+	class MIRROR_API BitWriter
+	{
+	public:
+		void write(uint64_t _value, uint32_t _bitCount); // only the low _bitCount bits of _value are written
+		void write(const BitWriter& _other);
+		void flush(); // writes the last partial byte, to be called once everything is written
+		void clear();
+		void reserve(size_t _byteCount) { m_buffer.reserve(_byteCount); }
+
+		const uint8_t* getData() const { return m_buffer.data(); }
+		size_t getByteCount() const { return m_buffer.size(); }
+		size_t getBitCount() const { return m_buffer.size() * 8 + m_scratchBitCount; }
+		bool operator==(const BitWriter& _other) const { return m_scratchBitCount == _other.m_scratchBitCount && m_scratch == _other.m_scratch && m_buffer == _other.m_buffer; }
+
+	// internal
+		std::vector<uint8_t> m_buffer;
+		uint64_t m_scratch = 0;
+		uint32_t m_scratchBitCount = 0;
+	};
+
+	class MIRROR_API BitReader
+	{
+	public:
+		BitReader(const void* _data, size_t _byteCount);
+
+		uint64_t read(uint32_t _bitCount); // reads zeros past the end of the data
+		bool hasOverflowed() const { return m_hasOverflowed; }
+		size_t getBitPosition() const { return m_position * 8 - m_scratchBitCount; }
+		size_t getRemainingBitCount() const { return m_byteCount * 8 - getBitPosition(); }
+
+	// internal
+		const uint8_t* m_data;
+		size_t m_byteCount;
+		size_t m_position = 0;
+		uint64_t m_scratch = 0;
+		uint32_t m_scratchBitCount = 0;
+		bool m_hasOverflowed = false;
+	};
+
+	class MIRROR_API BitPackCodec
+	{
+	public:
+		BitPackCodec(const Type* _type);
+		~BitPackCodec();
+		BitPackCodec(const BitPackCodec&) = delete;
+		BitPackCodec& operator=(const BitPackCodec&) = delete;
+
+		const Type* getType() const { return m_type; }
+		const TypeDependencies& getDependencies() const { return m_dependencies; }
+
+		void encode(const void* _instance, BitWriter& _writer) const;
+		// Returns false if the data is too short or invalid. Sequences are resized to the decoded count.
+		bool decode(BitReader& _reader, void* _instance) const;
+
+		// Only encode the members that differ from the default instance, after a bitmask of these members.
+		// Same as encode and decode for types that are not classes with a factory.
+		void encodeSparse(const void* _instance, BitWriter& _writer) const;
+		bool decodeSparse(BitReader& _reader, void* _instance) const;
+
+		// Encodes _count instances spaced by _stride bytes (defaults to the type size) in chunks, on _threadCount threads
+		// (0 uses every hardware thread). Replaces the content of _out.
+		void encodeArray(const void* _instances, size_t _count, std::vector<uint8_t>& _out, bool _sparse = false, uint32_t _threadCount = 0, size_t _stride = 0) const;
+		// _instances must hold ReadArrayCount() constructed instances. Returns false if the data is invalid.
+		bool decodeArray(const void* _data, size_t _size, void* _instances, uint32_t _threadCount = 0, size_t _stride = 0) const;
+		static size_t ReadArrayCount(const void* _data, size_t _size); // 0 if the data is not an encoded array
+
+		size_t getFixedBitCount() const { return m_fixedBitCount; } // bits of an instance whose sequences are empty
+
+	// internal
+		enum FieldKind
+		{
+			Field_Bool,
+			Field_Unsigned,
+			Field_Signed,
+			Field_Float,
+			Field_Double,
+			Field_QuantizedFloat,
+			Field_QuantizedDouble,
+			Field_Enum,
+			Field_Sequence,
+		};
+
+		struct Field
+		{
+			FieldKind kind;
+			size_t offset;
+			size_t size;
+			uint32_t bitCount; // count bits for sequences
+			uint64_t maxCount; // sequences only, 0 when unbounded
+			bool hasRange;
+			int64_t minInteger;
+			int64_t maxInteger;
+			double min;
+			double max;
+			std::vector<int64_t> enumValues;
+			const Sequence* sequence;
+			const BitPackCodec* elementCodec;
+		};
+
+		struct Options
+		{
+			const char* min = nullptr;
+			const char* max = nullptr;
+			const char* bits = nullptr;
+			const char* precision = nullptr;
+			const char* maxCount = nullptr;
+		};
+
+		struct MemberFields
+		{
+			const ClassMember* member;
+			size_t firstField;
+			size_t endField;
+			BitWriter defaultEncoding; // members that are not trivially copyable are compared encoded
+		};
+
+		BitPackCodec(const Type* _type, const Options& _options, BitPackCodec* _root);
+		void build();
+		void encodeDefaultMembers();
+		const BitPackCodec* createElementCodec(const Type* _type, const Options& _options);
+		void compile(const Type* _type, size_t _offset, const Options& _options);
+		void encodeFields(const uint8_t* _instance, size_t _firstField, size_t _endField, BitWriter& _writer) const;
+		bool decodeFields(BitReader& _reader, size_t _firstField, size_t _endField, uint8_t* _instance) const;
+		bool isDefault(const MemberFields& _member, const uint8_t* _instance, BitWriter& _scratch) const;
+		void resetMember(const MemberFields& _member, uint8_t* _instance) const;
+		static uint32_t GetBitCount(uint64_t _maxValue);
+		static bool FitsSequenceCount(const Field& _field, uint64_t _count, size_t _remainingBitCount);
+		static bool IsSameOptions(const Options& _a, const Options& _b);
+
+		struct ArrayHeader
+		{
+			char magic[4];
+			uint32_t isSparse;
+			uint64_t count;
+			uint64_t chunkInstanceCount;
+			uint64_t chunkCount;
+		};
+
+		struct ArrayChunk
+		{
+			uint64_t offset;
+			uint64_t size;
+		};
+
+		static const size_t MIN_CHUNK_INSTANCE_COUNT = 256;
+
+		const Type* m_type;
+		Options m_options;
+		BitPackCodec* m_root; // owns the element codecs of the whole tree
+		std::vector<Field> m_fields;
+		std::vector<BitPackCodec*> m_elementCodecs; // root only, shared by recursive types
+		std::vector<MemberFields> m_members; // top level members of classes with a default instance
+		size_t m_fixedBitCount = 0;
+		TypeDependencies m_dependencies; // root only
+	};
+
+	class MIRROR_API BitPackStreamDecoder
+	{
+	public:
+		enum Status
+		{
+			Status_InProgress, // step stopped after _maxFieldCount fields
+			Status_NeedInput,
+			Status_Done,
+			Status_Error, // the input ended in the middle of an instance, or a sequence count is invalid
+		};
+
+		// The decoder keeps the codec alive
+		BitPackStreamDecoder(std::shared_ptr<const BitPackCodec> _codec, bool _isSparse = false);
+
+		// Starts decoding an instance, the input left by the previous one is kept
+		void begin(void* _instance);
+		// The data is copied
+		void feed(const void* _data, size_t _size);
+		void endInput();
+
+		// Decodes until the instance is done, the input runs out or _maxFieldCount fields were decoded
+		Status step(size_t _maxFieldCount = SIZE_MAX);
+		Status getStatus() const { return m_status; }
+		size_t getBufferedBitCount() const { return m_input.size() * 8 - m_bitPosition; }
+
+	// internal
+		enum FrameKind
+		{
+			Frame_Fields,
+			Frame_SparseMask,
+			Frame_SparseMembers,
+			Frame_Sequence,
+		};
+
+		struct Frame
+		{
+			FrameKind kind;
+			const BitPackCodec* codec;
+			uint8_t* instance;
+			size_t index;
+			size_t end;
+			const BitPackCodec::Field* field; // sequences only
+		};
+
+		BitReader getReader() const;
+
+		std::shared_ptr<const BitPackCodec> m_codec;
+		bool m_isSparse;
+		std::vector<Frame> m_stack;
+		std::vector<bool> m_presentMembers;
+		std::vector<uint8_t> m_input;
+		size_t m_bitPosition = 0;
+		bool m_isInputEnded = false;
+		Status m_status = Status_Done;
+	};
+
+	// Codecs are cached per type, see TypeCache
+	MIRROR_API std::shared_ptr<const BitPackCodec> GetBitPackCodec(const Type* _type);
+
+} // namespace mirror
+
+//*****************************************************************************
+// Implementation
+//*****************************************************************************
+
+#ifdef MIRROR_IMPLEMENTATION
+
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+namespace mirror {
+
+	//-----------------------------------------------------------------------------
+	// BitWriter
+	//-----------------------------------------------------------------------------
+
+	void BitWriter::write(uint64_t _value, uint32_t _bitCount)
+	{
+		assert(_bitCount <= 64);
+
+		// 32 bits at a time, so that the scratch (less than a byte between writes) never overflows
+		while (_bitCount > 0)
+		{
+			uint32_t bitCount = std::min<uint32_t>(_bitCount, 32);
+			m_scratch |= (_value & ((uint64_t(1) << bitCount) - 1)) << m_scratchBitCount;
+			m_scratchBitCount += bitCount;
+			_value = bitCount < 64 ? _value >> bitCount : 0;
+			_bitCount -= bitCount;
+
+			while (m_scratchBitCount >= 8)
+			{
+				m_buffer.push_back(uint8_t(m_scratch));
+				m_scratch >>= 8;
+				m_scratchBitCount -= 8;
+			}
+		}
+	}
+
+	void BitWriter::write(const BitWriter& _other)
+	{
+		if (m_scratchBitCount == 0)
+		{
+			m_buffer.insert(m_buffer.end(), _other.m_buffer.begin(), _other.m_buffer.end());
+		}
+		else
+		{
+			for (uint8_t byte : _other.m_buffer)
+			{
+				write(byte, 8);
+			}
+		}
+		write(_other.m_scratch, _other.m_scratchBitCount);
+	}
+
+	void BitWriter::flush()
+	{
+		if (m_scratchBitCount > 0)
+		{
+			m_buffer.push_back(uint8_t(m_scratch));
+			m_scratch = 0;
+			m_scratchBitCount = 0;
+		}
+	}
+
+	void BitWriter::clear()
+	{
+		m_buffer.clear();
+		m_scratch = 0;
+		m_scratchBitCount = 0;
+	}
+
+	//-----------------------------------------------------------------------------
+	// BitReader
+	//-----------------------------------------------------------------------------
+
+	BitReader::BitReader(const void* _data, size_t _byteCount)
+		: m_data(static_cast<const uint8_t*>(_data))
+		, m_byteCount(_byteCount)
+	{
+	}
+
+	uint64_t BitReader::read(uint32_t _bitCount)
+	{
+		assert(_bitCount <= 64);
+
+		uint64_t value = 0;
+		uint32_t readBitCount = 0;
+		while (readBitCount < _bitCount)
+		{
+			uint32_t bitCount = std::min<uint32_t>(_bitCount - readBitCount, 32);
+			while (m_scratchBitCount < bitCount)
+			{
+				if (m_position < m_byteCount)
+				{
+					m_scratch |= uint64_t(m_data[m_position]) << m_scratchBitCount;
+				}
+				else
+				{
+					m_hasOverflowed = true;
+				}
+				++m_position;
+				m_scratchBitCount += 8;
+			}
+
+			value |= (m_scratch & ((uint64_t(1) << bitCount) - 1)) << readBitCount;
+			m_scratch >>= bitCount;
+			m_scratchBitCount -= bitCount;
+			readBitCount += bitCount;
+		}
+		return value;
+	}
+
+	//-----------------------------------------------------------------------------
+	// BitPackCodec
+	//-----------------------------------------------------------------------------
+
+	BitPackCodec::BitPackCodec(const Type* _type)
+		: BitPackCodec(_type, Options(), this)
+	{
+		build();
+
+		// Default members are encoded once every element codec is compiled
+		encodeDefaultMembers();
+		for (BitPackCodec* codec : m_elementCodecs)
+		{
+			codec->encodeDefaultMembers();
+		}
+	}
+
+	BitPackCodec::BitPackCodec(const Type* _type, const Options& _options, BitPackCodec* _root)
+		: m_type(_type)
+		, m_options(_options)
+		, m_root(_root)
+	{
+		assert(_type != nullptr);
+	}
+
+	void BitPackCodec::build()
+	{
+		compile(m_type, 0, m_options);
+		for (const Field& field : m_fields)
+		{
+			m_fixedBitCount += field.bitCount;
+		}
+	}
+
+	void BitPackCodec::encodeDefaultMembers()
+	{
+		const Class* clss = m_type->asClass();
+		const uint8_t* defaultInstance = clss != nullptr ? static_cast<const uint8_t*>(clss->getDefaultInstance()) : nullptr;
+		for (MemberFields& member : m_members)
+		{
+			const Type* memberType = member.member->getType();
+			if (defaultInstance == nullptr || !memberType->isCopyConstructible())
+			{
+				// Every member is encoded when some of them can't be reset
+				m_members.clear();
+				break;
+			}
+			if (!memberType->isTriviallyCopyable())
+			{
+				encodeFields(defaultInstance, member.firstField, member.endField, member.defaultEncoding);
+			}
+		}
+	}
+
+	BitPackCodec::~BitPackCodec()
+	{
+		for (BitPackCodec* codec : m_elementCodecs)
+		{
+			delete codec;
+		}
+	}
+
+	const BitPackCodec* BitPackCodec::createElementCodec(const Type* _type, const Options& _options)
+	{
+		// Recursive types (e.g. a class holding a vector of itself) reuse the codec being compiled
+		if (_type == m_root->m_type && IsSameOptions(_options, m_root->m_options))
+		{
+			return m_root;
+		}
+		for (const BitPackCodec* codec : m_root->m_elementCodecs)
+		{
+			if (_type == codec->m_type && IsSameOptions(_options, codec->m_options))
+			{
+				return codec;
+			}
+		}
+
+		// Registered before compiling so that it can refer to itself
+		BitPackCodec* codec = new BitPackCodec(_type, _options, m_root);
+		m_root->m_elementCodecs.push_back(codec);
+		codec->build();
+		return codec;
+	}
+
+	void BitPackCodec::encode(const void* _instance, BitWriter& _writer) const
+	{
+		encodeFields(static_cast<const uint8_t*>(_instance), 0, m_fields.size(), _writer);
+	}
+
+	bool BitPackCodec::decode(BitReader& _reader, void* _instance) const
+	{
+		return decodeFields(_reader, 0, m_fields.size(), static_cast<uint8_t*>(_instance));
+	}
+
+	void BitPackCodec::encodeSparse(const void* _instance, BitWriter& _writer) const
+	{
+		if (m_members.empty())
+		{
+			encode(_instance, _writer);
+			return;
+		}
+
+		const uint8_t* instance = static_cast<const uint8_t*>(_instance);
+		std::vector<BitWriter> encodings(m_members.size());
+		std::vector<bool> isPresent(m_members.size());
+		for (size_t i = 0; i < m_members.size(); ++i)
+		{
+			isPresent[i] = !isDefault(m_members[i], instance, encodings[i]);
+			_writer.write(isPresent[i] ? 1 : 0, 1);
+		}
+
+		for (size_t i = 0; i < m_members.size(); ++i)
+		{
+			if (!isPresent[i])
+				continue;
+
+			// Members that were compared encoded are not encoded twice
+			if (encodings[i].getBitCount() > 0)
+			{
+				_writer.write(encodings[i]);
+			}
+			else
+			{
+				encodeFields(instance, m_members[i].firstField, m_members[i].endField, _writer);
+			}
+		}
+	}
+
+	bool BitPackCodec::decodeSparse(BitReader& _reader, void* _instance) const
+	{
+		if (m_members.empty())
+			return decode(_reader, _instance);
+
+		uint8_t* instance = static_cast<uint8_t*>(_instance);
+		std::vector<bool> isPresent(m_members.size());
+		for (size_t i = 0; i < m_members.size(); ++i)
+		{
+			isPresent[i] = _reader.read(1) != 0;
+		}
+		if (_reader.hasOverflowed())
+			return false;
+
+		for (size_t i = 0; i < m_members.size(); ++i)
+		{
+			const MemberFields& member = m_members[i];
+			if (isPresent[i])
+			{
+				if (!decodeFields(_reader, member.firstField, member.endField, instance))
+					return false;
+			}
+			else
+			{
+				resetMember(member, instance);
+			}
+		}
+		return !_reader.hasOverflowed();
+	}
+
+	void BitPackCodec::resetMember(const MemberFields& _member, uint8_t* _instance) const
+	{
+		const uint8_t* defaultInstance = static_cast<const uint8_t*>(m_type->asClass()->getDefaultInstance());
+		const Type* memberType = _member.member->getType();
+		size_t offset = _member.member->getOffset();
+		if (memberType->isTriviallyCopyable())
+		{
+			memcpy(_instance + offset, defaultInstance + offset, memberType->getSize());
+		}
+		else
+		{
+			memberType->destruct(_instance + offset);
+			memberType->copyConstruct(_instance + offset, defaultInstance + offset);
+		}
+	}
+
+	bool BitPackCodec::isDefault(const MemberFields& _member, const uint8_t* _instance, BitWriter& _scratch) const
+	{
+		const Type* memberType = _member.member->getType();
+		size_t offset = _member.member->getOffset();
+		if (memberType->isTriviallyCopyable())
+		{
+			const uint8_t* defaultInstance = static_cast<const uint8_t*>(m_type->asClass()->getDefaultInstance());
+			return memcmp(_instance + offset, defaultInstance + offset, memberType->getSize()) == 0;
+		}
+
+		encodeFields(_instance, _member.firstField, _member.endField, _scratch);
+		return _scratch == _member.defaultEncoding;
+	}
+
+	void BitPackCodec::encodeFields(const uint8_t* _instance, size_t _firstField, size_t _endField, BitWriter& _writer) const
+	{
+		for (size_t fieldIndex = _firstField; fieldIndex < _endField; ++fieldIndex)
+		{
+			const Field& field = m_fields[fieldIndex];
+			const uint8_t* data = _instance + field.offset;
+			switch (field.kind)
+			{
+				case Field_Bool:
+					_writer.write(*data != 0 ? 1 : 0, 1);
+					break;
+
+				case Field_Unsigned:
+				case Field_Signed:
+				{
+					int64_t value = ReadInteger(data, field.size, field.kind == Field_Signed);
+					if (field.hasRange)
+					{
+						value = std::min(std::max(value, field.minInteger), field.maxInteger);
+						// Unsigned arithmetic, the range may not fit in int64_t
+						_writer.write(uint64_t(value) - uint64_t(field.minInteger), field.bitCount);
+					}
+					else
+					{
+						_writer.write(uint64_t(value), field.bitCount);
+					}
+				}
+				break;
+
+				case Field_Float:
+				{
+					uint32_t bits;
+					memcpy(&bits, data, sizeof(bits));
+					_writer.write(bits, 32);
+				}
+				break;
+
+				case Field_Double:
+				{
+					uint64_t bits;
+					memcpy(&bits, data, sizeof(bits));
+					_writer.write(bits, 64);
+				}
+				break;
+
+				case Field_QuantizedFloat:
+				case Field_QuantizedDouble:
+				{
+					double value;
+					if (field.kind == Field_QuantizedFloat)
+					{
+						float f;
+						memcpy(&f, data, sizeof(f));
+						value = f;
+					}
+					else
+					{
+						memcpy(&value, data, sizeof(value));
+					}
+
+					double maxStep = double((uint64_t(1) << field.bitCount) - 1);
+					double normalized = (std::min(std::max(value, field.min), field.max) - field.min) / (field.max - field.min);
+					_writer.write(uint64_t(std::llround(std::isnan(normalized) ? 0.0 : normalized * maxStep)), field.bitCount);
+				}
+				break;
+
+				case Field_Enum:
+				{
+					int64_t value = ReadInteger(data, field.size, true);
+					auto it = std::find(field.enumValues.begin(), field.enumValues.end(), value);
+					assert(it != field.enumValues.end() && "value is not part of the enum");
+					_writer.write(it != field.enumValues.end() ? uint64_t(it - field.enumValues.begin()) : 0, field.bitCount);
+				}
+				break;
+
+				case Field_Sequence:
+				{
+					SequenceSpan span = field.sequence->getSpan(const_cast<uint8_t*>(data));
+					size_t count = std::min<uint64_t>(span.count, field.bitCount < 64 ? (uint64_t(1) << field.bitCount) - 1 : UINT64_MAX);
+					_writer.write(count, field.bitCount);
+					for (size_t i = 0; i < count; ++i)
+					{
+						field.elementCodec->encode(span.at(i), _writer);
+					}
+				}
+				break;
+			}
+		}
+	}
+
+	bool BitPackCodec::decodeFields(BitReader& _reader, size_t _firstField, size_t _endField, uint8_t* _instance) const
+	{
+		for (size_t fieldIndex = _firstField; fieldIndex < _endField; ++fieldIndex)
+		{
+			const Field& field = m_fields[fieldIndex];
+			uint8_t* data = _instance + field.offset;
+			switch (field.kind)
+			{
+				case Field_Bool:
+					*data = uint8_t(_reader.read(1));
+					break;
+
+				case Field_Unsigned:
+				case Field_Signed:
+				{
+					uint64_t bits = _reader.read(field.bitCount);
+					int64_t value;
+					if (field.hasRange)
+					{
+						// The range is not a power of two, the data may not be trusted
+						if (bits > uint64_t(field.maxInteger) - uint64_t(field.minInteger))
+							return false;
+						value = int64_t(uint64_t(field.minInteger) + bits);
+					}
+					else if (field.kind == Field_Signed && field.bitCount < 64)
+					{
+						uint64_t signBit = uint64_t(1) << (field.bitCount - 1);
+						value = int64_t((bits ^ signBit) - signBit);
+					}
+					else
+					{
+						value = int64_t(bits);
+					}
+					WriteInteger(data, field.size, value);
+				}
+				break;
+
+				case Field_Float:
+				{
+					uint32_t bits = uint32_t(_reader.read(32));
+					memcpy(data, &bits, sizeof(bits));
+				}
+				break;
+
+				case Field_Double:
+				{
+					uint64_t bits = _reader.read(64);
+					memcpy(data, &bits, sizeof(bits));
+				}
+				break;
+
+				case Field_QuantizedFloat:
+				case Field_QuantizedDouble:
+				{
+					double maxStep = double((uint64_t(1) << field.bitCount) - 1);
+					double value = field.min + double(_reader.read(field.bitCount)) / maxStep * (field.max - field.min);
+					if (field.kind == Field_QuantizedFloat)
+					{
+						float f = float(value);
+						memcpy(data, &f, sizeof(f));
+					}
+					else
+					{
+						memcpy(data, &value, sizeof(value));
+					}
+				}
+				break;
+
+				case Field_Enum:
+				{
+					size_t index = size_t(_reader.read(field.bitCount));
+					WriteInteger(data, field.size, index < field.enumValues.size() ? field.enumValues[index] : 0);
+				}
+				break;
+
+				case Field_Sequence:
+				{
+					// The count is checked before resizing, the data may not be trusted
+					uint64_t count = _reader.read(field.bitCount);
+					if (_reader.hasOverflowed() || (field.maxCount != 0 && count > field.maxCount) || !FitsSequenceCount(field, count, _reader.getRemainingBitCount()))
+						return false;
+
+					field.sequence->resize(data, size_t(count));
+					SequenceSpan span = field.sequence->getSpan(data);
+					for (size_t i = 0; i < span.count; ++i)
+					{
+						if (!field.elementCodec->decode(_reader, span.at(i)))
+							return false;
+					}
+				}
+				break;
+			}
+		}
+		return !_reader.hasOverflowed();
+	}
+
+	void BitPackCodec::compile(const Type* _type, size_t _offset, const Options& _options)
+	{
+		if (_type == nullptr)
+			return;
+
+		m_root->m_dependencies.add(_type);
+
+		Field field = {};
+		field.offset = _offset;
+		field.size = _type->getSize();
+		field.minInteger = _options.min != nullptr ? strtoll(_options.min, nullptr, 0) : 0;
+		field.maxInteger = _options.max != nullptr ? strtoll(_options.max, nullptr, 0) : 0;
+		field.min = _options.min != nullptr ? strtod(_options.min, nullptr) : 0.0;
+		field.max = _options.max != nullptr ? strtod(_options.max, nullptr) : 0.0;
+		bool hasRange = _options.min != nullptr && _options.max != nullptr;
+		uint32_t bits = _options.bits != nullptr ? uint32_t(atoi(_options.bits)) : 0;
+
+		TypeInfo typeInfo = _type->getTypeInfo();
+		switch (typeInfo)
+		{
+			case TypeInfo_bool:
+				field.kind = Field_Bool;
+				field.bitCount = 1;
+				m_fields.push_back(field);
+				break;
+
+			case TypeInfo_char:
+			case TypeInfo_int8:
+			case TypeInfo_int16:
+			case TypeInfo_int32:
+			case TypeInfo_int64:
+			case TypeInfo_uint8:
+			case TypeInfo_uint16:
+			case TypeInfo_uint32:
+			case TypeInfo_uint64:
+			{
+				bool isSigned = typeInfo == TypeInfo_int8 || typeInfo == TypeInfo_int16 || typeInfo == TypeInfo_int32 || typeInfo == TypeInfo_int64
+					|| (typeInfo == TypeInfo_char && std::is_signed<char>::value);
+				field.kind = isSigned ? Field_Signed : Field_Unsigned;
+				if (hasRange)
+				{
+					assert(field.maxInteger >= field.minInteger);
+					field.hasRange = true;
+					field.bitCount = GetBitCount(uint64_t(field.maxInteger) - uint64_t(field.minInteger));
+				}
+				else
+				{
+					field.bitCount = bits != 0 ? std::min<uint32_t>(bits, uint32_t(field.size * 8)) : uint32_t(field.size * 8);
+				}
+				m_fields.push_back(field);
+			}
+			break;
+
+			case TypeInfo_float:
+			case TypeInfo_double:
+			{
+				bool isFloat = typeInfo == TypeInfo_float;
+				if (hasRange && (bits != 0 || _options.precision != nullptr))
+				{
+					assert(field.max > field.min);
+					field.kind = isFloat ? Field_QuantizedFloat : Field_QuantizedDouble;
+					if (bits == 0)
+					{
+						double precision = strtod(_options.precision, nullptr);
+						assert(precision > 0.0);
+						bits = GetBitCount(uint64_t(std::ceil((field.max - field.min) / precision)));
+					}
+					field.bitCount = std::min<uint32_t>(bits, isFloat ? 32 : 63);
+				}
+				else
+				{
+					field.kind = isFloat ? Field_Float : Field_Double;
+					field.bitCount = isFloat ? 32 : 64;
+				}
+				m_fields.push_back(field);
+			}
+			break;
+
+			case TypeInfo_Enum:
+			{
+				field.kind = Field_Enum;
+				for (const EnumValue* value : _type->asEnum()->getValues())
+				{
+					field.enumValues.push_back(TruncateInteger(value->getValue(), field.size));
+				}
+				field.bitCount = field.enumValues.empty() ? 0 : GetBitCount(field.enumValues.size() - 1);
+				m_fields.push_back(field);
+			}
+			break;
+
+			case TypeInfo_Class:
+			{
+				for (ClassMember* member : _type->asClass()->getMembers())
+				{
+					const MetaDataSet& metaDataSet = member->getMetaDataSet();
+					Options options = _options;
+					const char* keys[] = { "Min", "Max", "Bits", "Precision", "MaxCount" };
+					const char** values[] = { &options.min, &options.max, &options.bits, &options.precision, &options.maxCount };
+					for (size_t i = 0; i < 5; ++i)
+					{
+						if (const MetaData* metaData = metaDataSet.findMetaData(keys[i]))
+						{
+							*values[i] = metaData->asString();
+						}
+					}
+					size_t firstField = m_fields.size();
+					compile(member->getType(), _offset + member->getOffset(), options);
+
+					// Fields are grouped by top level member for sparse encoding, members without fields are left alone
+					if (_type == m_type && m_fields.size() > firstField)
+					{
+						m_members.push_back({ member, firstField, m_fields.size(), BitWriter() });
+					}
+				}
+			}
+			break;
+
+			case TypeInfo_FixedSizeArray:
+			{
+				const FixedSizeArray* fixedSizeArray = _type->asFixedSizeArray();
+				const Type* subType = fixedSizeArray->getSubType();
+				for (size_t i = 0; subType != nullptr && i < fixedSizeArray->getElementCount(); ++i)
+				{
+					compile(subType, _offset + i * subType->getSize(), _options);
+				}
+			}
+			break;
+
+			case TypeInfo_Sequence:
+			{
+				const Sequence* sequence = _type->asSequence();
+				if (sequence->isFixedSize())
+				{
+					for (size_t i = 0; i < sequence->getFixedCount(); ++i)
+					{
+						compile(sequence->getSubType(), _offset + i * sequence->getElementStride(), _options);
+					}
+				}
+				else if (sequence->getSubType() != nullptr && sequence->m_functions.resize != nullptr)
+				{
+					// The count is not part of the element options
+					Options elementOptions = _options;
+					elementOptions.maxCount = nullptr;
+
+					field.kind = Field_Sequence;
+					field.sequence = sequence;
+					field.elementCodec = createElementCodec(sequence->getSubType(), elementOptions);
+					field.maxCount = _options.maxCount != nullptr ? strtoull(_options.maxCount, nullptr, 0) : 0;
+					field.bitCount = _options.maxCount != nullptr ? GetBitCount(field.maxCount) : 32;
+					m_fields.push_back(field);
+				}
+			}
+			break;
+
+			default:
+				break;
+		}
+	}
+
+	void BitPackCodec::encodeArray(const void* _instances, size_t _count, std::vector<uint8_t>& _out, bool _sparse, uint32_t _threadCount, size_t _stride) const
+	{
+		assert(_instances != nullptr || _count == 0);
+
+		size_t stride = _stride != 0 ? _stride : m_type->getSize();
+		size_t threadCount = _threadCount != 0 ? _threadCount : std::max(1u, std::thread::hardware_concurrency());
+		const uint8_t* instances = static_cast<const uint8_t*>(_instances);
+
+		// A few chunks per thread, so that threads finishing early can take more
+		size_t chunkInstanceCount = std::max(size_t(MIN_CHUNK_INSTANCE_COUNT), (_count + threadCount * 4 - 1) / (threadCount * 4));
+		size_t chunkCount = (_count + chunkInstanceCount - 1) / chunkInstanceCount;
+		size_t headerSize = sizeof(ArrayHeader) + chunkCount * sizeof(ArrayChunk);
+
+		std::vector<BitWriter> writers(chunkCount);
+		RunParallel(chunkCount, [&](size_t _chunk)
+		{
+			size_t first = _chunk * chunkInstanceCount;
+			size_t end = std::min(_count, first + chunkInstanceCount);
+			BitWriter& writer = writers[_chunk];
+			writer.reserve(((end - first) * m_fixedBitCount + 7) / 8);
+			for (size_t i = first; i < end; ++i)
+			{
+				if (_sparse)
+				{
+					encodeSparse(instances + i * stride, writer);
+				}
+				else
+				{
+					encode(instances + i * stride, writer);
+				}
+			}
+			writer.flush();
+		}, threadCount);
+
+		ArrayHeader header = {};
+		memcpy(header.magic, "MBPA", 4);
+		header.isSparse = _sparse ? 1 : 0;
+		header.count = _count;
+		header.chunkInstanceCount = chunkInstanceCount;
+		header.chunkCount = chunkCount;
+
+		std::vector<ArrayChunk> chunks(chunkCount);
+		size_t size = headerSize;
+		for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			chunks[chunk] = { size, writers[chunk].getByteCount() };
+			size += writers[chunk].getByteCount();
+		}
+
+		_out.resize(size);
+		memcpy(_out.data(), &header, sizeof(header));
+		if (chunkCount > 0)
+		{
+			memcpy(_out.data() + sizeof(ArrayHeader), chunks.data(), chunkCount * sizeof(ArrayChunk));
+		}
+
+		RunParallel(chunkCount, [&](size_t _chunk)
+		{
+			if (chunks[_chunk].size > 0)
+			{
+				memcpy(_out.data() + chunks[_chunk].offset, writers[_chunk].getData(), size_t(chunks[_chunk].size));
+			}
+		}, threadCount);
+	}
+
+	bool BitPackCodec::decodeArray(const void* _data, size_t _size, void* _instances, uint32_t _threadCount, size_t _stride) const
+	{
+		size_t count = ReadArrayCount(_data, _size);
+		if (count == 0)
+			return _size >= sizeof(ArrayHeader) && memcmp(_data, "MBPA", 4) == 0;
+
+		const uint8_t* data = static_cast<const uint8_t*>(_data);
+		ArrayHeader header;
+		memcpy(&header, data, sizeof(header));
+		size_t chunkCount = size_t(header.chunkCount);
+		size_t chunkInstanceCount = size_t(header.chunkInstanceCount);
+		std::vector<ArrayChunk> chunks(chunkCount);
+		memcpy(chunks.data(), data + sizeof(ArrayHeader), chunkCount * sizeof(ArrayChunk));
+		for (const ArrayChunk& chunk : chunks)
+		{
+			if (chunk.offset > _size || chunk.size > _size - chunk.offset)
+				return false;
+		}
+
+		size_t stride = _stride != 0 ? _stride : m_type->getSize();
+		size_t threadCount = _threadCount != 0 ? _threadCount : std::max(1u, std::thread::hardware_concurrency());
+		uint8_t* instances = static_cast<uint8_t*>(_instances);
+		bool isSparse = header.isSparse != 0;
+
+		std::atomic<bool> isValid = { true };
+		RunParallel(chunkCount, [&](size_t _chunk)
+		{
+			if (!isValid)
+				return;
+
+			BitReader reader(data + chunks[_chunk].offset, size_t(chunks[_chunk].size));
+			size_t first = _chunk * chunkInstanceCount;
+			size_t end = std::min(count, first + chunkInstanceCount);
+			for (size_t i = first; i < end; ++i)
+			{
+				bool isDecoded = isSparse ? decodeSparse(reader, instances + i * stride) : decode(reader, instances + i * stride);
+				if (!isDecoded)
+				{
+					isValid = false;
+					break;
+				}
+			}
+		}, threadCount);
+		return isValid;
+	}
+
+	size_t BitPackCodec::ReadArrayCount(const void* _data, size_t _size)
+	{
+		if (_data == nullptr || _size < sizeof(ArrayHeader))
+			return 0;
+
+		ArrayHeader header;
+		memcpy(&header, _data, sizeof(header));
+		if (memcmp(header.magic, "MBPA", 4) != 0 || header.chunkInstanceCount == 0)
+			return 0;
+
+		// The chunks must cover the instances, and their index must fit in the data
+		if (header.chunkCount > (_size - sizeof(ArrayHeader)) / sizeof(ArrayChunk) || header.chunkCount != (header.count + header.chunkInstanceCount - 1) / header.chunkInstanceCount)
+			return 0;
+
+		return size_t(header.count);
+	}
+
+	uint32_t BitPackCodec::GetBitCount(uint64_t _maxValue)
+	{
+		uint32_t bitCount = 0;
+		while (bitCount < 64 && (_maxValue >> bitCount) != 0)
+		{
+			++bitCount;
+		}
+		return bitCount;
+	}
+
+	bool BitPackCodec::FitsSequenceCount(const Field& _field, uint64_t _count, size_t _remainingBitCount)
+	{
+		// Elements without fixed bits (e.g. empty classes) can't be bounded by the data
+		size_t elementBitCount = _field.elementCodec->getFixedBitCount();
+		return elementBitCount == 0 || _count <= _remainingBitCount / elementBitCount;
+	}
+
+	bool BitPackCodec::IsSameOptions(const Options& _a, const Options& _b)
+	{
+		const char* a[] = { _a.min, _a.max, _a.bits, _a.precision, _a.maxCount };
+		const char* b[] = { _b.min, _b.max, _b.bits, _b.precision, _b.maxCount };
+		for (size_t i = 0; i < 5; ++i)
+		{
+			if ((a[i] == nullptr) != (b[i] == nullptr) || (a[i] != nullptr && strcmp(a[i], b[i]) != 0))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//-----------------------------------------------------------------------------
+	// BitPackStreamDecoder
+	//-----------------------------------------------------------------------------
+
+	BitPackStreamDecoder::BitPackStreamDecoder(std::shared_ptr<const BitPackCodec> _codec, bool _isSparse)
+		: m_codec(std::move(_codec))
+		, m_isSparse(_isSparse)
+	{
+		assert(m_codec != nullptr);
+	}
+
+	void BitPackStreamDecoder::begin(void* _instance)
+	{
+		assert(_instance != nullptr);
+		m_stack.clear();
+		if (m_isSparse && !m_codec->m_members.empty())
+		{
+			m_stack.push_back({ Frame_SparseMask, m_codec.get(), static_cast<uint8_t*>(_instance), 0, m_codec->m_members.size(), nullptr });
+		}
+		else
+		{
+			m_stack.push_back({ Frame_Fields, m_codec.get(), static_cast<uint8_t*>(_instance), 0, m_codec->m_fields.size(), nullptr });
+		}
+		m_status = Status_InProgress;
+	}
+
+	void BitPackStreamDecoder::feed(const void* _data, size_t _size)
+	{
+		assert(!m_isInputEnded);
+
+		// Consumed bytes are dropped
+		m_input.erase(m_input.begin(), m_input.begin() + m_bitPosition / 8);
+		m_bitPosition %= 8;
+
+		const uint8_t* data = static_cast<const uint8_t*>(_data);
+		m_input.insert(m_input.end(), data, data + _size);
+	}
+
+	void BitPackStreamDecoder::endInput()
+	{
+		m_isInputEnded = true;
+	}
+
+	BitReader BitPackStreamDecoder::getReader() const
+	{
+		size_t bytePosition = m_bitPosition / 8;
+		BitReader reader(m_input.data() + bytePosition, m_input.size() - bytePosition);
+		reader.read(uint32_t(m_bitPosition % 8));
+		return reader;
+	}
+
+	BitPackStreamDecoder::Status BitPackStreamDecoder::step(size_t _maxFieldCount)
+	{
+		if (m_status == Status_Done || m_status == Status_Error)
+			return m_status;
+
+		size_t fieldCount = 0;
+		while (!m_stack.empty())
+		{
+			if (fieldCount >= _maxFieldCount)
+				return m_status = Status_InProgress;
+
+			Frame& frame = m_stack.back();
+			if (frame.index == frame.end)
+			{
+				m_stack.pop_back();
+				continue;
+			}
+
+			// Every step needs a known number of bits, nothing is consumed until they are all available
+			uint32_t bitCount = 0;
+			switch (frame.kind)
+			{
+				case Frame_Fields: bitCount = frame.codec->m_fields[frame.index].bitCount; break;
+				case Frame_SparseMask: bitCount = uint32_t(frame.end); break;
+				default: break;
+			}
+			if (bitCount > getBufferedBitCount())
+				return m_status = m_isInputEnded ? Status_Error : Status_NeedInput;
+
+			switch (frame.kind)
+			{
+				case Frame_Fields:
+				{
+					const BitPackCodec::Field& field = frame.codec->m_fields[frame.index];
+					BitReader reader = getReader();
+					if (field.kind == BitPackCodec::Field_Sequence)
+					{
+						// The sequence is only resized once the fixed bits of all its elements are buffered, so that invalid counts are never allocated
+						uint64_t count = reader.read(field.bitCount);
+						if (field.maxCount != 0 && count > field.maxCount)
+							return m_status = Status_Error;
+						if (!BitPackCodec::FitsSequenceCount(field, count, getBufferedBitCount() - bitCount))
+							return m_status = m_isInputEnded ? Status_Error : Status_NeedInput;
+
+						// The elements are decoded one by one from a sequence frame
+						uint8_t* sequence = frame.instance + field.offset;
+						field.sequence->resize(sequence, size_t(count));
+						++frame.index;
+						m_stack.push_back({ Frame_Sequence, field.elementCodec, sequence, 0, count, &field });
+					}
+					else
+					{
+						// Every bit of the field is buffered, failing means the value is out of range
+						if (!frame.codec->decodeFields(reader, frame.index, frame.index + 1, frame.instance))
+							return m_status = Status_Error;
+						++frame.index;
+					}
+					m_bitPosition += bitCount;
+					++fieldCount;
+				}
+				break;
+
+				case Frame_SparseMask:
+				{
+					BitReader reader = getReader();
+					m_presentMembers.resize(frame.end);
+					for (size_t i = 0; i < frame.end; ++i)
+					{
+						m_presentMembers[i] = reader.read(1) != 0;
+					}
+					m_bitPosition += bitCount;
+					frame.kind = Frame_SparseMembers;
+				}
+				break;
+
+				case Frame_SparseMembers:
+				{
+					const BitPackCodec::MemberFields& member = frame.codec->m_members[frame.index];
+					bool isPresent = m_presentMembers[frame.index];
+					uint8_t* instance = frame.instance;
+					++frame.index;
+					if (isPresent)
+					{
+						m_stack.push_back({ Frame_Fields, m_codec.get(), instance, member.firstField, member.endField, nullptr });
+					}
+					else
+					{
+						m_codec->resetMember(member, instance);
+					}
+				}
+				break;
+
+				case Frame_Sequence:
+				{
+					SequenceSpan span = frame.field->sequence->getSpan(frame.instance);
+					uint8_t* element = static_cast<uint8_t*>(span.at(frame.index));
+					const BitPackCodec* elementCodec = frame.codec;
+					++frame.index;
+					m_stack.push_back({ Frame_Fields, elementCodec, element, 0, elementCodec->m_fields.size(), nullptr });
+				}
+				break;
+			}
+		}
+		return m_status = Status_Done;
+	}
+
+	//-----------------------------------------------------------------------------
+	// Global Functions
+	//-----------------------------------------------------------------------------
+
+	std::shared_ptr<const BitPackCodec> GetBitPackCodec(const Type* _type)
+	{
+		static TypeCache<BitPackCodec> s_codecs;
+		return s_codecs.get(_type);
+	}
+
+} // namespace mirror
+
+#endif
@@ -0,0 +1,457 @@
+#pragma once
+
+//*****************************************************************************
+// mirror blend - interpolation and blending of reflected instances
+//*****************************************************************************
+/*
+Interpolates every float and double member of a reflected type, including the members of
+nested classes, fixed size arrays and std::arrays. The type is compiled once into a plan
+where contiguous floats (and doubles) are merged into runs, which are processed with SSE
+when available.
+
+Other numbers (integers, enums, bools) and pointers snap from the first value to the second
+once t reaches 0.5, and take the value of the heaviest source when blending. Members that
+are not trivially copyable (strings, vectors...) are left untouched in the output.
+Member metadata changes how a member (and all its nested members) is blended:
+- NoBlend: the value of the first source is kept
+- BlendThreshold = 0.3: snapping happens at this t instead of 0.5
+- BlendInteger: integers are interpolated and rounded instead of snapped
+
+	struct State
+	{
+		Vector3 position;
+		float health;
+		int32_t ammo;
+		uint32_t entityID;
+	};
+	MIRROR_CLASS(State)
+	(
+		MIRROR_MEMBER(position);
+		MIRROR_MEMBER(health);
+		MIRROR_MEMBER(ammo, BlendInteger);
+		MIRROR_MEMBER(entityID, NoBlend);
+	);
+
+	mirror::Lerp(mirror::GetType<State>(), &previous, &next, 0.25f, &smoothed);
+
+	const void* sources[3] = { &a, &b, &c };
+	float weights[3] = { 0.5f, 0.3f, 0.2f };
+	mirror::Blend(mirror::GetType<State>(), sources, weights, 3, &blended);
+
+Like mirror.h, the implementation is compiled in the file that defines MIRROR_IMPLEMENTATION.
+*/
+
+#include "mirror.h"
+
+namespace mirror {
+
+	class MIRROR_API BlendPlan
+	{
+	public:
+		BlendPlan(const Type* _type);
+
+		const Type* getType() const { return m_type; }
+		const TypeDependencies& getDependencies() const { return m_dependencies; }
+
+		// _out can be _a or _b
+		void lerp(const void* _a, const void* _b, float _t, void* _out) const;
+		// Weighted sum of the sources, the weights are expected to add up to 1. _out can be one of the sources.
+		void blend(const void* const* _sources, const float* _weights, size_t _count, void* _out) const;
+
+	// internal
+		enum OperationKind
+		{
+			Operation_Floats,
+			Operation_Doubles,
+			Operation_Integer,
+			Operation_Snap,
+			Operation_Keep,
+		};
+
+		struct Operation
+		{
+			OperationKind kind;
+			size_t offset;
+			size_t size; // element count for floats and doubles, bytes otherwise
+			bool isSigned; // integers only
+			float threshold; // snaps only
+		};
+
+		struct Options
+		{
+			bool keep = false;
+			bool interpolateIntegers = false;
+			float threshold = 0.5f;
+		};
+
+		void compile(const Type* _type, size_t _offset, const Options& _options);
+		void addOperation(const Operation& _operation);
+
+		const Type* m_type;
+		std::vector<Operation> m_operations;
+		TypeDependencies m_dependencies;
+	};
+
+	// Use a plan cached per type, see TypeCache
+	MIRROR_API void Lerp(const Type* _type, const void* _a, const void* _b, float _t, void* _out);
+	MIRROR_API void Blend(const Type* _type, const void* const* _sources, const float* _weights, size_t _count, void* _out);
+	MIRROR_API std::shared_ptr<const BlendPlan> GetBlendPlan(const Type* _type);
+
+} // namespace mirror
+
+//*****************************************************************************
+// Implementation
+//*****************************************************************************
+
+#ifdef MIRROR_IMPLEMENTATION
+
+#include <cstring>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIRROR_BLEND_SSE
+#include <emmintrin.h>
+#endif
+
+namespace mirror {
+
+	namespace BlendKernels {
+
+		void LerpFloats(const float* _a, const float* _b, float _t, float* _out, size_t _count)
+		{
+			size_t i = 0;
+#ifdef MIRROR_BLEND_SSE
+			__m128 t = _mm_set1_ps(_t);
+			for (; i + 4 <= _count; i += 4)
+			{
+				__m128 a = _mm_loadu_ps(_a + i);
+				__m128 b = _mm_loadu_ps(_b + i);
+				_mm_storeu_ps(_out + i, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t)));
+			}
+#endif
+			for (; i < _count; ++i)
+			{
+				_out[i] = _a[i] + (_b[i] - _a[i]) * _t;
+			}
+		}
+
+		void LerpDoubles(const double* _a, const double* _b, double _t, double* _out, size_t _count)
+		{
+			size_t i = 0;
+#ifdef MIRROR_BLEND_SSE
+			__m128d t = _mm_set1_pd(_t);
+			for (; i + 2 <= _count; i += 2)
+			{
+				__m128d a = _mm_loadu_pd(_a + i);
+				__m128d b = _mm_loadu_pd(_b + i);
+				_mm_storeu_pd(_out + i, _mm_add_pd(a, _mm_mul_pd(_mm_sub_pd(b, a), t)));
+			}
+#endif
+			for (; i < _count; ++i)
+			{
+				_out[i] = _a[i] + (_b[i] - _a[i]) * _t;
+			}
+		}
+
+		// _out = _accumulator + _source * _weight, the accumulator can be the output
+		void AccumulateFloats(const float* _accumulator, const float* _source, float _weight, float* _out, size_t _count)
+		{
+			size_t i = 0;
+#ifdef MIRROR_BLEND_SSE
+			__m128 weight = _mm_set1_ps(_weight);
+			for (; i + 4 <= _count; i += 4)
+			{
+				__m128 accumulator = _accumulator != nullptr ? _mm_loadu_ps(_accumulator + i) : _mm_setzero_ps();
+				_mm_storeu_ps(_out + i, _mm_add_ps(accumulator, _mm_mul_ps(_mm_loadu_ps(_source + i), weight)));
+			}
+#endif
+			for (; i < _count; ++i)
+			{
+				_out[i] = (_accumulator != nullptr ? _accumulator[i] : 0.0f) + _source[i] * _weight;
+			}
+		}
+
+		void AccumulateDoubles(const double* _accumulator, const double* _source, double _weight, double* _out, size_t _count)
+		{
+			size_t i = 0;
+#ifdef MIRROR_BLEND_SSE
+			__m128d weight = _mm_set1_pd(_weight);
+			for (; i + 2 <= _count; i += 2)
+			{
+				__m128d accumulator = _accumulator != nullptr ? _mm_loadu_pd(_accumulator + i) : _mm_setzero_pd();
+				_mm_storeu_pd(_out + i, _mm_add_pd(accumulator, _mm_mul_pd(_mm_loadu_pd(_source + i), weight)));
+			}
+#endif
+			for (; i < _count; ++i)
+			{
+				_out[i] = (_accumulator != nullptr ? _accumulator[i] : 0.0) + _source[i] * _weight;
+			}
+		}
+
+	} // namespace BlendKernels
+
+	//-----------------------------------------------------------------------------
+	// BlendPlan
+	//-----------------------------------------------------------------------------
+
+	BlendPlan::BlendPlan(const Type* _type)
+		: m_type(_type)
+	{
+		assert(_type != nullptr);
+		compile(_type, 0, Options());
+	}
+
+	void BlendPlan::lerp(const void* _a, const void* _b, float _t, void* _out) const
+	{
+		using namespace BlendKernels;
+
+		const uint8_t* a = static_cast<const uint8_t*>(_a);
+		const uint8_t* b = static_cast<const uint8_t*>(_b);
+		uint8_t* out = static_cast<uint8_t*>(_out);
+		for (const Operation& operation : m_operations)
+		{
+			const uint8_t* valueA = a + operation.offset;
+			const uint8_t* valueB = b + operation.offset;
+			uint8_t* valueOut = out + operation.offset;
+			switch (operation.kind)
+			{
+				case Operation_Floats:
+					LerpFloats(reinterpret_cast<const float*>(valueA), reinterpret_cast<const float*>(valueB), _t, reinterpret_cast<float*>(valueOut), operation.size);
+					break;
+
+				case Operation_Doubles:
+					LerpDoubles(reinterpret_cast<const double*>(valueA), reinterpret_cast<const double*>(valueB), double(_t), reinterpret_cast<double*>(valueOut), operation.size);
+					break;
+
+				case Operation_Integer:
+				{
+					int64_t integerA = ReadInteger(valueA, operation.size, operation.isSigned);
+					int64_t integerB = ReadInteger(valueB, operation.size, operation.isSigned);
+					WriteInteger(valueOut, operation.size, integerA + int64_t(std::llround(double(integerB - integerA) * _t)));
+				}
+				break;
+
+				case Operation_Snap:
+					memmove(valueOut, _t < operation.threshold ? valueA : valueB, operation.size);
+					break;
+
+				case Operation_Keep:
+					memmove(valueOut, valueA, operation.size);
+					break;
+			}
+		}
+	}
+
+	void BlendPlan::blend(const void* const* _sources, const float* _weights, size_t _count, void* _out) const
+	{
+		using namespace BlendKernels;
+		assert(_count > 0);
+
+		size_t heaviest = 0;
+		for (size_t i = 1; i < _count; ++i)
+		{
+			heaviest = _weights[i] > _weights[heaviest] ? i : heaviest;
+		}
+
+		// The output can be one of the sources: snapped values are copied first, and accumulation goes to a local buffer
+		uint8_t* out = static_cast<uint8_t*>(_out);
+		std::vector<uint8_t> accumulation;
+		for (const Operation& operation : m_operations)
+		{
+			uint8_t* valueOut = out + operation.offset;
+			switch (operation.kind)
+			{
+				case Operation_Floats:
+				case Operation_Doubles:
+				{
+					size_t elementSize = operation.kind == Operation_Floats ? sizeof(float) : sizeof(double);
+					accumulation.resize(operation.size * elementSize);
+					for (size_t i = 0; i < _count; ++i)
+					{
+						const uint8_t* source = static_cast<const uint8_t*>(_sources[i]) + operation.offset;
+						if (operation.kind == Operation_Floats)
+						{
+							float* accumulator = reinterpret_cast<float*>(accumulation.data());
+							AccumulateFloats(i > 0 ? accumulator : nullptr, reinterpret_cast<const float*>(source), _weights[i], accumulator, operation.size);
+						}
+						else
+						{
+							double* accumulator = reinterpret_cast<double*>(accumulation.data());
+							AccumulateDoubles(i > 0 ? accumulator : nullptr, reinterpret_cast<const double*>(source), double(_weights[i]), accumulator, operation.size);
+						}
+					}
+					memcpy(valueOut, accumulation.data(), accumulation.size());
+				}
+				break;
+
+				case Operation_Integer:
+				{
+					double sum = 0.0;
+					for (size_t i = 0; i < _count; ++i)
+					{
+						const uint8_t* source = static_cast<const uint8_t*>(_sources[i]) + operation.offset;
+						sum += double(ReadInteger(source, operation.size, operation.isSigned)) * _weights[i];
+					}
+					WriteInteger(valueOut, operation.size, int64_t(std::llround(sum)));
+				}
+				break;
+
+				case Operation_Snap:
+					memmove(valueOut, static_cast<const uint8_t*>(_sources[heaviest]) + operation.offset, operation.size);
+					break;
+
+				case Operation_Keep:
+					memmove(valueOut, static_cast<const uint8_t*>(_sources[0]) + operation.offset, operation.size);
+					break;
+			}
+		}
+	}
+
+	void BlendPlan::compile(const Type* _type, size_t _offset, const Options& _options)
+	{
+		if (_type == nullptr)
+			return;
+
+		m_dependencies.add(_type);
+
+		TypeInfo typeInfo = _type->getTypeInfo();
+		switch (typeInfo)
+		{
+			case TypeInfo_float:
+			case TypeInfo_double:
+			{
+				if (_options.keep)
+				{
+					addOperation({ Operation_Keep, _offset, _type->getSize(), false, 0.0f });
+				}
+				else
+				{
+					addOperation({ typeInfo == TypeInfo_float ? Operation_Floats : Operation_Doubles, _offset, 1, false, 0.0f });
+				}
+			}
+			break;
+
+			case TypeInfo_char:
+			case TypeInfo_int8:
+			case TypeInfo_int16:
+			case TypeInfo_int32:
+			case TypeInfo_int64:
+			case TypeInfo_uint8:
+			case TypeInfo_uint16:
+			case TypeInfo_uint32:
+			case TypeInfo_uint64:
+			{
+				if (_options.keep)
+				{
+					addOperation({ Operation_Keep, _offset, _type->getSize(), false, 0.0f });
+				}
+				else if (_options.interpolateIntegers)
+				{
+					bool isSigned = typeInfo == TypeInfo_int8 || typeInfo == TypeInfo_int16 || typeInfo == TypeInfo_int32 || typeInfo == TypeInfo_int64
+						|| (typeInfo == TypeInfo_char && std::is_signed<char>::value);
+					addOperation({ Operation_Integer, _offset, _type->getSize(), isSigned, 0.0f });
+				}
+				else
+				{
+					addOperation({ Operation_Snap, _offset, _type->getSize(), false, _options.threshold });
+				}
+			}
+			break;
+
+			case TypeInfo_bool:
+			case TypeInfo_Enum:
+			case TypeInfo_Pointer:
+				addOperation({ _options.keep ? Operation_Keep : Operation_Snap, _offset, _type->getSize(), false, _options.threshold });
+				break;
+
+			case TypeInfo_Class:
+			{
+				for (ClassMember* member : _type->asClass()->getMembers())
+				{
+					const MetaDataSet& metaDataSet = member->getMetaDataSet();
+					Options options = _options;
+					options.keep = options.keep || metaDataSet.findMetaData("NoBlend") != nullptr;
+					options.interpolateIntegers = options.interpolateIntegers || metaDataSet.findMetaData("BlendInteger") != nullptr;
+					if (const MetaData* threshold = metaDataSet.findMetaData("BlendThreshold"))
+					{
+						options.threshold = threshold->asFloat();
+					}
+					compile(member->getType(), _offset + member->getOffset(), options);
+				}
+			}
+			break;
+
+			case TypeInfo_FixedSizeArray:
+			{
+				const FixedSizeArray* fixedSizeArray = _type->asFixedSizeArray();
+				const Type* subType = fixedSizeArray->getSubType();
+				for (size_t i = 0; subType != nullptr && i < fixedSizeArray->getElementCount(); ++i)
+				{
+					compile(subType, _offset + i * subType->getSize(), _options);
+				}
+			}
+			break;
+
+			case TypeInfo_Sequence:
+			{
+				// Only fixed size sequences (std::array) store their elements inline
+				const Sequence* sequence = _type->asSequence();
+				for (size_t i = 0; sequence->isFixedSize() && i < sequence->getFixedCount(); ++i)
+				{
+					compile(sequence->getSubType(), _offset + i * sequence->getElementStride(), _options);
+				}
+			}
+			break;
+
+			default:
+				break;
+		}
+	}
+
+	void BlendPlan::addOperation(const Operation& _operation)
+	{
+		if (!m_operations.empty())
+		{
+			// Contiguous operations of the same kind are merged into runs
+			Operation& last = m_operations.back();
+			if (last.kind == _operation.kind && last.threshold == _operation.threshold)
+			{
+				if ((last.kind == Operation_Floats && last.offset + last.size * sizeof(float) == _operation.offset)
+					|| (last.kind == Operation_Doubles && last.offset + last.size * sizeof(double) == _operation.offset))
+				{
+					last.size += _operation.size;
+					return;
+				}
+				if ((last.kind == Operation_Snap || last.kind == Operation_Keep) && last.offset + last.size == _operation.offset)
+				{
+					last.size += _operation.size;
+					return;
+				}
+			}
+		}
+		m_operations.push_back(_operation);
+	}
+
+	//-----------------------------------------------------------------------------
+	// Global Functions
+	//-----------------------------------------------------------------------------
+
+	std::shared_ptr<const BlendPlan> GetBlendPlan(const Type* _type)
+	{
+		static TypeCache<BlendPlan> s_plans;
+		return s_plans.get(_type);
+	}
+
+	void Lerp(const Type* _type, const void* _a, const void* _b, float _t, void* _out)
+	{
+		GetBlendPlan(_type)->lerp(_a, _b, _t, _out);
+	}
+
+	void Blend(const Type* _type, const void* const* _sources, const float* _weights, size_t _count, void* _out)
+	{
+		GetBlendPlan(_type)->blend(_sources, _weights, _count, _out);
+	}
+
+} // namespace mirror
+
+#endif
@@ -0,0 +1,441 @@
+#pragma once
+
+//*****************************************************************************
+// mirror census - memory accounting per reflected type
+//*****************************************************************************
+/*
+Walks the object graph reachable from a set of root instances through reflected
+members (classes, fixed size arrays, sequences, associative containers, optionals,
+pointers and custom types) and reports the
+number of instances and bytes reached for each type.
+
+Every distinct address reached through a pointer is considered to be an allocation.
+An allocation reached by more than one reference is reported as shared, otherwise
+it is reported as owned. Each allocation is only walked once, so cycles are fine.
+Allocations of polymorphic classes declaring MIRROR_GETCLASS_VIRTUAL() are accounted
+for with their dynamic class.
+
+Custom types (containers, smart pointers...) are opaque to mirror, you have to give
+the census a visitor for them:
+
+	void VisitArray(mirror::HeapCensus& _census, const mirror::Type* _type, void* _instance, void* _userData)
+	{
+		const ArrayType* arrayType = (const ArrayType*)_type;
+		_census.visitAllocation(arrayType->getSubType(), arrayType->getData(_instance), arrayType->getSize(_instance));
+	}
+
+	mirror::HeapCensus census;
+	census.setCustomTypeVisitor("Array", &VisitArray);
+	census.addRoot(&world);
+	census.run();
+	census.printReport(stdout);
+
+Like mirror.h, the implementation is compiled in the file that defines MIRROR_IMPLEMENTATION.
+*/
+
+#include "mirror.h"
+
+#include <cstdio>
+
+namespace mirror {
+
+	struct CensusEntry
+	{
+		const Type* type = nullptr;
+		size_t instanceCount = 0;
+		size_t bytes = 0;
+		size_t sharedInstanceCount = 0; // instances that are referenced more than once
+		size_t sharedBytes = 0;
+	};
+
+	class MIRROR_API HeapCensus
+	{
+	public:
+		typedef void (*CustomTypeVisitor)(HeapCensus& _census, const Type* _type, void* _instance, void* _userData);
+
+		void addRoot(const Type* _type, void* _instance);
+		template <typename T> void addRoot(T* _instance) { addRoot(GetType<T>(), _instance); }
+
+		void setCustomTypeVisitor(const char* _customTypeName, CustomTypeVisitor _visitor, void* _userData = nullptr);
+
+		// Walks the graph from the roots and fills the entries. Can be called again after the graph changed.
+		void run();
+		void clear();
+
+		// Sorted by decreasing bytes, then by type name
+		const std::vector<CensusEntry>& getEntries() const;
+		const CensusEntry* findEntry(const Type* _type) const;
+		size_t getTotalBytes() const;
+		size_t getTotalInstanceCount() const;
+
+		void printReport(FILE* _file) const;
+
+		// To be called from custom type visitors
+		void visitValue(const Type* _type, void* _instance); // a value embedded in the instance being visited
+		void visitAllocation(const Type* _type, void* _data, size_t _count = 1); // a memory block owned or referenced by the instance being visited
+
+	// internal
+		struct Allocation
+		{
+			const Type* type;
+			size_t count;
+			size_t referenceCount;
+		};
+
+		struct PendingAllocation
+		{
+			const Type* type;
+			void* data;
+			size_t count;
+		};
+
+		// A block is identified by its address and type: a class and its first member share their address
+		struct AllocationHash
+		{
+			size_t operator()(const std::pair<const void*, const Type*>& _key) const
+			{
+				uintptr_t address = reinterpret_cast<uintptr_t>(_key.first);
+				return size_t(address ^ (address >> 17) ^ (reinterpret_cast<uintptr_t>(_key.second) * 31));
+			}
+		};
+
+		struct CustomVisitor
+		{
+			CustomTypeVisitor visitor;
+			void* userData;
+		};
+
+		bool mayReference(const Type* _type);
+
+		std::vector<PendingAllocation> m_roots;
+		std::vector<PendingAllocation> m_pending;
+		std::unordered_map<std::pair<const void*, const Type*>, Allocation, AllocationHash> m_allocations;
+		std::unordered_map<uint32_t, CustomVisitor> m_customVisitors;
+		std::unordered_map<const Type*, bool> m_mayReference;
+		std::vector<CensusEntry> m_entries;
+		size_t m_totalBytes = 0;
+		size_t m_totalInstanceCount = 0;
+	};
+
+} // namespace mirror
+
+//*****************************************************************************
+// Implementation
+//*****************************************************************************
+
+#ifdef MIRROR_IMPLEMENTATION
+
+#include <cstring>
+#include <algorithm>
+
+namespace mirror {
+
+	void HeapCensus::addRoot(const Type* _type, void* _instance)
+	{
+		assert(_type != nullptr);
+		if (_instance == nullptr)
+			return;
+
+		m_roots.push_back({ _type, _instance, 1 });
+	}
+
+	void HeapCensus::setCustomTypeVisitor(const char* _customTypeName, CustomTypeVisitor _visitor, void* _userData)
+	{
+		assert(_customTypeName != nullptr);
+		m_customVisitors[HashCString(_customTypeName)] = { _visitor, _userData };
+		m_mayReference.clear();
+	}
+
+	void HeapCensus::run()
+	{
+		m_allocations.clear();
+		m_pending.clear();
+		m_entries.clear();
+		m_totalBytes = 0;
+		m_totalInstanceCount = 0;
+
+		for (const PendingAllocation& root : m_roots)
+		{
+			visitAllocation(GetDynamicType(root.type, root.data), root.data, root.count);
+		}
+
+		// Explicit stack instead of recursion, object graphs can be very deep (e.g. linked lists)
+		while (!m_pending.empty())
+		{
+			PendingAllocation allocation = m_pending.back();
+			m_pending.pop_back();
+
+			size_t elementSize = allocation.type->getSize();
+			for (size_t i = 0; i < allocation.count; ++i)
+			{
+				visitValue(allocation.type, reinterpret_cast<uint8_t*>(allocation.data) + i * elementSize);
+			}
+		}
+
+		std::unordered_map<const Type*, size_t> entryIndices;
+		for (auto& pair : m_allocations)
+		{
+			const Allocation& allocation = pair.second;
+			auto result = entryIndices.insert(std::make_pair(allocation.type, m_entries.size()));
+			if (result.second)
+			{
+				m_entries.push_back(CensusEntry());
+				m_entries.back().type = allocation.type;
+			}
+
+			CensusEntry& entry = m_entries[result.first->second];
+			size_t bytes = allocation.count * allocation.type->getSize();
+			entry.instanceCount += allocation.count;
+			entry.bytes += bytes;
+			if (allocation.referenceCount > 1)
+			{
+				entry.sharedInstanceCount += allocation.count;
+				entry.sharedBytes += bytes;
+			}
+			m_totalBytes += bytes;
+			m_totalInstanceCount += allocation.count;
+		}
+
+		// Ties are sorted by name, the allocation map has no stable order
+		std::sort(m_entries.begin(), m_entries.end(), [](const CensusEntry& _a, const CensusEntry& _b)
+		{
+			if (_a.bytes != _b.bytes)
+				return _a.bytes > _b.bytes;
+			return strcmp(_a.type->getName(), _b.type->getName()) < 0;
+		});
+	}
+
+	void HeapCensus::clear()
+	{
+		m_roots.clear();
+		m_pending.clear();
+		m_allocations.clear();
+		m_entries.clear();
+		m_totalBytes = 0;
+		m_totalInstanceCount = 0;
+	}
+
+	const std::vector<CensusEntry>& HeapCensus::getEntries() const
+	{
+		return m_entries;
+	}
+
+	const CensusEntry* HeapCensus::findEntry(const Type* _type) const
+	{
+		for (const CensusEntry& entry : m_entries)
+		{
+			if (entry.type == _type)
+				return &entry;
+		}
+		return nullptr;
+	}
+
+	size_t HeapCensus::getTotalBytes() const
+	{
+		return m_totalBytes;
+	}
+
+	size_t HeapCensus::getTotalInstanceCount() const
+	{
+		return m_totalInstanceCount;
+	}
+
+	void HeapCensus::printReport(FILE* _file) const
+	{
+		fprintf(_file, "%-40s %12s %14s %12s %14s\n", "type", "instances", "bytes", "shared", "shared bytes");
+		for (const CensusEntry& entry : m_entries)
+		{
+			fprintf(_file, "%-40s %12zu %14zu %12zu %14zu\n", entry.type->getName(), entry.instanceCount, entry.bytes, entry.sharedInstanceCount, entry.sharedBytes);
+		}
+		fprintf(_file, "%-40s %12zu %14zu\n", "total", m_totalInstanceCount, m_totalBytes);
+	}
+
+	void HeapCensus::visitValue(const Type* _type, void* _instance)
+	{
+		if (_type == nullptr || _instance == nullptr || !mayReference(_type))
+			return;
+
+		switch (_type->getTypeInfo())
+		{
+			case TypeInfo_Class:
+			{
+				const Class* clss = _type->asClass();
+				for (ClassMember* member : clss->getMembers())
+				{
+					visitValue(member->getType(), member->getInstanceMemberPointer(_instance));
+				}
+			}
+			break;
+
+			case TypeInfo_FixedSizeArray:
+			{
+				const FixedSizeArray* fixedSizeArray = _type->asFixedSizeArray();
+				for (size_t i = 0; i < fixedSizeArray->getElementCount(); ++i)
+				{
+					visitValue(fixedSizeArray->getSubType(), fixedSizeArray->getDataAt(_instance, i));
+				}
+			}
+			break;
+
+			case TypeInfo_Pointer:
+			{
+				void* pointee = *reinterpret_cast<void**>(_instance);
+				visitAllocation(GetDynamicType(_type->asPointer()->getSubType(), pointee), pointee, 1);
+			}
+			break;
+
+			case TypeInfo_Sequence:
+			{
+				const Sequence* sequence = _type->asSequence();
+				SequenceSpan span = sequence->getSpan(_instance);
+				if (sequence->isFixedSize())
+				{
+					for (size_t i = 0; i < span.count; ++i)
+					{
+						visitValue(sequence->getSubType(), span.at(i));
+					}
+				}
+				else
+				{
+					// Only the used part of the buffer is accounted for, capacity is not exposed
+					visitAllocation(sequence->getSubType(), span.data, span.count);
+				}
+			}
+			break;
+
+			case TypeInfo_Associative:
+			{
+				// Entries are accounted for as individual allocations, node overhead is not exposed
+				const Associative* associative = _type->asAssociative();
+				const Type* keyType = associative->getKeyType();
+				const Type* valueType = associative->getValueType();
+				AssociativeCursor cursor(associative, _instance);
+				const void* keys[64];
+				void* values[64];
+				while (size_t count = cursor.read(keys, values, 64))
+				{
+					for (size_t i = 0; i < count; ++i)
+					{
+						visitAllocation(keyType, const_cast<void*>(keys[i]), 1);
+						visitAllocation(valueType, values[i], 1);
+					}
+				}
+			}
+			break;
+
+			case TypeInfo_Optional:
+			{
+				const Optional* optional = _type->asOptional();
+				if (optional->hasValue(_instance))
+				{
+					visitValue(optional->getSubType(), optional->getValue(_instance));
+				}
+			}
+			break;
+
+			case TypeInfo_Custom:
+			{
+				if (_type->getCustomTypeName() == nullptr)
+					break;
+
+				auto it = m_customVisitors.find(HashCString(_type->getCustomTypeName()));
+				if (it != m_customVisitors.end())
+				{
+					it->second.visitor(*this, _type, _instance, it->second.userData);
+				}
+			}
+			break;
+
+			default:
+				break;
+		}
+	}
+
+	void HeapCensus::visitAllocation(const Type* _type, void* _data, size_t _count)
+	{
+		if (_type == nullptr || _data == nullptr || _count == 0)
+			return;
+
+		// void and function pointees have no size, we can't account for them
+		if (_type->getSize() == 0)
+			return;
+
+		auto result = m_allocations.insert(std::make_pair(std::make_pair(static_cast<const void*>(_data), _type), Allocation{ _type, _count, 0 }));
+		++result.first->second.referenceCount;
+		if (result.second)
+		{
+			m_pending.push_back({ _type, _data, _count });
+		}
+	}
+
+	bool HeapCensus::mayReference(const Type* _type)
+	{
+		auto it = m_mayReference.find(_type);
+		if (it != m_mayReference.end())
+			return it->second;
+
+		// Break recursion on self referencing classes, they will be answered by their pointer members anyway
+		m_mayReference[_type] = true;
+
+		bool result = false;
+		switch (_type->getTypeInfo())
+		{
+			case TypeInfo_Class:
+			{
+				for (ClassMember* member : _type->asClass()->getMembers())
+				{
+					Type* memberType = member->getType();
+					if (memberType != nullptr && mayReference(memberType))
+					{
+						result = true;
+						break;
+					}
+				}
+			}
+			break;
+
+			case TypeInfo_FixedSizeArray:
+			{
+				Type* subType = _type->asFixedSizeArray()->getSubType();
+				result = subType != nullptr && mayReference(subType);
+			}
+			break;
+
+			case TypeInfo_Pointer:
+				result = true;
+				break;
+
+			case TypeInfo_Sequence:
+			{
+				const Sequence* sequence = _type->asSequence();
+				Type* subType = sequence->getSubType();
+				result = !sequence->isFixedSize() || (subType != nullptr && mayReference(subType));
+			}
+			break;
+
+			case TypeInfo_Associative:
+				result = true;
+				break;
+
+			case TypeInfo_Optional:
+			{
+				Type* subType = _type->asOptional()->getSubType();
+				result = subType != nullptr && mayReference(subType);
+			}
+			break;
+
+			case TypeInfo_Custom:
+				result = _type->getCustomTypeName() != nullptr && m_customVisitors.find(HashCString(_type->getCustomTypeName())) != m_customVisitors.end();
+				break;
+
+			default:
+				break;
+		}
+
+		m_mayReference[_type] = result;
+		return result;
+	}
+
+} // namespace mirror
+
+#endif
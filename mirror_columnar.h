@@ -0,0 +1,736 @@
+#pragma once
+
+//*****************************************************************************
+// mirror columnar - columnar export and import of reflected instances
+//*****************************************************************************
+/*
+Exports an array of instances of a reflected class into columns, in the spirit of Apache
+Arrow: every member is flattened into primitive columns named after their path
+("position.x", "scores[2]"), each column being a contiguous buffer of values with a
+validity bitmap. Supported members are:
+- numbers, stored with their own type, and bools, stored as bits
+- enums, stored as int32 indices into a dictionary of the enum value names
+- std::strings, stored as int32 offsets into a buffer of characters
+- std::optionals and pointers of the above, which are null (invalid) when empty
+- nested classes, fixed size arrays and std::arrays of the above, which are flattened
+Other members are skipped.
+
+All columns are written to a single buffer, which is also the on-disk layout: a header,
+the column descriptions, then every buffer aligned on 64 bytes. It is meant to be written
+to a file as is and memory mapped later: ColumnarView reads it in place, without copying.
+Values are stored in the byte order of the machine.
+
+	std::vector<uint8_t> buffer;
+	mirror::ExportColumns(mirror::GetClass<Telemetry>(), samples.data(), samples.size(), buffer);
+	fwrite(buffer.data(), 1, buffer.size(), file);
+
+	mirror::ColumnarView view;
+	if (view.open(mappedData, mappedSize))
+	{
+		const mirror::ColumnView* column = view.findColumn("position.x");
+		const float* values = column->getValues<float>();
+
+		std::vector<Telemetry> samples(view.getRowCount());
+		mirror::ImportColumns(mirror::GetClass<Telemetry>(), view, samples.data());
+	}
+
+Like mirror.h, the implementation is compiled in the file that defines MIRROR_IMPLEMENTATION.
+*/
+
+#include "mirror.h"
+
+namespace mirror {
+
+	enum ColumnType : uint32_t
+	{
+		ColumnType_Bool, // bits
+		ColumnType_Int8,
+		ColumnType_Int16,
+		ColumnType_Int32,
+		ColumnType_Int64,
+		ColumnType_UInt8,
+		ColumnType_UInt16,
+		ColumnType_UInt32,
+		ColumnType_UInt64,
+		ColumnType_Float32,
+		ColumnType_Float64,
+		ColumnType_Utf8, // int32 offsets (row count + 1) into bytes
+		ColumnType_Dictionary, // int32 indices into a utf8 dictionary
+
+		ColumnType_Count
+	};
+
+	struct MIRROR_API ColumnView
+	{
+		const char* name;
+		ColumnType type;
+		size_t rowCount;
+		size_t nullCount;
+
+		const uint8_t* validity; // a bit per row, least significant first
+		const void* values;
+		const char* bytes; // utf8 only
+		const int32_t* dictionaryOffsets; // dictionary only, dictionaryCount + 1 offsets into dictionaryBytes
+		const char* dictionaryBytes;
+		size_t dictionaryCount;
+
+		bool isValid(size_t _row) const { return (validity[_row >> 3] >> (_row & 7)) & 1; }
+		template <typename T> const T* getValues() const { return static_cast<const T*>(values); }
+		bool getBool(size_t _row) const { return (static_cast<const uint8_t*>(values)[_row >> 3] >> (_row & 7)) & 1; }
+	};
+
+	class MIRROR_API ColumnarView
+	{
+	public:
+		// Returns false if the data is not a valid columnar buffer. The data must outlive the view
+		// and be aligned on 8 bytes at least.
+		bool open(const void* _data, size_t _size);
+
+		size_t getRowCount() const { return m_rowCount; }
+		size_t getColumnCount() const { return m_columns.size(); }
+		const ColumnView& getColumn(size_t _index) const { return m_columns[_index]; }
+		const ColumnView* findColumn(const char* _name) const;
+
+	// internal
+		size_t m_rowCount = 0;
+		std::vector<ColumnView> m_columns;
+	};
+
+	// Exports _count instances spaced by _stride bytes (defaults to the class size)
+	MIRROR_API void ExportColumns(const Class* _class, const void* _instances, size_t _count, std::vector<uint8_t>& _outBuffer, size_t _stride = 0);
+
+	// Imports the columns matching the members of _class by name and type into getRowCount()
+	// constructed instances. Returns the number of imported columns.
+	MIRROR_API size_t ImportColumns(const Class* _class, const ColumnarView& _view, void* _instances, size_t _stride = 0);
+
+	// internal
+	namespace Columnar {
+
+		enum BufferKind
+		{
+			Buffer_Validity,
+			Buffer_Values,
+			Buffer_Bytes,
+			Buffer_DictionaryOffsets,
+			Buffer_DictionaryBytes,
+
+			Buffer_Count
+		};
+
+		struct BufferRange
+		{
+			uint64_t offset;
+			uint64_t size;
+		};
+
+		struct FileHeader
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t columnCount;
+			uint64_t rowCount;
+			uint64_t size;
+		};
+
+		struct ColumnHeader
+		{
+			uint64_t nameOffset; // null terminated
+			uint32_t type;
+			uint32_t reserved;
+			uint64_t nullCount;
+			uint64_t dictionaryCount;
+			BufferRange buffers[Buffer_Count];
+		};
+
+		enum Indirection
+		{
+			Indirection_None,
+			Indirection_Optional,
+			Indirection_Pointer,
+		};
+
+		struct Leaf
+		{
+			std::string name;
+			ColumnType type;
+			size_t offset;
+			size_t size;
+			Indirection indirection;
+			const Optional* optional;
+			const Sequence* string;
+			const Enum* enm;
+			std::vector<int64_t> enumValues; // sign extended from size bytes
+		};
+
+		void CollectLeaves(const Type* _type, const std::string& _name, size_t _offset, std::vector<Leaf>& _outLeaves);
+
+	} // namespace Columnar
+
+} // namespace mirror
+
+//*****************************************************************************
+// Implementation
+//*****************************************************************************
+
+#ifdef MIRROR_IMPLEMENTATION
+
+#include <cstring>
+#include <algorithm>
+
+namespace mirror {
+
+	namespace Columnar {
+
+		static const char s_magic[8] = { 'M', 'I', 'R', 'R', 'C', 'O', 'L', 0 };
+		static const uint32_t s_version = 1;
+		static const size_t s_alignment = 64;
+
+		static bool GetColumnType(TypeInfo _typeInfo, ColumnType& _outType)
+		{
+			switch (_typeInfo)
+			{
+				case TypeInfo_bool: _outType = ColumnType_Bool; return true;
+				case TypeInfo_char: _outType = ColumnType_Int8; return true;
+				case TypeInfo_int8: _outType = ColumnType_Int8; return true;
+				case TypeInfo_int16: _outType = ColumnType_Int16; return true;
+				case TypeInfo_int32: _outType = ColumnType_Int32; return true;
+				case TypeInfo_int64: _outType = ColumnType_Int64; return true;
+				case TypeInfo_uint8: _outType = ColumnType_UInt8; return true;
+				case TypeInfo_uint16: _outType = ColumnType_UInt16; return true;
+				case TypeInfo_uint32: _outType = ColumnType_UInt32; return true;
+				case TypeInfo_uint64: _outType = ColumnType_UInt64; return true;
+				case TypeInfo_float: _outType = ColumnType_Float32; return true;
+				case TypeInfo_double: _outType = ColumnType_Float64; return true;
+				default: return false;
+			}
+		}
+
+		// Fills the leaf type from a value type, returns false if it can't be a column
+		static bool SetLeafType(const Type* _type, Leaf& _leaf)
+		{
+			if (_type == nullptr)
+				return false;
+
+			_leaf.size = _type->getSize();
+			if (GetColumnType(_type->getTypeInfo(), _leaf.type))
+				return true;
+
+			if (const Enum* enm = _type->asEnum())
+			{
+				_leaf.type = ColumnType_Dictionary;
+				_leaf.enm = enm;
+				for (const EnumValue* value : enm->getValues())
+				{
+					_leaf.enumValues.push_back(TruncateInteger(value->getValue(), _leaf.size));
+				}
+				return true;
+			}
+
+			if (const Sequence* sequence = _type->asSequence())
+			{
+				const Type* subType = sequence->getSubType();
+				if (!sequence->isFixedSize() && subType != nullptr && subType->getTypeInfo() == TypeInfo_char && sequence->getElementStride() == 1)
+				{
+					_leaf.type = ColumnType_Utf8;
+					_leaf.string = sequence;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void CollectLeaves(const Type* _type, const std::string& _name, size_t _offset, std::vector<Leaf>& _outLeaves)
+		{
+			if (_type == nullptr)
+				return;
+
+			Leaf leaf = {};
+			leaf.name = _name;
+			leaf.offset = _offset;
+			if (SetLeafType(_type, leaf))
+			{
+				_outLeaves.push_back(leaf);
+				return;
+			}
+
+			switch (_type->getTypeInfo())
+			{
+				case TypeInfo_Class:
+				{
+					for (ClassMember* member : _type->asClass()->getMembers())
+					{
+						CollectLeaves(member->getType(), _name.empty() ? member->getName() : _name + "." + member->getName(), _offset + member->getOffset(), _outLeaves);
+					}
+				}
+				break;
+
+				case TypeInfo_FixedSizeArray:
+				{
+					const FixedSizeArray* fixedSizeArray = _type->asFixedSizeArray();
+					const Type* subType = fixedSizeArray->getSubType();
+					for (size_t i = 0; subType != nullptr && i < fixedSizeArray->getElementCount(); ++i)
+					{
+						CollectLeaves(subType, _name + "[" + std::to_string(i) + "]", _offset + i * subType->getSize(), _outLeaves);
+					}
+				}
+				break;
+
+				case TypeInfo_Sequence:
+				{
+					const Sequence* sequence = _type->asSequence();
+					for (size_t i = 0; sequence->isFixedSize() && i < sequence->getFixedCount(); ++i)
+					{
+						CollectLeaves(sequence->getSubType(), _name + "[" + std::to_string(i) + "]", _offset + i * sequence->getElementStride(), _outLeaves);
+					}
+				}
+				break;
+
+				// Nullable values, only when they hold a column directly
+				case TypeInfo_Optional:
+				{
+					leaf.indirection = Indirection_Optional;
+					leaf.optional = _type->asOptional();
+					if (SetLeafType(leaf.optional->getSubType(), leaf))
+					{
+						_outLeaves.push_back(leaf);
+					}
+				}
+				break;
+
+				case TypeInfo_Pointer:
+				{
+					leaf.indirection = Indirection_Pointer;
+					if (SetLeafType(_type->asPointer()->getSubType(), leaf))
+					{
+						_outLeaves.push_back(leaf);
+					}
+				}
+				break;
+
+				default:
+					break;
+			}
+		}
+
+		// Returns the value of a leaf in an instance, null if there is none
+		static const uint8_t* GetValue(const Leaf& _leaf, const uint8_t* _instance)
+		{
+			const uint8_t* data = _instance + _leaf.offset;
+			switch (_leaf.indirection)
+			{
+				case Indirection_None: return data;
+				case Indirection_Optional: return _leaf.optional->hasValue(data) ? static_cast<const uint8_t*>(_leaf.optional->getValue(const_cast<uint8_t*>(data))) : nullptr;
+				case Indirection_Pointer: return *reinterpret_cast<uint8_t* const*>(data);
+			}
+			return nullptr;
+		}
+
+		class Writer
+		{
+		public:
+			Writer(std::vector<uint8_t>& _buffer) : m_buffer(_buffer) {}
+
+			BufferRange append(const void* _data, size_t _size)
+			{
+				BufferRange range = reserve(_size);
+				if (_size > 0)
+				{
+					memcpy(m_buffer.data() + range.offset, _data, _size);
+				}
+				return range;
+			}
+
+			// Zero initialized, aligned on s_alignment
+			BufferRange reserve(size_t _size)
+			{
+				size_t offset = (m_buffer.size() + s_alignment - 1) & ~(s_alignment - 1);
+				m_buffer.resize(offset + _size, 0);
+				return { offset, _size };
+			}
+
+			uint8_t* at(const BufferRange& _range) { return m_buffer.data() + _range.offset; }
+
+			std::vector<uint8_t>& m_buffer;
+		};
+
+	} // namespace Columnar
+
+	//-----------------------------------------------------------------------------
+	// ColumnarView
+	//-----------------------------------------------------------------------------
+
+	bool ColumnarView::open(const void* _data, size_t _size)
+	{
+		using namespace Columnar;
+
+		m_rowCount = 0;
+		m_columns.clear();
+
+		const uint8_t* data = static_cast<const uint8_t*>(_data);
+		if (_size < sizeof(FileHeader) || (reinterpret_cast<uintptr_t>(data) & 7) != 0)
+			return false;
+
+		FileHeader header;
+		memcpy(&header, data, sizeof(header));
+		if (memcmp(header.magic, s_magic, sizeof(s_magic)) != 0 || header.version != s_version || header.size > _size)
+			return false;
+		if (header.columnCount > (_size - sizeof(FileHeader)) / sizeof(ColumnHeader))
+			return false;
+
+		size_t rowCount = size_t(header.rowCount);
+		size_t bitmapSize = (rowCount + 7) / 8;
+		auto isInBounds = [&](const BufferRange& _range, size_t _expectedSize)
+		{
+			return _range.offset <= _size && _range.size <= _size - _range.offset && _range.size >= _expectedSize && (_range.offset & 7) == 0;
+		};
+
+		std::vector<ColumnView> columns(header.columnCount);
+		for (size_t i = 0; i < columns.size(); ++i)
+		{
+			ColumnHeader columnHeader;
+			memcpy(&columnHeader, data + sizeof(FileHeader) + i * sizeof(ColumnHeader), sizeof(columnHeader));
+			if (columnHeader.type >= ColumnType_Count || columnHeader.nameOffset >= _size || memchr(data + columnHeader.nameOffset, 0, _size - size_t(columnHeader.nameOffset)) == nullptr)
+				return false;
+
+			ColumnType type = ColumnType(columnHeader.type);
+			const BufferRange* buffers = columnHeader.buffers;
+			size_t valueSize = 0;
+			switch (type)
+			{
+				case ColumnType_Int8: case ColumnType_UInt8: valueSize = rowCount; break;
+				case ColumnType_Int16: case ColumnType_UInt16: valueSize = rowCount * 2; break;
+				case ColumnType_Int32: case ColumnType_UInt32: case ColumnType_Float32: case ColumnType_Dictionary: valueSize = rowCount * 4; break;
+				case ColumnType_Int64: case ColumnType_UInt64: case ColumnType_Float64: valueSize = rowCount * 8; break;
+				case ColumnType_Bool: valueSize = bitmapSize; break;
+				case ColumnType_Utf8: valueSize = (rowCount + 1) * 4; break;
+				default: break;
+			}
+			if (!isInBounds(buffers[Buffer_Validity], bitmapSize) || !isInBounds(buffers[Buffer_Values], valueSize))
+				return false;
+
+			ColumnView& column = columns[i];
+			column = {};
+			column.name = reinterpret_cast<const char*>(data + columnHeader.nameOffset);
+			column.type = type;
+			column.rowCount = rowCount;
+			column.nullCount = size_t(columnHeader.nullCount);
+			column.validity = data + buffers[Buffer_Validity].offset;
+			column.values = data + buffers[Buffer_Values].offset;
+
+			if (type == ColumnType_Utf8)
+			{
+				if (!isInBounds(buffers[Buffer_Bytes], 0))
+					return false;
+
+				column.bytes = reinterpret_cast<const char*>(data + buffers[Buffer_Bytes].offset);
+				const int32_t* offsets = column.getValues<int32_t>();
+				for (size_t row = 0; row < rowCount; ++row)
+				{
+					if (offsets[row] < 0 || offsets[row] > offsets[row + 1] || uint64_t(offsets[row + 1]) > buffers[Buffer_Bytes].size)
+						return false;
+				}
+			}
+			else if (type == ColumnType_Dictionary)
+			{
+				size_t dictionaryCount = size_t(columnHeader.dictionaryCount);
+				if (dictionaryCount > _size / 4 || !isInBounds(buffers[Buffer_DictionaryOffsets], (dictionaryCount + 1) * 4) || !isInBounds(buffers[Buffer_DictionaryBytes], 0))
+					return false;
+
+				column.dictionaryOffsets = reinterpret_cast<const int32_t*>(data + buffers[Buffer_DictionaryOffsets].offset);
+				column.dictionaryBytes = reinterpret_cast<const char*>(data + buffers[Buffer_DictionaryBytes].offset);
+				column.dictionaryCount = dictionaryCount;
+				for (size_t entry = 0; entry < dictionaryCount; ++entry)
+				{
+					if (column.dictionaryOffsets[entry] < 0 || column.dictionaryOffsets[entry] > column.dictionaryOffsets[entry + 1] || uint64_t(column.dictionaryOffsets[entry + 1]) > buffers[Buffer_DictionaryBytes].size)
+						return false;
+				}
+			}
+		}
+
+		m_rowCount = rowCount;
+		m_columns = std::move(columns);
+		return true;
+	}
+
+	const ColumnView* ColumnarView::findColumn(const char* _name) const
+	{
+		for (const ColumnView& column : m_columns)
+		{
+			if (strcmp(column.name, _name) == 0)
+				return &column;
+		}
+		return nullptr;
+	}
+
+	//-----------------------------------------------------------------------------
+	// Global Functions
+	//-----------------------------------------------------------------------------
+
+	void ExportColumns(const Class* _class, const void* _instances, size_t _count, std::vector<uint8_t>& _outBuffer, size_t _stride)
+	{
+		using namespace Columnar;
+		assert(_class != nullptr);
+		assert(_instances != nullptr || _count == 0);
+
+		std::vector<Leaf> leaves;
+		CollectLeaves(_class, std::string(), 0, leaves);
+
+		size_t stride = _stride != 0 ? _stride : _class->getSize();
+		const uint8_t* instances = static_cast<const uint8_t*>(_instances);
+		size_t bitmapSize = (_count + 7) / 8;
+
+		_outBuffer.clear();
+		Writer writer(_outBuffer);
+
+		// Header and column headers first, names right after them
+		writer.reserve(sizeof(FileHeader) + leaves.size() * sizeof(ColumnHeader));
+		std::vector<ColumnHeader> columnHeaders(leaves.size());
+		for (size_t i = 0; i < leaves.size(); ++i)
+		{
+			columnHeaders[i] = {};
+			columnHeaders[i].nameOffset = _outBuffer.size();
+			_outBuffer.insert(_outBuffer.end(), leaves[i].name.c_str(), leaves[i].name.c_str() + leaves[i].name.size() + 1);
+		}
+
+		for (size_t i = 0; i < leaves.size(); ++i)
+		{
+			const Leaf& leaf = leaves[i];
+			ColumnHeader& columnHeader = columnHeaders[i];
+			columnHeader.type = leaf.type;
+
+			BufferRange validityRange = writer.reserve(bitmapSize);
+			std::vector<const uint8_t*> values(_count);
+			size_t nullCount = 0;
+			for (size_t row = 0; row < _count; ++row)
+			{
+				values[row] = GetValue(leaf, instances + row * stride);
+				if (values[row] != nullptr)
+				{
+					writer.at(validityRange)[row >> 3] |= uint8_t(1 << (row & 7));
+				}
+				else
+				{
+					++nullCount;
+				}
+			}
+
+			BufferRange valuesRange = {};
+			switch (leaf.type)
+			{
+				case ColumnType_Bool:
+				{
+					valuesRange = writer.reserve(bitmapSize);
+					uint8_t* bits = writer.at(valuesRange);
+					for (size_t row = 0; row < _count; ++row)
+					{
+						if (values[row] != nullptr && *values[row] != 0)
+						{
+							bits[row >> 3] |= uint8_t(1 << (row & 7));
+						}
+					}
+				}
+				break;
+
+				case ColumnType_Utf8:
+				{
+					valuesRange = writer.reserve((_count + 1) * sizeof(int32_t));
+					std::vector<char> bytes;
+					int32_t offset = 0;
+					for (size_t row = 0; row < _count; ++row)
+					{
+						memcpy(writer.at(valuesRange) + row * sizeof(int32_t), &offset, sizeof(int32_t));
+						if (values[row] != nullptr)
+						{
+							SequenceSpan span = leaf.string->getSpan(const_cast<uint8_t*>(values[row]));
+							assert(uint64_t(offset) + span.count <= uint64_t(INT32_MAX) && "utf8 columns are limited to 2GB");
+							bytes.insert(bytes.end(), static_cast<const char*>(span.data), static_cast<const char*>(span.data) + span.count);
+							offset += int32_t(span.count);
+						}
+					}
+					memcpy(writer.at(valuesRange) + _count * sizeof(int32_t), &offset, sizeof(int32_t));
+					columnHeader.buffers[Buffer_Bytes] = writer.append(bytes.data(), bytes.size());
+				}
+				break;
+
+				case ColumnType_Dictionary:
+				{
+					valuesRange = writer.reserve(_count * sizeof(int32_t));
+					for (size_t row = 0; row < _count; ++row)
+					{
+						if (values[row] == nullptr)
+							continue;
+
+						int64_t value = ReadInteger(values[row], leaf.size);
+						auto it = std::find(leaf.enumValues.begin(), leaf.enumValues.end(), value);
+						if (it != leaf.enumValues.end())
+						{
+							int32_t index = int32_t(it - leaf.enumValues.begin());
+							memcpy(writer.at(valuesRange) + row * sizeof(int32_t), &index, sizeof(int32_t));
+						}
+						else
+						{
+							// Values that are not part of the enum are null
+							writer.at(validityRange)[row >> 3] &= uint8_t(~(1 << (row & 7)));
+							++nullCount;
+						}
+					}
+
+					std::vector<int32_t> dictionaryOffsets;
+					std::vector<char> dictionaryBytes;
+					for (const EnumValue* enumValue : leaf.enm->getValues())
+					{
+						dictionaryOffsets.push_back(int32_t(dictionaryBytes.size()));
+						dictionaryBytes.insert(dictionaryBytes.end(), enumValue->getName(), enumValue->getName() + strlen(enumValue->getName()));
+					}
+					dictionaryOffsets.push_back(int32_t(dictionaryBytes.size()));
+					columnHeader.dictionaryCount = leaf.enumValues.size();
+					columnHeader.buffers[Buffer_DictionaryOffsets] = writer.append(dictionaryOffsets.data(), dictionaryOffsets.size() * sizeof(int32_t));
+					columnHeader.buffers[Buffer_DictionaryBytes] = writer.append(dictionaryBytes.data(), dictionaryBytes.size());
+				}
+				break;
+
+				default:
+				{
+					valuesRange = writer.reserve(_count * leaf.size);
+					for (size_t row = 0; row < _count; ++row)
+					{
+						if (values[row] != nullptr)
+						{
+							memcpy(writer.at(valuesRange) + row * leaf.size, values[row], leaf.size);
+						}
+					}
+				}
+				break;
+			}
+
+			columnHeader.nullCount = nullCount;
+			columnHeader.buffers[Buffer_Validity] = validityRange;
+			columnHeader.buffers[Buffer_Values] = valuesRange;
+		}
+
+		FileHeader header = {};
+		memcpy(header.magic, s_magic, sizeof(s_magic));
+		header.version = s_version;
+		header.columnCount = uint32_t(leaves.size());
+		header.rowCount = _count;
+		header.size = _outBuffer.size();
+		memcpy(_outBuffer.data(), &header, sizeof(header));
+		if (!columnHeaders.empty())
+		{
+			memcpy(_outBuffer.data() + sizeof(FileHeader), columnHeaders.data(), columnHeaders.size() * sizeof(ColumnHeader));
+		}
+	}
+
+	size_t ImportColumns(const Class* _class, const ColumnarView& _view, void* _instances, size_t _stride)
+	{
+		using namespace Columnar;
+		assert(_class != nullptr);
+
+		std::vector<Leaf> leaves;
+		CollectLeaves(_class, std::string(), 0, leaves);
+
+		size_t stride = _stride != 0 ? _stride : _class->getSize();
+		uint8_t* instances = static_cast<uint8_t*>(_instances);
+		size_t rowCount = _view.getRowCount();
+		size_t importedColumnCount = 0;
+
+		for (const Leaf& leaf : leaves)
+		{
+			const ColumnView* column = _view.findColumn(leaf.name.c_str());
+			if (column == nullptr || column->type != leaf.type)
+				continue;
+
+			// Dictionary entries are matched with the enum values by name
+			std::vector<const EnumValue*> dictionary;
+			if (leaf.type == ColumnType_Dictionary)
+			{
+				for (size_t entry = 0; entry < column->dictionaryCount; ++entry)
+				{
+					std::string name(column->dictionaryBytes + column->dictionaryOffsets[entry], column->dictionaryBytes + column->dictionaryOffsets[entry + 1]);
+					const EnumValue* match = nullptr;
+					for (const EnumValue* enumValue : leaf.enm->getValues())
+					{
+						if (name == enumValue->getName())
+						{
+							match = enumValue;
+							break;
+						}
+					}
+					dictionary.push_back(match);
+				}
+			}
+
+			for (size_t row = 0; row < rowCount; ++row)
+			{
+				uint8_t* data = instances + row * stride + leaf.offset;
+				bool isValid = column->isValid(row);
+				const EnumValue* enumValue = nullptr;
+				if (isValid && leaf.type == ColumnType_Dictionary)
+				{
+					uint32_t index = uint32_t(column->getValues<int32_t>()[row]);
+					enumValue = index < dictionary.size() ? dictionary[index] : nullptr;
+					isValid = enumValue != nullptr;
+				}
+
+				uint8_t* value = nullptr;
+				switch (leaf.indirection)
+				{
+					case Indirection_None:
+						value = isValid ? data : nullptr;
+						break;
+
+					case Indirection_Optional:
+						if (isValid)
+						{
+							value = static_cast<uint8_t*>(leaf.optional->hasValue(data) ? leaf.optional->getValue(data) : leaf.optional->emplace(data));
+						}
+						else
+						{
+							leaf.optional->reset(data);
+						}
+						break;
+
+					// Pointed values are written but never allocated
+					case Indirection_Pointer:
+						value = isValid ? *reinterpret_cast<uint8_t**>(data) : nullptr;
+						break;
+				}
+				if (value == nullptr)
+					continue;
+
+				switch (leaf.type)
+				{
+					case ColumnType_Bool:
+						*value = column->getBool(row) ? 1 : 0;
+						break;
+
+					case ColumnType_Utf8:
+					{
+						const int32_t* offsets = column->getValues<int32_t>();
+						size_t size = size_t(offsets[row + 1] - offsets[row]);
+						leaf.string->resize(value, size);
+						SequenceSpan span = leaf.string->getSpan(value);
+						if (size > 0)
+						{
+							memcpy(span.data, column->bytes + offsets[row], size);
+						}
+					}
+					break;
+
+					case ColumnType_Dictionary:
+						WriteInteger(value, leaf.size, enumValue->getValue());
+						break;
+
+					default:
+						memcpy(value, static_cast<const uint8_t*>(column->values) + row * leaf.size, leaf.size);
+						break;
+				}
+			}
+			++importedColumnCount;
+		}
+		return importedColumnCount;
+	}
+
+} // namespace mirror
+
+#endif
@@ -0,0 +1,670 @@
+#pragma once
+
+//*****************************************************************************
+// mirror hashtable - hashing and hash tables keyed by reflected types
+//*****************************************************************************
+/*
+InstanceHasher compiles a reflected type into a list of hashing/comparison operations:
+contiguous runs of reflected bytes are merged together and padding (or any byte that
+is not covered by a reflected member) is skipped. Types whose reflected bytes cover
+the whole instance are trivially comparable, they are hashed in one go and compared
+with memcmp.
+
+Sequences (such as std::string and std::vector) and optionals are hashed by content.
+Floating point members are compared bitwise, so 0.0 and -0.0 are different keys and a NaN
+is equal to itself. Associative containers and custom types are ignored.
+
+ReflectedHashTable is an open addressing hash map (or set when there is no value type)
+whose key and value types are only known at runtime. Keys and values are copied into
+contiguous arrays, and lookups only compare keys whose hash tag matches.
+
+	const mirror::Class* recordClass = mirror::FindClassByName(schemaName);
+	mirror::ReflectedHashTable uniqueRecords(recordClass);
+	uniqueRecords.reserve(recordCount);
+	for (size_t i = 0; i < recordCount; ++i)
+	{
+		uniqueRecords.insert(records + i * recordClass->getSize());
+	}
+
+Like mirror.h, the implementation is compiled in the file that defines MIRROR_IMPLEMENTATION.
+*/
+
+#include "mirror.h"
+
+namespace mirror {
+
+	MIRROR_API uint64_t HashBytes(const void* _data, size_t _size, uint64_t _seed = 0);
+
+	class MIRROR_API InstanceHasher
+	{
+	public:
+		InstanceHasher(const Type* _type);
+		~InstanceHasher();
+		InstanceHasher(const InstanceHasher&) = delete;
+		InstanceHasher& operator=(const InstanceHasher&) = delete;
+
+		const Type* getType() const { return m_type; }
+		bool isTriviallyComparable() const { return m_isTriviallyComparable; } // hashed and compared as a single block of bytes
+
+		uint64_t hash(const void* _instance, uint64_t _seed = 0) const;
+		bool equals(const void* _a, const void* _b) const;
+
+	// internal
+		enum OperationKind
+		{
+			Operation_Bytes,
+			Operation_Sequence,
+			Operation_Optional,
+		};
+
+		struct Operation
+		{
+			OperationKind kind;
+			size_t offset;
+			size_t size; // bytes only
+			const Type* type; // sequence or optional
+			const InstanceHasher* subHasher; // elements of the sequence, value of the optional
+		};
+
+		InstanceHasher(const Type* _type, InstanceHasher* _root);
+		void build();
+		void compile(const Type* _type, size_t _offset);
+		void addBytes(size_t _offset, size_t _size);
+		const InstanceHasher* createSubHasher(const Type* _type);
+
+		const Type* m_type;
+		InstanceHasher* m_root; // owns the sub hashers of the whole tree
+		bool m_isTriviallyComparable = false;
+		std::vector<Operation> m_operations;
+		std::vector<InstanceHasher*> m_subHashers; // root only
+		std::unordered_map<const Type*, InstanceHasher*> m_hashersByType; // root only, shared by recursive types
+	};
+
+	class MIRROR_API ReflectedHashTable
+	{
+	public:
+		ReflectedHashTable(const Type* _keyType, const Type* _valueType = nullptr); // a set when there is no value type
+		~ReflectedHashTable();
+		ReflectedHashTable(const ReflectedHashTable&) = delete;
+		ReflectedHashTable& operator=(const ReflectedHashTable&) = delete;
+
+		const Type* getKeyType() const { return m_keyType; }
+		const Type* getValueType() const { return m_valueType; }
+		bool isSet() const { return m_valueType == nullptr; }
+		const InstanceHasher& getKeyHasher() const { return m_keyHasher; }
+
+		size_t getCount() const { return m_count; }
+		void reserve(size_t _count);
+		void clear();
+
+		// Copies the key and the value if the key is not in the table yet, existing entries are left untouched.
+		// Returns the stored value, or the stored key for sets (which must not be modified).
+		void* insert(const void* _key, const void* _value = nullptr, bool* _outInserted = nullptr);
+		void* find(const void* _key) const; // same return value as insert, null if not found
+		bool erase(const void* _key);
+
+		// Entries live in contiguous slots, some of which are unused
+		size_t getSlotCount() const { return m_capacity; }
+		bool isSlotUsed(size_t _slot) const { return m_tags[_slot] > Tag_Erased; }
+		const void* getKeyAt(size_t _slot) const { return m_keys + _slot * m_keyStride; }
+		void* getValueAt(size_t _slot) const { return m_values + _slot * m_valueStride; } // null for sets
+
+	// internal
+		enum : uint32_t
+		{
+			Tag_Empty = 0,
+			Tag_Erased = 1,
+		};
+
+		static uint32_t ToTag(uint64_t _hash);
+		void* getEntry(size_t _slot) const; // value, or key for sets
+		size_t findSlot(const void* _key, uint64_t _hash) const; // m_capacity if not found
+		void rehash(size_t _capacity);
+		void destroyEntries();
+
+		const Type* m_keyType;
+		const Type* m_valueType;
+		InstanceHasher m_keyHasher;
+		size_t m_keyStride;
+		size_t m_valueStride = 0;
+
+		uint32_t* m_tags = nullptr; // high bits of the hash of each slot
+		uint8_t* m_keys = nullptr;
+		uint8_t* m_values = nullptr;
+		size_t m_capacity = 0; // power of two
+		size_t m_count = 0;
+		size_t m_usedSlotCount = 0; // including erased entries
+	};
+
+} // namespace mirror
+
+//*****************************************************************************
+// Implementation
+//*****************************************************************************
+
+#ifdef MIRROR_IMPLEMENTATION
+
+#include <cstring>
+#include <algorithm>
+
+namespace mirror {
+
+	static uint64_t MixHash(uint64_t _value)
+	{
+		_value ^= _value >> 33;
+		_value *= 0xff51afd7ed558ccdull;
+		_value ^= _value >> 33;
+		_value *= 0xc4ceb9fe1a85ec53ull;
+		_value ^= _value >> 33;
+		return _value;
+	}
+
+	uint64_t HashBytes(const void* _data, size_t _size, uint64_t _seed)
+	{
+		const uint64_t MULTIPLIER = 0x9e3779b97f4a7c15ull;
+		const uint8_t* data = static_cast<const uint8_t*>(_data);
+		uint64_t hash = _seed ^ (_size * MULTIPLIER);
+		while (_size >= 8)
+		{
+			uint64_t word;
+			memcpy(&word, data, 8);
+			hash = (hash ^ MixHash(word)) * MULTIPLIER;
+			data += 8;
+			_size -= 8;
+		}
+		if (_size > 0)
+		{
+			uint64_t word = 0;
+			memcpy(&word, data, _size);
+			hash = (hash ^ MixHash(word)) * MULTIPLIER;
+		}
+		return MixHash(hash);
+	}
+
+	//-----------------------------------------------------------------------------
+	// InstanceHasher
+	//-----------------------------------------------------------------------------
+
+	InstanceHasher::InstanceHasher(const Type* _type)
+		: m_type(_type)
+		, m_root(this)
+	{
+		assert(_type != nullptr);
+		m_hashersByType[_type] = this;
+		build();
+	}
+
+	InstanceHasher::InstanceHasher(const Type* _type, InstanceHasher* _root)
+		: m_type(_type)
+		, m_root(_root)
+	{
+	}
+
+	void InstanceHasher::build()
+	{
+		compile(m_type, 0);
+		m_isTriviallyComparable = m_operations.size() == 1
+			&& m_operations[0].kind == Operation_Bytes
+			&& m_operations[0].offset == 0
+			&& m_operations[0].size == m_type->getSize();
+	}
+
+	InstanceHasher::~InstanceHasher()
+	{
+		for (InstanceHasher* subHasher : m_subHashers)
+		{
+			delete subHasher;
+		}
+	}
+
+	uint64_t InstanceHasher::hash(const void* _instance, uint64_t _seed) const
+	{
+		const uint8_t* instance = static_cast<const uint8_t*>(_instance);
+		if (m_isTriviallyComparable)
+			return HashBytes(instance, m_operations[0].size, _seed);
+
+		uint64_t hash = _seed;
+		for (const Operation& operation : m_operations)
+		{
+			const void* data = instance + operation.offset;
+			switch (operation.kind)
+			{
+				case Operation_Bytes:
+					hash = HashBytes(data, operation.size, hash);
+					break;
+
+				case Operation_Sequence:
+				{
+					SequenceSpan span = operation.type->asSequence()->getSpan(const_cast<void*>(data));
+					hash = MixHash(hash ^ span.count);
+					if (operation.subHasher->isTriviallyComparable())
+					{
+						hash = HashBytes(span.data, span.count * span.stride, hash);
+					}
+					else
+					{
+						for (size_t i = 0; i < span.count; ++i)
+						{
+							hash = operation.subHasher->hash(span.at(i), hash);
+						}
+					}
+				}
+				break;
+
+				case Operation_Optional:
+				{
+					const void* value = operation.type->asOptional()->getValue(const_cast<void*>(data));
+					hash = MixHash(hash ^ (value != nullptr ? 1 : 0));
+					if (value != nullptr)
+					{
+						hash = operation.subHasher->hash(value, hash);
+					}
+				}
+				break;
+			}
+		}
+		return hash;
+	}
+
+	bool InstanceHasher::equals(const void* _a, const void* _b) const
+	{
+		const uint8_t* a = static_cast<const uint8_t*>(_a);
+		const uint8_t* b = static_cast<const uint8_t*>(_b);
+		if (m_isTriviallyComparable)
+			return memcmp(a, b, m_operations[0].size) == 0;
+
+		for (const Operation& operation : m_operations)
+		{
+			const void* dataA = a + operation.offset;
+			const void* dataB = b + operation.offset;
+			switch (operation.kind)
+			{
+				case Operation_Bytes:
+				{
+					if (memcmp(dataA, dataB, operation.size) != 0)
+						return false;
+				}
+				break;
+
+				case Operation_Sequence:
+				{
+					const Sequence* sequence = operation.type->asSequence();
+					SequenceSpan spanA = sequence->getSpan(const_cast<void*>(dataA));
+					SequenceSpan spanB = sequence->getSpan(const_cast<void*>(dataB));
+					if (spanA.count != spanB.count)
+						return false;
+
+					if (operation.subHasher->isTriviallyComparable())
+					{
+						if (spanA.count > 0 && memcmp(spanA.data, spanB.data, spanA.count * spanA.stride) != 0)
+							return false;
+					}
+					else
+					{
+						for (size_t i = 0; i < spanA.count; ++i)
+						{
+							if (!operation.subHasher->equals(spanA.at(i), spanB.at(i)))
+								return false;
+						}
+					}
+				}
+				break;
+
+				case Operation_Optional:
+				{
+					const Optional* optional = operation.type->asOptional();
+					const void* valueA = optional->getValue(const_cast<void*>(dataA));
+					const void* valueB = optional->getValue(const_cast<void*>(dataB));
+					if ((valueA == nullptr) != (valueB == nullptr))
+						return false;
+					if (valueA != nullptr && !operation.subHasher->equals(valueA, valueB))
+						return false;
+				}
+				break;
+			}
+		}
+		return true;
+	}
+
+	void InstanceHasher::compile(const Type* _type, size_t _offset)
+	{
+		if (_type == nullptr)
+			return;
+
+		switch (_type->getTypeInfo())
+		{
+			case TypeInfo_bool:
+			case TypeInfo_char:
+			case TypeInfo_int8:
+			case TypeInfo_int16:
+			case TypeInfo_int32:
+			case TypeInfo_int64:
+			case TypeInfo_uint8:
+			case TypeInfo_uint16:
+			case TypeInfo_uint32:
+			case TypeInfo_uint64:
+			case TypeInfo_float:
+			case TypeInfo_double:
+			case TypeInfo_Enum:
+			case TypeInfo_Pointer:
+				addBytes(_offset, _type->getSize());
+				break;
+
+			case TypeInfo_Class:
+			{
+				for (ClassMember* member : _type->asClass()->getMembers())
+				{
+					compile(member->getType(), _offset + member->getOffset());
+				}
+			}
+			break;
+
+			case TypeInfo_FixedSizeArray:
+			{
+				const FixedSizeArray* fixedSizeArray = _type->asFixedSizeArray();
+				const Type* subType = fixedSizeArray->getSubType();
+				for (size_t i = 0; subType != nullptr && i < fixedSizeArray->getElementCount(); ++i)
+				{
+					compile(subType, _offset + i * subType->getSize());
+				}
+			}
+			break;
+
+			case TypeInfo_Sequence:
+			{
+				const Sequence* sequence = _type->asSequence();
+				if (sequence->isFixedSize())
+				{
+					// Fixed size sequences (std::array) store their elements inline
+					for (size_t i = 0; i < sequence->getFixedCount(); ++i)
+					{
+						compile(sequence->getSubType(), _offset + i * sequence->getElementStride());
+					}
+				}
+				else if (sequence->getSubType() != nullptr)
+				{
+					m_operations.push_back({ Operation_Sequence, _offset, 0, _type, createSubHasher(sequence->getSubType()) });
+				}
+			}
+			break;
+
+			case TypeInfo_Optional:
+			{
+				const Optional* optional = _type->asOptional();
+				if (optional->getSubType() != nullptr)
+				{
+					m_operations.push_back({ Operation_Optional, _offset, 0, _type, createSubHasher(optional->getSubType()) });
+				}
+			}
+			break;
+
+			default:
+				break;
+		}
+	}
+
+	void InstanceHasher::addBytes(size_t _offset, size_t _size)
+	{
+		if (_size == 0)
+			return;
+
+		if (!m_operations.empty())
+		{
+			Operation& last = m_operations.back();
+			if (last.kind == Operation_Bytes && last.offset + last.size == _offset)
+			{
+				last.size += _size;
+				return;
+			}
+		}
+		m_operations.push_back({ Operation_Bytes, _offset, _size, nullptr, nullptr });
+	}
+
+	const InstanceHasher* InstanceHasher::createSubHasher(const Type* _type)
+	{
+		// Registered before being compiled, so that recursive types (a Node holding a std::vector<Node>) reuse it instead of recursing forever
+		auto it = m_root->m_hashersByType.find(_type);
+		if (it != m_root->m_hashersByType.end())
+			return it->second;
+
+		InstanceHasher* subHasher = new InstanceHasher(_type, m_root);
+		m_root->m_hashersByType[_type] = subHasher;
+		m_root->m_subHashers.push_back(subHasher);
+		subHasher->build();
+		return subHasher;
+	}
+
+	//-----------------------------------------------------------------------------
+	// ReflectedHashTable
+	//-----------------------------------------------------------------------------
+
+	ReflectedHashTable::ReflectedHashTable(const Type* _keyType, const Type* _valueType)
+		: m_keyType(_keyType)
+		, m_valueType(_valueType)
+		, m_keyHasher(_keyType)
+		, m_keyStride(_keyType->getSize())
+	{
+		assert(_keyType->isCopyConstructible());
+		if (_valueType != nullptr)
+		{
+			assert(_valueType->isCopyConstructible());
+			m_valueStride = _valueType->getSize();
+		}
+	}
+
+	ReflectedHashTable::~ReflectedHashTable()
+	{
+		destroyEntries();
+		delete[] m_tags;
+		::operator delete(m_keys, std::align_val_t(m_keyType->getAlignment()));
+		if (m_values != nullptr)
+		{
+			::operator delete(m_values, std::align_val_t(m_valueType->getAlignment()));
+		}
+	}
+
+	void ReflectedHashTable::reserve(size_t _count)
+	{
+		size_t capacity = 16;
+		while (capacity * 3 / 4 < _count)
+		{
+			capacity *= 2;
+		}
+		if (capacity > m_capacity)
+		{
+			rehash(capacity);
+		}
+	}
+
+	void ReflectedHashTable::clear()
+	{
+		destroyEntries();
+		if (m_tags != nullptr)
+		{
+			memset(m_tags, 0, m_capacity * sizeof(uint32_t));
+		}
+		m_count = 0;
+		m_usedSlotCount = 0;
+	}
+
+	void* ReflectedHashTable::insert(const void* _key, const void* _value, bool* _outInserted)
+	{
+		assert(_key != nullptr);
+		assert(isSet() || _value != nullptr);
+
+		if ((m_usedSlotCount + 1) * 4 > m_capacity * 3)
+		{
+			// Only grow when the table is mostly filled with live entries, otherwise rehashing in place gets rid of the erased ones
+			rehash(m_count * 2 >= m_capacity ? std::max<size_t>(m_capacity * 2, 16) : m_capacity);
+		}
+
+		uint64_t hash = m_keyHasher.hash(_key);
+		uint32_t tag = ToTag(hash);
+		size_t mask = m_capacity - 1;
+		size_t insertSlot = m_capacity;
+		for (size_t slot = size_t(hash) & mask;; slot = (slot + 1) & mask)
+		{
+			uint32_t slotTag = m_tags[slot];
+			if (slotTag == Tag_Empty)
+			{
+				if (insertSlot == m_capacity)
+				{
+					insertSlot = slot;
+					++m_usedSlotCount;
+				}
+				break;
+			}
+			if (slotTag == Tag_Erased)
+			{
+				if (insertSlot == m_capacity)
+				{
+					insertSlot = slot;
+				}
+			}
+			else if (slotTag == tag && m_keyHasher.equals(m_keys + slot * m_keyStride, _key))
+			{
+				if (_outInserted != nullptr)
+				{
+					*_outInserted = false;
+				}
+				return getEntry(slot);
+			}
+		}
+
+		m_tags[insertSlot] = tag;
+		m_keyType->copyConstruct(m_keys + insertSlot * m_keyStride, _key);
+		if (!isSet())
+		{
+			m_valueType->copyConstruct(m_values + insertSlot * m_valueStride, _value);
+		}
+		++m_count;
+
+		if (_outInserted != nullptr)
+		{
+			*_outInserted = true;
+		}
+		return getEntry(insertSlot);
+	}
+
+	void* ReflectedHashTable::find(const void* _key) const
+	{
+		size_t slot = findSlot(_key, m_keyHasher.hash(_key));
+		return slot != m_capacity ? getEntry(slot) : nullptr;
+	}
+
+	bool ReflectedHashTable::erase(const void* _key)
+	{
+		size_t slot = findSlot(_key, m_keyHasher.hash(_key));
+		if (slot == m_capacity)
+			return false;
+
+		m_keyType->destruct(m_keys + slot * m_keyStride);
+		if (!isSet())
+		{
+			m_valueType->destruct(m_values + slot * m_valueStride);
+		}
+		m_tags[slot] = Tag_Erased;
+		--m_count;
+		return true;
+	}
+
+	uint32_t ReflectedHashTable::ToTag(uint64_t _hash)
+	{
+		// The low bits pick the slot, the high bits filter out most of the key comparisons
+		uint32_t tag = uint32_t(_hash >> 32);
+		return tag > Tag_Erased ? tag : tag + 2;
+	}
+
+	void* ReflectedHashTable::getEntry(size_t _slot) const
+	{
+		return isSet() ? m_keys + _slot * m_keyStride : m_values + _slot * m_valueStride;
+	}
+
+	size_t ReflectedHashTable::findSlot(const void* _key, uint64_t _hash) const
+	{
+		if (m_count == 0)
+			return m_capacity;
+
+		uint32_t tag = ToTag(_hash);
+		size_t mask = m_capacity - 1;
+		for (size_t slot = size_t(_hash) & mask;; slot = (slot + 1) & mask)
+		{
+			uint32_t slotTag = m_tags[slot];
+			if (slotTag == Tag_Empty)
+				return m_capacity;
+
+			if (slotTag == tag && m_keyHasher.equals(m_keys + slot * m_keyStride, _key))
+				return slot;
+		}
+	}
+
+	void ReflectedHashTable::rehash(size_t _capacity)
+	{
+		assert(_capacity >= 16 && (_capacity & (_capacity - 1)) == 0);
+		assert(_capacity * 3 / 4 > m_count);
+
+		uint32_t* tags = new uint32_t[_capacity]();
+		uint8_t* keys = static_cast<uint8_t*>(::operator new(_capacity * m_keyStride, std::align_val_t(m_keyType->getAlignment())));
+		uint8_t* values = isSet() ? nullptr : static_cast<uint8_t*>(::operator new(_capacity * m_valueStride, std::align_val_t(m_valueType->getAlignment())));
+
+		// Entries are relocated, trivially copyable ones with memcpy
+		size_t mask = _capacity - 1;
+		for (size_t oldSlot = 0; oldSlot < m_capacity; ++oldSlot)
+		{
+			if (!isSlotUsed(oldSlot))
+				continue;
+
+			uint8_t* key = m_keys + oldSlot * m_keyStride;
+			uint64_t hash = m_keyHasher.hash(key);
+			size_t slot = size_t(hash) & mask;
+			while (tags[slot] != Tag_Empty)
+			{
+				slot = (slot + 1) & mask;
+			}
+			tags[slot] = m_tags[oldSlot];
+
+			m_keyType->copyConstruct(keys + slot * m_keyStride, key);
+			m_keyType->destruct(key);
+			if (!isSet())
+			{
+				uint8_t* value = m_values + oldSlot * m_valueStride;
+				m_valueType->copyConstruct(values + slot * m_valueStride, value);
+				m_valueType->destruct(value);
+			}
+		}
+
+		delete[] m_tags;
+		::operator delete(m_keys, std::align_val_t(m_keyType->getAlignment()));
+		if (m_values != nullptr)
+		{
+			::operator delete(m_values, std::align_val_t(m_valueType->getAlignment()));
+		}
+
+		m_tags = tags;
+		m_keys = keys;
+		m_values = values;
+		m_capacity = _capacity;
+		m_usedSlotCount = m_count;
+	}
+
+	void ReflectedHashTable::destroyEntries()
+	{
+		if (m_keyType->isTriviallyCopyable() && (isSet() || m_valueType->isTriviallyCopyable()))
+			return;
+
+		for (size_t slot = 0; slot < m_capacity; ++slot)
+		{
+			if (!isSlotUsed(slot))
+				continue;
+
+			m_keyType->destruct(m_keys + slot * m_keyStride);
+			if (!isSet())
+			{
+				m_valueType->destruct(m_values + slot * m_valueStride);
+			}
+		}
+	}
+
+} // namespace mirror
+
+#endif
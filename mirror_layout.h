@@ -0,0 +1,389 @@
+#pragma once
+
+//*****************************************************************************
+// mirror layout - struct layout analysis of reflected classes
+//*****************************************************************************
+/*
+Uses member offsets, sizes and alignments to report, for each reflected class:
+- the bytes wasted in padding (between members and at the end of the class)
+- the members that straddle a cache line boundary
+- a member order that minimizes padding, and the resulting size
+- when fed with access counters, a hot/cold split suggestion
+
+Gaps between members that are too large to be alignment padding are reported as
+bytes not covered by reflected members: unreflected members, the vtable pointer or
+parts of base classes. The reordering suggestion only moves the members declared by
+the class itself, after its first one: base classes and the vtable pointer can't be
+moved. Inherited members are assumed to live at the start of the class, which is the
+case for single inheritance.
+
+	mirror::LayoutAccessCounters counters;
+	counters.record(positionMember, 1000000);
+	counters.record(debugNameMember, 12);
+
+	mirror::LayoutAnalyzer analyzer;
+	analyzer.setAccessCounters(&counters);
+	for (const mirror::ClassLayoutReport& report : analyzer.analyzeAllClasses())
+	{
+		if (report.paddingBytes > 0)
+			mirror::LayoutAnalyzer::PrintReport(stdout, report);
+	}
+*/
+
+#include "mirror.h"
+
+#include <cstdio>
+
+namespace mirror {
+
+	class MIRROR_API LayoutAccessCounters
+	{
+	public:
+		void record(const ClassMember* _member, uint64_t _count = 1);
+		uint64_t getCount(const ClassMember* _member) const;
+		void clear();
+
+	// internal
+		std::unordered_map<const ClassMember*, uint64_t> m_counts;
+	};
+
+	struct LayoutMemberInfo
+	{
+		const ClassMember* member = nullptr;
+		size_t offset = 0;
+		size_t size = 0;
+		size_t alignment = 1;
+		size_t paddingBefore = 0;
+		size_t firstCacheLine = 0;
+		size_t lastCacheLine = 0;
+		uint64_t accessCount = 0;
+
+		bool straddlesCacheLine() const { return firstCacheLine != lastCacheLine; }
+	};
+
+	struct ClassLayoutReport
+	{
+		const Class* clss = nullptr;
+		size_t size = 0;
+		size_t alignment = 1;
+		size_t cacheLineCount = 0;
+
+		size_t usedBytes = 0;
+		size_t paddingBytes = 0; // total, including tail padding
+		size_t tailPadding = 0;
+		size_t unreflectedBytes = 0; // gaps larger than the alignment of the next member, not counted as padding
+		size_t straddlingMemberCount = 0;
+
+		std::vector<LayoutMemberInfo> members; // by increasing offset
+
+		// Members declared by the class sorted by decreasing alignment then decreasing size, and the size of the class laid out this
+		// way from reorderableOffset. Unreflected bytes after reorderableOffset are assumed to be packed after the members.
+		std::vector<const ClassMember*> optimalOrder;
+		size_t optimalSize = 0;
+		size_t reorderableOffset = 0; // offset of the first member declared by the class, what precedes it can't be moved
+
+		// Only filled when access counters are given. Hot members are the most accessed ones, covering the hot access ratio of all accesses.
+		std::vector<const ClassMember*> hotMembers;
+		std::vector<const ClassMember*> coldMembers;
+		size_t hotSize = 0; // size of the hot members packed together
+		size_t hotCacheLineCount = 0;
+	};
+
+	class MIRROR_API LayoutAnalyzer
+	{
+	public:
+		void setCacheLineSize(size_t _cacheLineSize);
+		void setAccessCounters(const LayoutAccessCounters* _counters, float _hotAccessRatio = 0.9f);
+
+		ClassLayoutReport analyze(const Class* _class) const;
+		std::vector<ClassLayoutReport> analyzeAllClasses() const;
+
+		static void PrintReport(FILE* _file, const ClassLayoutReport& _report);
+
+	// internal
+		static size_t ComputePackedSize(const std::vector<const ClassMember*>& _members, size_t _alignment, size_t _offset = 0);
+
+		size_t m_cacheLineSize = 64;
+		const LayoutAccessCounters* m_accessCounters = nullptr;
+		float m_hotAccessRatio = 0.9f;
+	};
+
+} // namespace mirror
+
+//*****************************************************************************
+// Implementation
+//*****************************************************************************
+
+#ifdef MIRROR_IMPLEMENTATION
+
+#include <algorithm>
+
+namespace mirror {
+
+	//-----------------------------------------------------------------------------
+	// LayoutAccessCounters
+	//-----------------------------------------------------------------------------
+
+	void LayoutAccessCounters::record(const ClassMember* _member, uint64_t _count)
+	{
+		assert(_member != nullptr);
+		m_counts[_member] += _count;
+	}
+
+	uint64_t LayoutAccessCounters::getCount(const ClassMember* _member) const
+	{
+		auto it = m_counts.find(_member);
+		return it != m_counts.end() ? it->second : 0;
+	}
+
+	void LayoutAccessCounters::clear()
+	{
+		m_counts.clear();
+	}
+
+	//-----------------------------------------------------------------------------
+	// LayoutAnalyzer
+	//-----------------------------------------------------------------------------
+
+	void LayoutAnalyzer::setCacheLineSize(size_t _cacheLineSize)
+	{
+		assert(_cacheLineSize > 0);
+		m_cacheLineSize = _cacheLineSize;
+	}
+
+	void LayoutAnalyzer::setAccessCounters(const LayoutAccessCounters* _counters, float _hotAccessRatio)
+	{
+		m_accessCounters = _counters;
+		m_hotAccessRatio = _hotAccessRatio;
+	}
+
+	ClassLayoutReport LayoutAnalyzer::analyze(const Class* _class) const
+	{
+		assert(_class != nullptr);
+
+		ClassLayoutReport report;
+		report.clss = _class;
+		report.size = _class->getSize();
+		report.alignment = _class->getAlignment();
+		report.cacheLineCount = (report.size + m_cacheLineSize - 1) / m_cacheLineSize;
+
+		for (ClassMember* member : _class->getMembers())
+		{
+			Type* memberType = member->getType();
+			if (memberType == nullptr)
+				continue;
+
+			LayoutMemberInfo info;
+			info.member = member;
+			info.offset = member->getOffset();
+			info.size = memberType->getSize();
+			info.alignment = memberType->getAlignment();
+			info.firstCacheLine = info.offset / m_cacheLineSize;
+			info.lastCacheLine = info.size > 0 ? (info.offset + info.size - 1) / m_cacheLineSize : info.firstCacheLine;
+			info.accessCount = m_accessCounters != nullptr ? m_accessCounters->getCount(member) : 0;
+			report.members.push_back(info);
+		}
+
+		std::sort(report.members.begin(), report.members.end(), [](const LayoutMemberInfo& _a, const LayoutMemberInfo& _b)
+		{
+			return _a.offset < _b.offset;
+		});
+
+		report.reorderableOffset = report.size;
+		for (const LayoutMemberInfo& info : report.members)
+		{
+			if (info.member->getOwnerClass() == _class)
+			{
+				report.reorderableOffset = std::min(report.reorderableOffset, info.offset);
+			}
+		}
+
+		// Alignment padding is always smaller than the alignment that requires it, larger gaps hide something
+		size_t end = 0;
+		size_t movableUnreflectedBytes = 0;
+		for (LayoutMemberInfo& info : report.members)
+		{
+			info.paddingBefore = info.offset > end ? info.offset - end : 0;
+			if (info.paddingBefore >= info.alignment)
+			{
+				report.unreflectedBytes += info.paddingBefore;
+				if (end >= report.reorderableOffset)
+				{
+					movableUnreflectedBytes += info.paddingBefore;
+				}
+			}
+			else
+			{
+				report.paddingBytes += info.paddingBefore;
+			}
+			end = std::max(end, info.offset + info.size);
+			report.usedBytes += info.size;
+			if (info.straddlesCacheLine())
+				++report.straddlingMemberCount;
+		}
+		size_t tailGap = report.size > end ? report.size - end : 0;
+		if (tailGap >= report.alignment)
+		{
+			report.unreflectedBytes += tailGap;
+			movableUnreflectedBytes += tailGap;
+		}
+		else
+		{
+			report.tailPadding = tailGap;
+			report.paddingBytes += tailGap;
+		}
+
+		// Optimal order: largest alignment first, which leaves no padding between members of the same alignment
+		for (const LayoutMemberInfo& info : report.members)
+		{
+			if (info.member->getOwnerClass() == _class)
+			{
+				report.optimalOrder.push_back(info.member);
+			}
+		}
+		std::stable_sort(report.optimalOrder.begin(), report.optimalOrder.end(), [](const ClassMember* _a, const ClassMember* _b)
+		{
+			Type* a = _a->getType();
+			Type* b = _b->getType();
+			if (a->getAlignment() != b->getAlignment())
+				return a->getAlignment() > b->getAlignment();
+			return a->getSize() > b->getSize();
+		});
+		report.optimalSize = ComputePackedSize(report.optimalOrder, report.alignment, report.reorderableOffset + movableUnreflectedBytes);
+
+		// Hot/cold split
+		if (m_accessCounters != nullptr)
+		{
+			std::vector<const LayoutMemberInfo*> byAccess;
+			uint64_t totalAccesses = 0;
+			for (const LayoutMemberInfo& info : report.members)
+			{
+				byAccess.push_back(&info);
+				totalAccesses += info.accessCount;
+			}
+			std::stable_sort(byAccess.begin(), byAccess.end(), [](const LayoutMemberInfo* _a, const LayoutMemberInfo* _b)
+			{
+				return _a->accessCount > _b->accessCount;
+			});
+
+			uint64_t hotAccesses = 0;
+			for (const LayoutMemberInfo* info : byAccess)
+			{
+				bool isHot = totalAccesses > 0 && info->accessCount > 0 && double(hotAccesses) < double(totalAccesses) * m_hotAccessRatio;
+				if (isHot)
+				{
+					hotAccesses += info->accessCount;
+					report.hotMembers.push_back(info->member);
+				}
+				else
+				{
+					report.coldMembers.push_back(info->member);
+				}
+			}
+
+			std::vector<const ClassMember*> packedHotMembers = report.hotMembers;
+			std::stable_sort(packedHotMembers.begin(), packedHotMembers.end(), [](const ClassMember* _a, const ClassMember* _b)
+			{
+				return _a->getType()->getAlignment() > _b->getType()->getAlignment();
+			});
+			report.hotSize = ComputePackedSize(packedHotMembers, 1);
+			report.hotCacheLineCount = (report.hotSize + m_cacheLineSize - 1) / m_cacheLineSize;
+		}
+
+		return report;
+	}
+
+	std::vector<ClassLayoutReport> LayoutAnalyzer::analyzeAllClasses() const
+	{
+		std::vector<ClassLayoutReport> reports;
+		for (Type* type : GetTypeSet().getTypes())
+		{
+			const Class* clss = type->asClass();
+			if (clss != nullptr)
+			{
+				reports.push_back(analyze(clss));
+			}
+		}
+
+		// Most wasteful classes first
+		std::sort(reports.begin(), reports.end(), [](const ClassLayoutReport& _a, const ClassLayoutReport& _b)
+		{
+			return _a.paddingBytes > _b.paddingBytes;
+		});
+		return reports;
+	}
+
+	void LayoutAnalyzer::PrintReport(FILE* _file, const ClassLayoutReport& _report)
+	{
+		fprintf(_file, "%s: size %zu, alignment %zu, %zu cache line(s), %zu padding byte(s) (%zu at the end)\n",
+			_report.clss->getName(), _report.size, _report.alignment, _report.cacheLineCount, _report.paddingBytes, _report.tailPadding);
+
+		for (const LayoutMemberInfo& info : _report.members)
+		{
+			if (info.paddingBefore >= info.alignment)
+			{
+				fprintf(_file, "\t%6s  [%zu bytes not covered by reflected members]\n", "", info.paddingBefore);
+			}
+			else if (info.paddingBefore > 0)
+			{
+				fprintf(_file, "\t%6s  [%zu bytes of padding]\n", "", info.paddingBefore);
+			}
+			fprintf(_file, "\t%6zu  %-32s %-24s size %zu, align %zu%s",
+				info.offset, info.member->getName(), info.member->getType()->getName(), info.size, info.alignment,
+				info.straddlesCacheLine() ? ", straddles cache lines" : "");
+			if (info.accessCount > 0)
+			{
+				fprintf(_file, ", %llu accesses", (unsigned long long)info.accessCount);
+			}
+			fprintf(_file, "\n");
+		}
+
+		if (_report.optimalSize < _report.size)
+		{
+			fprintf(_file, "\treordering the members of %s from offset %zu saves %zu byte(s) (%zu -> %zu):",
+				_report.clss->getName(), _report.reorderableOffset, _report.size - _report.optimalSize, _report.size, _report.optimalSize);
+			for (const ClassMember* member : _report.optimalOrder)
+			{
+				fprintf(_file, " %s", member->getName());
+			}
+			fprintf(_file, "\n");
+		}
+		if (_report.unreflectedBytes > 0)
+		{
+			fprintf(_file, "\t%zu byte(s) are not covered by reflected members (vtable pointer, base classes or unreflected members), the analysis can't account for them\n", _report.unreflectedBytes);
+		}
+
+		if (!_report.hotMembers.empty() && !_report.coldMembers.empty())
+		{
+			fprintf(_file, "\thot members (%zu bytes, %zu cache line(s)):", _report.hotSize, _report.hotCacheLineCount);
+			for (const ClassMember* member : _report.hotMembers)
+			{
+				fprintf(_file, " %s", member->getName());
+			}
+			fprintf(_file, "\n\tcold members:");
+			for (const ClassMember* member : _report.coldMembers)
+			{
+				fprintf(_file, " %s", member->getName());
+			}
+			fprintf(_file, "\n");
+		}
+	}
+
+	size_t LayoutAnalyzer::ComputePackedSize(const std::vector<const ClassMember*>& _members, size_t _alignment, size_t _offset)
+	{
+		size_t size = _offset;
+		size_t alignment = std::max<size_t>(_alignment, 1);
+		for (const ClassMember* member : _members)
+		{
+			Type* memberType = member->getType();
+			size_t memberAlignment = std::max<size_t>(memberType->getAlignment(), 1);
+			size = (size + memberAlignment - 1) / memberAlignment * memberAlignment;
+			size += memberType->getSize();
+			alignment = std::max(alignment, memberAlignment);
+		}
+		return (size + alignment - 1) / alignment * alignment;
+	}
+
+} // namespace mirror
+
+#endif
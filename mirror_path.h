@@ -0,0 +1,279 @@
+#pragma once
+
+//*****************************************************************************
+// mirror path - compiled accessors for member paths
+//*****************************************************************************
+/*
+Compiles paths such as "transform.position.x" or "bones[12].rotation" against a root
+class into a reusable accessor. Member names are resolved once; consecutive offsets
+are folded together so that resolving a path only goes through the steps that depend on
+the instance: following pointer members and indexing dynamic sequences (std::vector...).
+
+Indices of fixed size arrays (and std::array) are checked when compiling, indices of
+dynamic sequences are checked when resolving. Resolving returns null if a pointer on the
+way is null or an index is out of bounds.
+
+	mirror::FieldPath path;
+	if (path.compile(mirror::GetClass<Character>(), "bones[12].rotation.w"))
+	{
+		float w;
+		path.get(&character, w);
+		path.set(&character, 1.0f);
+	}
+
+Like mirror.h, the implementation is compiled in the file that defines MIRROR_IMPLEMENTATION.
+*/
+
+#include "mirror.h"
+
+namespace mirror {
+
+	class MIRROR_API FieldPath
+	{
+	public:
+		// Returns false and leaves the path invalid if it can't be compiled
+		bool compile(const Class* _rootClass, const char* _path);
+		bool isValid() const { return m_type != nullptr; }
+		const char* getError() const { return m_error.c_str(); }
+
+		const Class* getRootClass() const { return m_rootClass; }
+		const Type* getType() const { return m_type; } // type of the addressed value
+		bool isConstantOffset() const { return m_steps.empty(); } // the value is always at getConstantOffset() from the root
+		size_t getConstantOffset() const { return m_finalOffset; }
+
+		void* resolve(void* _root) const;
+		const void* resolve(const void* _root) const { return resolve(const_cast<void*>(_root)); }
+
+		// Resolves the path for _count roots spaced by _stride bytes (defaults to the root class size)
+		void resolveBatch(void* _roots, size_t _count, void** _outValues, size_t _stride = 0) const;
+
+		// T must be the type of the addressed value. Return false if the path can't be resolved on this root.
+		template <typename T> bool get(const void* _root, T& _outValue) const;
+		template <typename T> bool set(void* _root, const T& _value) const;
+
+	// internal
+		enum StepKind
+		{
+			Step_Dereference,
+			Step_SequenceIndex,
+		};
+
+		struct Step
+		{
+			size_t offset; // applied before the step
+			StepKind kind;
+			size_t index;
+			const Sequence* sequence;
+		};
+
+		bool fail(const std::string& _error);
+
+		const Class* m_rootClass = nullptr;
+		const Type* m_type = nullptr;
+		std::vector<Step> m_steps;
+		size_t m_finalOffset = 0;
+		std::string m_error;
+	};
+
+	template <typename T>
+	bool FieldPath::get(const void* _root, T& _outValue) const
+	{
+		assert(isValid() && m_type->getTypeID() == GetTypeID<T>());
+		const void* value = resolve(_root);
+		if (value == nullptr)
+			return false;
+
+		_outValue = *static_cast<const T*>(value);
+		return true;
+	}
+
+	template <typename T>
+	bool FieldPath::set(void* _root, const T& _value) const
+	{
+		assert(isValid() && m_type->getTypeID() == GetTypeID<T>());
+		void* value = resolve(_root);
+		if (value == nullptr)
+			return false;
+
+		*static_cast<T*>(value) = _value;
+		return true;
+	}
+
+} // namespace mirror
+
+//*****************************************************************************
+// Implementation
+//*****************************************************************************
+
+#ifdef MIRROR_IMPLEMENTATION
+
+#include <cctype>
+#include <cstdlib>
+
+namespace mirror {
+
+	bool FieldPath::compile(const Class* _rootClass, const char* _path)
+	{
+		assert(_rootClass != nullptr && _path != nullptr);
+
+		m_rootClass = _rootClass;
+		m_type = nullptr;
+		m_steps.clear();
+		m_finalOffset = 0;
+		m_error.clear();
+
+		const Type* type = _rootClass;
+		size_t offset = 0;
+		const char* c = _path;
+		while (true)
+		{
+			// Members of pointed classes are reached through the pointer
+			if (type->getTypeInfo() == TypeInfo_Pointer)
+			{
+				m_steps.push_back({ offset, Step_Dereference, 0, nullptr });
+				offset = 0;
+				type = type->asPointer()->getSubType();
+				if (type == nullptr)
+					return fail("pointer to an unreflected type");
+			}
+
+			const Class* clss = type->asClass();
+			if (clss == nullptr)
+				return fail(std::string("'") + type->getName() + "' has no members");
+
+			const char* nameStart = c;
+			while (isalnum((unsigned char)*c) || *c == '_')
+			{
+				++c;
+			}
+			if (c == nameStart)
+				return fail(std::string("expected a member name at '") + c + "'");
+
+			std::string name(nameStart, c);
+			const ClassMember* member = clss->findMemberByName(name.c_str());
+			if (member == nullptr)
+				return fail("'" + name + "' is not a member of " + clss->getName());
+
+			type = member->getType();
+			if (type == nullptr)
+				return fail("'" + name + "' has no reflected type");
+			offset += member->getOffset();
+
+			while (*c == '[')
+			{
+				++c;
+				char* end = nullptr;
+				unsigned long long index = strtoull(c, &end, 10);
+				if (end == c || *end != ']' || *c == '-')
+					return fail("expected an index in '" + name + "[...]'");
+				c = end + 1;
+
+				if (type->getTypeInfo() == TypeInfo_Pointer)
+				{
+					m_steps.push_back({ offset, Step_Dereference, 0, nullptr });
+					offset = 0;
+					type = type->asPointer()->getSubType();
+					if (type == nullptr)
+						return fail("pointer to an unreflected type");
+				}
+
+				if (const FixedSizeArray* fixedSizeArray = type->asFixedSizeArray())
+				{
+					type = fixedSizeArray->getSubType();
+					if (type == nullptr)
+						return fail("'" + name + "' contains unreflected elements");
+					if (index >= fixedSizeArray->getElementCount())
+						return fail("index " + std::to_string(index) + " is out of the bounds of '" + name + "'");
+					offset += size_t(index) * type->getSize();
+				}
+				else if (const Sequence* sequence = type->asSequence())
+				{
+					type = sequence->getSubType();
+					if (type == nullptr)
+						return fail("'" + name + "' contains unreflected elements");
+
+					if (sequence->isFixedSize())
+					{
+						if (index >= sequence->getFixedCount())
+							return fail("index " + std::to_string(index) + " is out of the bounds of '" + name + "'");
+						offset += size_t(index) * sequence->getElementStride();
+					}
+					else
+					{
+						m_steps.push_back({ offset, Step_SequenceIndex, size_t(index), sequence });
+						offset = 0;
+					}
+				}
+				else
+				{
+					return fail("'" + name + "' can't be indexed");
+				}
+			}
+
+			if (*c == 0)
+				break;
+			if (*c != '.')
+				return fail(std::string("unexpected '") + *c + "'");
+			++c;
+		}
+
+		m_finalOffset = offset;
+		m_type = type;
+		return true;
+	}
+
+	void* FieldPath::resolve(void* _root) const
+	{
+		assert(isValid());
+		uint8_t* data = static_cast<uint8_t*>(_root);
+		for (const Step& step : m_steps)
+		{
+			data += step.offset;
+			if (step.kind == Step_Dereference)
+			{
+				data = *reinterpret_cast<uint8_t**>(data);
+			}
+			else
+			{
+				SequenceSpan span = step.sequence->getSpan(data);
+				data = step.index < span.count ? static_cast<uint8_t*>(span.at(step.index)) : nullptr;
+			}
+
+			if (data == nullptr)
+				return nullptr;
+		}
+		return data + m_finalOffset;
+	}
+
+	void FieldPath::resolveBatch(void* _roots, size_t _count, void** _outValues, size_t _stride) const
+	{
+		assert(isValid());
+		size_t stride = _stride != 0 ? _stride : m_rootClass->getSize();
+		uint8_t* roots = static_cast<uint8_t*>(_roots);
+		if (isConstantOffset())
+		{
+			for (size_t i = 0; i < _count; ++i)
+			{
+				_outValues[i] = roots + i * stride + m_finalOffset;
+			}
+			return;
+		}
+
+		for (size_t i = 0; i < _count; ++i)
+		{
+			_outValues[i] = resolve(roots + i * stride);
+		}
+	}
+
+	bool FieldPath::fail(const std::string& _error)
+	{
+		m_type = nullptr;
+		m_steps.clear();
+		m_finalOffset = 0;
+		m_error = _error;
+		return false;
+	}
+
+} // namespace mirror
+
+#endif
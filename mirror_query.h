@@ -0,0 +1,677 @@
+#pragma once
+
+//*****************************************************************************
+// mirror query - filtering arrays of reflected instances with runtime conditions
+//*****************************************************************************
+/*
+Parses conditions such as "health < 10 && (team == Red || !alive)" against a reflected
+class, and evaluates them over arrays of instances into selection bitmaps (bit i is set
+when instance i matches).
+
+Members are resolved and literals converted to the member types when parsing: numbers,
+true/false for bools, enum value names for enums, and quoted strings for std::string
+(== and != only). Each comparison is then evaluated column by column, 64 instances at a
+time: the member values are gathered into a contiguous block and compared with a branch
+free loop the compiler can vectorize, and the results are combined with bitwise operations.
+
+	mirror::Query query(mirror::GetClass<Entity>());
+	if (!query.parse("health < 10 && team == Red"))
+		printf("%s\n", query.getError());
+
+	std::vector<uint64_t> selection(mirror::Query::GetBitmapWordCount(entities.size()));
+	size_t matchCount = query.run(entities.data(), entities.size(), selection.data());
+
+Like mirror.h, the implementation is compiled in the file that defines MIRROR_IMPLEMENTATION.
+*/
+
+#include "mirror.h"
+
+namespace mirror {
+
+	class MIRROR_API Query
+	{
+	public:
+		Query(const Class* _class);
+
+		// Returns false and keeps the previous condition if the expression is invalid
+		bool parse(const char* _expression);
+		const char* getError() const { return m_error.c_str(); }
+		bool isValid() const { return !m_nodes.empty(); }
+
+		// _outBitmap must hold GetBitmapWordCount(_count) words. _stride defaults to the class size. Returns the number of matching instances.
+		size_t run(const void* _instances, size_t _count, uint64_t* _outBitmap, size_t _stride = 0) const;
+
+		static size_t GetBitmapWordCount(size_t _count) { return (_count + 63) / 64; }
+
+	// internal
+		enum Operator
+		{
+			Operator_Equal,
+			Operator_NotEqual,
+			Operator_Less,
+			Operator_LessEqual,
+			Operator_Greater,
+			Operator_GreaterEqual,
+		};
+
+		struct Predicate;
+		// Compares up to 64 instances and returns their bitmap word
+		typedef uint64_t (*PredicateKernel)(const Predicate& _predicate, const uint8_t* _instances, size_t _stride, size_t _count);
+
+		struct Predicate
+		{
+			size_t offset;
+			PredicateKernel kernel;
+			alignas(8) uint8_t constant[8]; // converted to the member type
+			std::string string; // string comparisons
+			const Sequence* sequence;
+		};
+
+		enum NodeKind
+		{
+			Node_Predicate,
+			Node_And,
+			Node_Or,
+			Node_Not,
+		};
+
+		struct Node
+		{
+			NodeKind kind;
+			size_t left; // node index, or predicate index
+			size_t right;
+		};
+
+		enum TokenKind
+		{
+			Token_End,
+			Token_Identifier,
+			Token_Number,
+			Token_String,
+			Token_And,
+			Token_Or,
+			Token_Not,
+			Token_OpenParenthesis,
+			Token_CloseParenthesis,
+			Token_Operator,
+		};
+
+		struct Token
+		{
+			TokenKind kind;
+			std::string text;
+			Operator op;
+		};
+
+		struct Parser
+		{
+			std::vector<Token> tokens;
+			size_t position = 0;
+			std::vector<Node> nodes;
+			std::vector<Predicate> predicates;
+			std::string error;
+		};
+
+		bool tokenize(const char* _expression, Parser& _parser) const;
+		bool parseOr(Parser& _parser, size_t& _outNode) const;
+		bool parseAnd(Parser& _parser, size_t& _outNode) const;
+		bool parseUnary(Parser& _parser, size_t& _outNode) const;
+		bool parseComparison(Parser& _parser, size_t& _outNode) const;
+		bool compilePredicate(const ClassMember* _member, Operator _op, const Token& _literal, Predicate& _outPredicate, std::string& _outError) const;
+		void evaluate(size_t _node, const uint8_t* _instances, size_t _stride, size_t _count, uint64_t* _outWords, uint64_t* _scratch) const;
+
+		const Class* m_class;
+		std::vector<Node> m_nodes; // the root is the last one
+		std::vector<Predicate> m_predicates;
+		size_t m_depth = 0;
+		std::string m_error;
+	};
+
+} // namespace mirror
+
+//*****************************************************************************
+// Implementation
+//*****************************************************************************
+
+#ifdef MIRROR_IMPLEMENTATION
+
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
+#include <limits>
+#include <bitset>
+#include <algorithm>
+
+namespace mirror {
+
+	namespace QueryKernels {
+
+		struct Equal { template <typename T> bool operator()(T _a, T _b) const { return _a == _b; } };
+		struct NotEqual { template <typename T> bool operator()(T _a, T _b) const { return _a != _b; } };
+		struct Less { template <typename T> bool operator()(T _a, T _b) const { return _a < _b; } };
+		struct LessEqual { template <typename T> bool operator()(T _a, T _b) const { return _a <= _b; } };
+		struct Greater { template <typename T> bool operator()(T _a, T _b) const { return _a > _b; } };
+		struct GreaterEqual { template <typename T> bool operator()(T _a, T _b) const { return _a >= _b; } };
+
+		template <typename T, typename Op>
+		uint64_t Compare(const Query::Predicate& _predicate, const uint8_t* _instances, size_t _stride, size_t _count)
+		{
+			T constant;
+			memcpy(&constant, _predicate.constant, sizeof(T));
+
+			// Gathering the column first keeps the comparison loop contiguous and branch free
+			T column[64];
+			const uint8_t* data = _instances + _predicate.offset;
+			for (size_t i = 0; i < _count; ++i)
+			{
+				memcpy(&column[i], data + i * _stride, sizeof(T));
+			}
+
+			uint64_t word = 0;
+			Op op;
+			for (size_t i = 0; i < _count; ++i)
+			{
+				word |= uint64_t(op(column[i], constant)) << i;
+			}
+			return word;
+		}
+
+		template <bool IsEqual>
+		uint64_t CompareString(const Query::Predicate& _predicate, const uint8_t* _instances, size_t _stride, size_t _count)
+		{
+			uint64_t word = 0;
+			for (size_t i = 0; i < _count; ++i)
+			{
+				SequenceSpan span = _predicate.sequence->getSpan(const_cast<uint8_t*>(_instances + i * _stride + _predicate.offset));
+				bool isEqual = span.count == _predicate.string.size() && (span.count == 0 || memcmp(span.data, _predicate.string.data(), span.count) == 0);
+				word |= uint64_t(isEqual == IsEqual) << i;
+			}
+			return word;
+		}
+
+		template <typename T>
+		Query::PredicateKernel Select(Query::Operator _op)
+		{
+			switch (_op)
+			{
+				case Query::Operator_Equal: return &Compare<T, Equal>;
+				case Query::Operator_NotEqual: return &Compare<T, NotEqual>;
+				case Query::Operator_Less: return &Compare<T, Less>;
+				case Query::Operator_LessEqual: return &Compare<T, LessEqual>;
+				case Query::Operator_Greater: return &Compare<T, Greater>;
+				case Query::Operator_GreaterEqual: return &Compare<T, GreaterEqual>;
+			}
+			return nullptr;
+		}
+
+		template <typename T>
+		bool ConvertInteger(const std::string& _text, uint8_t* _outConstant)
+		{
+			errno = 0;
+			char* end = nullptr;
+			T value;
+			if (std::is_signed<T>::value)
+			{
+				long long parsed = strtoll(_text.c_str(), &end, 0);
+				if (parsed < (long long)std::numeric_limits<T>::min() || parsed > (long long)std::numeric_limits<T>::max())
+					return false;
+				value = T(parsed);
+			}
+			else
+			{
+				if (_text[0] == '-')
+					return false;
+				unsigned long long parsed = strtoull(_text.c_str(), &end, 0);
+				if (parsed > (unsigned long long)std::numeric_limits<T>::max())
+					return false;
+				value = T(parsed);
+			}
+			if (errno != 0 || end == _text.c_str() || *end != 0)
+				return false;
+
+			memcpy(_outConstant, &value, sizeof(T));
+			return true;
+		}
+
+		template <typename T>
+		bool ConvertFloat(const std::string& _text, uint8_t* _outConstant)
+		{
+			char* end = nullptr;
+			T value = T(strtod(_text.c_str(), &end));
+			if (end == _text.c_str() || *end != 0)
+				return false;
+
+			memcpy(_outConstant, &value, sizeof(T));
+			return true;
+		}
+
+		template <typename T>
+		bool CompileInteger(Query::Operator _op, const std::string& _text, Query::Predicate& _outPredicate)
+		{
+			_outPredicate.kernel = Select<T>(_op);
+			return ConvertInteger<T>(_text, _outPredicate.constant);
+		}
+
+		template <typename T>
+		bool CompileFloat(Query::Operator _op, const std::string& _text, Query::Predicate& _outPredicate)
+		{
+			_outPredicate.kernel = Select<T>(_op);
+			return ConvertFloat<T>(_text, _outPredicate.constant);
+		}
+
+	} // namespace QueryKernels
+
+	Query::Query(const Class* _class)
+		: m_class(_class)
+	{
+		assert(_class != nullptr);
+	}
+
+	bool Query::parse(const char* _expression)
+	{
+		assert(_expression != nullptr);
+
+		Parser parser;
+		size_t root = 0;
+		bool success = tokenize(_expression, parser) && parseOr(parser, root);
+		if (success && parser.tokens[parser.position].kind != Token_End)
+		{
+			parser.error = "unexpected '" + parser.tokens[parser.position].text + "'";
+			success = false;
+		}
+		if (!success)
+		{
+			m_error = parser.error;
+			return false;
+		}
+
+		// Each nested binary node needs a scratch bitmap for its right operand
+		std::vector<size_t> depths(parser.nodes.size(), 0);
+		for (size_t i = 0; i < parser.nodes.size(); ++i)
+		{
+			const Node& node = parser.nodes[i];
+			if (node.kind == Node_And || node.kind == Node_Or)
+			{
+				depths[i] = std::max(depths[node.left], depths[node.right] + 1);
+			}
+			else if (node.kind == Node_Not)
+			{
+				depths[i] = depths[node.left];
+			}
+		}
+		assert(root == parser.nodes.size() - 1);
+
+		m_nodes = std::move(parser.nodes);
+		m_predicates = std::move(parser.predicates);
+		m_depth = depths[root];
+		m_error.clear();
+		return true;
+	}
+
+	size_t Query::run(const void* _instances, size_t _count, uint64_t* _outBitmap, size_t _stride) const
+	{
+		assert(isValid());
+		size_t stride = _stride != 0 ? _stride : m_class->getSize();
+		const uint8_t* instances = static_cast<const uint8_t*>(_instances);
+
+		// Instances are processed by blocks so that intermediate bitmaps stay in cache
+		const size_t BLOCK_WORD_COUNT = 16;
+		std::vector<uint64_t> scratch((m_depth + 1) * BLOCK_WORD_COUNT);
+		size_t matchCount = 0;
+		for (size_t begin = 0; begin < _count; begin += BLOCK_WORD_COUNT * 64)
+		{
+			size_t count = std::min(_count - begin, BLOCK_WORD_COUNT * 64);
+			uint64_t* words = _outBitmap + begin / 64;
+			evaluate(m_nodes.size() - 1, instances + begin * stride, stride, count, words, scratch.data());
+
+			size_t wordCount = GetBitmapWordCount(count);
+			if (count % 64 != 0)
+			{
+				words[wordCount - 1] &= (uint64_t(1) << (count % 64)) - 1;
+			}
+			for (size_t i = 0; i < wordCount; ++i)
+			{
+				matchCount += std::bitset<64>(words[i]).count();
+			}
+		}
+		return matchCount;
+	}
+
+	void Query::evaluate(size_t _node, const uint8_t* _instances, size_t _stride, size_t _count, uint64_t* _outWords, uint64_t* _scratch) const
+	{
+		const size_t BLOCK_WORD_COUNT = 16;
+		size_t wordCount = GetBitmapWordCount(_count);
+		const Node& node = m_nodes[_node];
+		switch (node.kind)
+		{
+			case Node_Predicate:
+			{
+				const Predicate& predicate = m_predicates[node.left];
+				for (size_t word = 0; word < wordCount; ++word)
+				{
+					size_t count = std::min<size_t>(64, _count - word * 64);
+					_outWords[word] = predicate.kernel(predicate, _instances + word * 64 * _stride, _stride, count);
+				}
+			}
+			break;
+
+			case Node_And:
+			case Node_Or:
+			{
+				evaluate(node.left, _instances, _stride, _count, _outWords, _scratch);
+				evaluate(node.right, _instances, _stride, _count, _scratch, _scratch + BLOCK_WORD_COUNT);
+				for (size_t word = 0; word < wordCount; ++word)
+				{
+					_outWords[word] = node.kind == Node_And ? _outWords[word] & _scratch[word] : _outWords[word] | _scratch[word];
+				}
+			}
+			break;
+
+			case Node_Not:
+			{
+				evaluate(node.left, _instances, _stride, _count, _outWords, _scratch);
+				for (size_t word = 0; word < wordCount; ++word)
+				{
+					_outWords[word] = ~_outWords[word];
+				}
+			}
+			break;
+		}
+	}
+
+	bool Query::tokenize(const char* _expression, Parser& _parser) const
+	{
+		const char* c = _expression;
+		while (true)
+		{
+			while (*c == ' ' || *c == '\t' || *c == '\n' || *c == '\r')
+			{
+				++c;
+			}
+
+			Token token = { Token_End, "", Operator_Equal };
+			const char* start = c;
+			if (*c == 0)
+			{
+				_parser.tokens.push_back(token);
+				return true;
+			}
+			else if (isalpha((unsigned char)*c) || *c == '_')
+			{
+				while (isalnum((unsigned char)*c) || *c == '_')
+				{
+					++c;
+				}
+				token.kind = Token_Identifier;
+			}
+			else if (isdigit((unsigned char)*c) || *c == '.' || (*c == '-' && (isdigit((unsigned char)c[1]) || c[1] == '.')))
+			{
+				++c;
+				while (isalnum((unsigned char)*c) || *c == '.' || ((*c == '-' || *c == '+') && (c[-1] == 'e' || c[-1] == 'E')))
+				{
+					++c;
+				}
+				token.kind = Token_Number;
+			}
+			else if (*c == '"')
+			{
+				++c;
+				while (*c != '"')
+				{
+					if (*c == 0)
+					{
+						_parser.error = "unterminated string";
+						return false;
+					}
+					token.text += *c++;
+				}
+				++c;
+				token.kind = Token_String;
+				_parser.tokens.push_back(token);
+				continue;
+			}
+			else if (c[0] == '&' && c[1] == '&') { c += 2; token.kind = Token_And; }
+			else if (c[0] == '|' && c[1] == '|') { c += 2; token.kind = Token_Or; }
+			else if (c[0] == '=' && c[1] == '=') { c += 2; token.kind = Token_Operator; token.op = Operator_Equal; }
+			else if (c[0] == '!' && c[1] == '=') { c += 2; token.kind = Token_Operator; token.op = Operator_NotEqual; }
+			else if (c[0] == '<' && c[1] == '=') { c += 2; token.kind = Token_Operator; token.op = Operator_LessEqual; }
+			else if (c[0] == '>' && c[1] == '=') { c += 2; token.kind = Token_Operator; token.op = Operator_GreaterEqual; }
+			else if (c[0] == '<') { c += 1; token.kind = Token_Operator; token.op = Operator_Less; }
+			else if (c[0] == '>') { c += 1; token.kind = Token_Operator; token.op = Operator_Greater; }
+			else if (c[0] == '!') { c += 1; token.kind = Token_Not; }
+			else if (c[0] == '(') { c += 1; token.kind = Token_OpenParenthesis; }
+			else if (c[0] == ')') { c += 1; token.kind = Token_CloseParenthesis; }
+			else
+			{
+				_parser.error = std::string("unexpected character '") + *c + "'";
+				return false;
+			}
+
+			token.text.assign(start, c);
+			_parser.tokens.push_back(token);
+		}
+	}
+
+	bool Query::parseOr(Parser& _parser, size_t& _outNode) const
+	{
+		if (!parseAnd(_parser, _outNode))
+			return false;
+
+		while (_parser.tokens[_parser.position].kind == Token_Or)
+		{
+			++_parser.position;
+			size_t right;
+			if (!parseAnd(_parser, right))
+				return false;
+
+			_parser.nodes.push_back({ Node_Or, _outNode, right });
+			_outNode = _parser.nodes.size() - 1;
+		}
+		return true;
+	}
+
+	bool Query::parseAnd(Parser& _parser, size_t& _outNode) const
+	{
+		if (!parseUnary(_parser, _outNode))
+			return false;
+
+		while (_parser.tokens[_parser.position].kind == Token_And)
+		{
+			++_parser.position;
+			size_t right;
+			if (!parseUnary(_parser, right))
+				return false;
+
+			_parser.nodes.push_back({ Node_And, _outNode, right });
+			_outNode = _parser.nodes.size() - 1;
+		}
+		return true;
+	}
+
+	bool Query::parseUnary(Parser& _parser, size_t& _outNode) const
+	{
+		const Token& token = _parser.tokens[_parser.position];
+		if (token.kind == Token_Not)
+		{
+			++_parser.position;
+			size_t operand;
+			if (!parseUnary(_parser, operand))
+				return false;
+
+			_parser.nodes.push_back({ Node_Not, operand, 0 });
+			_outNode = _parser.nodes.size() - 1;
+			return true;
+		}
+
+		if (token.kind == Token_OpenParenthesis)
+		{
+			++_parser.position;
+			if (!parseOr(_parser, _outNode))
+				return false;
+
+			if (_parser.tokens[_parser.position].kind != Token_CloseParenthesis)
+			{
+				_parser.error = "expected ')'";
+				return false;
+			}
+			++_parser.position;
+			return true;
+		}
+
+		return parseComparison(_parser, _outNode);
+	}
+
+	bool Query::parseComparison(Parser& _parser, size_t& _outNode) const
+	{
+		const Token& memberToken = _parser.tokens[_parser.position];
+		if (memberToken.kind != Token_Identifier)
+		{
+			_parser.error = memberToken.kind == Token_End ? "unexpected end of expression" : "expected a member name instead of '" + memberToken.text + "'";
+			return false;
+		}
+
+		const ClassMember* member = m_class->findMemberByName(memberToken.text.c_str());
+		if (member == nullptr)
+		{
+			_parser.error = "unknown member '" + memberToken.text + "'";
+			return false;
+		}
+
+		Predicate predicate = {};
+		const Token& operatorToken = _parser.tokens[_parser.position + 1];
+		if (operatorToken.kind != Token_Operator)
+		{
+			// A lone bool member is true when set
+			if (member->getType() == nullptr || member->getType()->getTypeInfo() != TypeInfo_bool)
+			{
+				_parser.error = "expected a comparison after '" + memberToken.text + "'";
+				return false;
+			}
+			Token literal = { Token_Identifier, "true", Operator_Equal };
+			if (!compilePredicate(member, Operator_Equal, literal, predicate, _parser.error))
+				return false;
+			_parser.position += 1;
+		}
+		else
+		{
+			const Token& literal = _parser.tokens[_parser.position + 2];
+			if (!compilePredicate(member, operatorToken.op, literal, predicate, _parser.error))
+				return false;
+			_parser.position += 3;
+		}
+
+		_parser.predicates.push_back(predicate);
+		_parser.nodes.push_back({ Node_Predicate, _parser.predicates.size() - 1, 0 });
+		_outNode = _parser.nodes.size() - 1;
+		return true;
+	}
+
+	bool Query::compilePredicate(const ClassMember* _member, Operator _op, const Token& _literal, Predicate& _outPredicate, std::string& _outError) const
+	{
+		using namespace QueryKernels;
+
+		_outPredicate.offset = _member->getOffset();
+		const Type* type = _member->getType();
+		if (type == nullptr)
+		{
+			_outError = std::string("member '") + _member->getName() + "' has no reflected type";
+			return false;
+		}
+
+		if (_literal.kind != Token_Number && _literal.kind != Token_Identifier && _literal.kind != Token_String)
+		{
+			_outError = std::string("expected a value after '") + _member->getName() + "'";
+			return false;
+		}
+
+		// Enums are compared as their underlying integers, value names are resolved now
+		std::string text = _literal.text;
+		TypeInfo typeInfo = type->getTypeInfo();
+		if (typeInfo == TypeInfo_Enum)
+		{
+			const Enum* enm = type->asEnum();
+			if (_literal.kind == Token_Identifier)
+			{
+				int64_t value;
+				if (!enm->getValueFromString(text.c_str(), value))
+				{
+					_outError = "'" + text + "' is not a value of " + enm->getName();
+					return false;
+				}
+				text = std::to_string(value);
+			}
+			typeInfo = enm->getSubType() != nullptr ? enm->getSubType()->getTypeInfo() : TypeInfo_none;
+		}
+		else if (typeInfo == TypeInfo_bool && _literal.kind == Token_Identifier)
+		{
+			if (text != "true" && text != "false")
+			{
+				_outError = "expected true or false instead of '" + text + "'";
+				return false;
+			}
+			text = text == "true" ? "1" : "0";
+		}
+		else if (typeInfo == TypeInfo_Sequence)
+		{
+			const Sequence* sequence = type->asSequence();
+			const Type* subType = sequence->getSubType();
+			if (subType == nullptr || subType->getTypeInfo() != TypeInfo_char || sequence->isFixedSize())
+			{
+				_outError = std::string("member '") + _member->getName() + "' can't be compared";
+				return false;
+			}
+			if (_op != Operator_Equal && _op != Operator_NotEqual)
+			{
+				_outError = "strings can only be compared with == and !=";
+				return false;
+			}
+			if (_literal.kind != Token_String)
+			{
+				_outError = std::string("expected a quoted string after '") + _member->getName() + "'";
+				return false;
+			}
+			_outPredicate.sequence = sequence;
+			_outPredicate.string = text;
+			_outPredicate.kernel = _op == Operator_Equal ? &CompareString<true> : &CompareString<false>;
+			return true;
+		}
+
+		if (typeInfo != TypeInfo_Enum && _literal.kind == Token_String)
+		{
+			_outError = std::string("member '") + _member->getName() + "' is not a string";
+			return false;
+		}
+
+		bool converted = false;
+		switch (typeInfo)
+		{
+			case TypeInfo_bool: converted = (text == "0" || text == "1") && CompileInteger<uint8_t>(_op, text, _outPredicate); break;
+			case TypeInfo_uint8: converted = CompileInteger<uint8_t>(_op, text, _outPredicate); break;
+			case TypeInfo_uint16: converted = CompileInteger<uint16_t>(_op, text, _outPredicate); break;
+			case TypeInfo_uint32: converted = CompileInteger<uint32_t>(_op, text, _outPredicate); break;
+			case TypeInfo_uint64: converted = CompileInteger<uint64_t>(_op, text, _outPredicate); break;
+			case TypeInfo_char:
+			case TypeInfo_int8: converted = CompileInteger<int8_t>(_op, text, _outPredicate); break;
+			case TypeInfo_int16: converted = CompileInteger<int16_t>(_op, text, _outPredicate); break;
+			case TypeInfo_int32: converted = CompileInteger<int32_t>(_op, text, _outPredicate); break;
+			case TypeInfo_int64: converted = CompileInteger<int64_t>(_op, text, _outPredicate); break;
+			case TypeInfo_float: converted = CompileFloat<float>(_op, text, _outPredicate); break;
+			case TypeInfo_double: converted = CompileFloat<double>(_op, text, _outPredicate); break;
+
+			default:
+				_outError = std::string("member '") + _member->getName() + "' can't be compared";
+				return false;
+		}
+
+		if (!converted)
+		{
+			_outError = "'" + _literal.text + "' is not a valid value for '" + _member->getName() + "'";
+			return false;
+		}
+		return true;
+	}
+
+} // namespace mirror
+
+#endif
@@ -0,0 +1,533 @@
+#pragma once
+
+//*****************************************************************************
+// mirror snapshot - ring buffer of snapshots of reflected objects
+//*****************************************************************************
+/*
+Periodically captures a set of reflected root objects into a ring buffer of fixed size, and
+restores any retained point in time. Every few captures a keyframe stores the whole state,
+the captures in between only store what changed since the previous capture. When the ring
+is full, the oldest keyframe is evicted with the captures that depend on it.
+
+The state of the roots is flattened once into byte ranges, using member offsets and type
+sizes: trivially copyable types are captured as a whole, other classes member by member.
+Changes are found by comparing these ranges with a shadow copy of the last capture in
+blocks of 16 bytes. Dynamic sequences of trivially copyable elements (std::vector<float>,
+std::string...) are captured whole when they change. Other members (containers of strings,
+maps...) are not captured. The shadow copy is allocated on top of the ring.
+
+	mirror::SnapshotRing ring(64 * 1024 * 1024);
+	ring.addRoot(&world);
+	ring.addRoot(&camera);
+
+	uint64_t snapshot = ring.capture(); // every tick
+	...
+	ring.restore(snapshot);
+	ring.discardAfter(snapshot); // to branch from the restored point
+
+Like mirror.h, the implementation is compiled in the file that defines MIRROR_IMPLEMENTATION.
+*/
+
+#include "mirror.h"
+
+#include <deque>
+
+namespace mirror {
+
+	class MIRROR_API SnapshotRing
+	{
+	public:
+		SnapshotRing(size_t _capacity, uint32_t _keyframeInterval = 32);
+
+		// Roots must outlive the ring, adding one clears the snapshots
+		void addRoot(const Type* _type, void* _instance);
+		template <typename T> void addRoot(T* _instance) { addRoot(GetType<T>(), _instance); }
+
+		// Returns the snapshot id, 0 if a keyframe doesn't fit in the ring
+		uint64_t capture();
+		// Returns false if the snapshot is not retained anymore
+		bool restore(uint64_t _snapshot);
+		// Removes the snapshots captured after _snapshot, the next capture follows it
+		bool discardAfter(uint64_t _snapshot);
+		void clear();
+
+		bool isRetained(uint64_t _snapshot) const;
+		uint64_t getOldestSnapshot() const { return m_entries.empty() ? 0 : m_entries.front().id; }
+		uint64_t getNewestSnapshot() const { return m_entries.empty() ? 0 : m_entries.back().id; }
+		size_t getSnapshotCount() const { return m_entries.size(); }
+		size_t getCapacity() const { return m_ring.size(); }
+		size_t getUsedSize() const;
+
+	// internal
+		struct Range
+		{
+			uint8_t* data;
+			size_t size;
+			size_t imageOffset;
+		};
+
+		struct Blob
+		{
+			void* sequence;
+			const Sequence* type;
+			size_t elementSize;
+		};
+
+		struct Entry
+		{
+			uint64_t id;
+			size_t offset;
+			size_t size;
+			bool isKeyframe;
+		};
+
+		void collect(const Type* _type, uint8_t* _data);
+		void encodeKeyframe(std::vector<uint8_t>& _out) const;
+		void encodeDelta(std::vector<uint8_t>& _out) const;
+		void updateShadow(const std::vector<uint8_t>& _data, bool _isKeyframe);
+		bool allocate(size_t _size, bool _canEvictNewest, size_t& _outOffset);
+		void evictOldestGroup();
+		bool reconstruct(uint64_t _snapshot, std::vector<uint8_t>& _outImage, std::vector<std::vector<uint8_t>>& _outBlobs) const;
+		void apply(const uint8_t* _data, size_t _size, bool _isKeyframe, std::vector<uint8_t>& _image, std::vector<std::vector<uint8_t>>& _blobs) const;
+
+		std::vector<Range> m_ranges;
+		std::vector<Blob> m_blobs;
+		size_t m_imageSize = 0;
+
+		// State of the newest snapshot
+		std::vector<uint8_t> m_shadowImage;
+		std::vector<std::vector<uint8_t>> m_shadowBlobs;
+
+		std::vector<uint8_t> m_ring;
+		std::deque<Entry> m_entries;
+		std::vector<uint8_t> m_scratch;
+		uint32_t m_keyframeInterval;
+		uint32_t m_capturesSinceKeyframe = 0;
+		uint64_t m_nextId = 1;
+	};
+
+} // namespace mirror
+
+//*****************************************************************************
+// Implementation
+//*****************************************************************************
+
+#ifdef MIRROR_IMPLEMENTATION
+
+#include <cstring>
+#include <algorithm>
+
+namespace mirror {
+
+	namespace Snapshot {
+
+		static const size_t s_blockSize = 16;
+
+		template <typename T>
+		void Append(std::vector<uint8_t>& _out, T _value)
+		{
+			size_t offset = _out.size();
+			_out.resize(offset + sizeof(T));
+			memcpy(_out.data() + offset, &_value, sizeof(T));
+		}
+
+		template <typename T>
+		T Read(const uint8_t*& _data)
+		{
+			T value;
+			memcpy(&value, _data, sizeof(T));
+			_data += sizeof(T);
+			return value;
+		}
+
+	} // namespace Snapshot
+
+	SnapshotRing::SnapshotRing(size_t _capacity, uint32_t _keyframeInterval)
+		: m_ring(_capacity)
+		, m_keyframeInterval(std::max<uint32_t>(_keyframeInterval, 1))
+	{
+	}
+
+	void SnapshotRing::addRoot(const Type* _type, void* _instance)
+	{
+		assert(_type != nullptr && _instance != nullptr);
+		clear();
+		collect(_type, static_cast<uint8_t*>(_instance));
+		m_shadowImage.resize(m_imageSize);
+		m_shadowBlobs.resize(m_blobs.size());
+	}
+
+	uint64_t SnapshotRing::capture()
+	{
+		// Deltas follow the newest snapshot, a keyframe is needed when there is none
+		bool isKeyframe = m_entries.empty() || m_capturesSinceKeyframe + 1 >= m_keyframeInterval;
+		if (isKeyframe)
+		{
+			encodeKeyframe(m_scratch);
+		}
+		else
+		{
+			encodeDelta(m_scratch);
+		}
+
+		size_t offset;
+		if (!allocate(m_scratch.size(), isKeyframe, offset))
+		{
+			// The delta doesn't fit without evicting the snapshots it depends on
+			isKeyframe = true;
+			encodeKeyframe(m_scratch);
+			if (!allocate(m_scratch.size(), true, offset))
+			{
+				assert(false && "the ring is too small for a keyframe");
+				return 0;
+			}
+		}
+
+		if (!m_scratch.empty())
+		{
+			memcpy(m_ring.data() + offset, m_scratch.data(), m_scratch.size());
+		}
+		updateShadow(m_scratch, isKeyframe);
+		m_capturesSinceKeyframe = isKeyframe ? 0 : m_capturesSinceKeyframe + 1;
+
+		Entry entry = { m_nextId++, offset, m_scratch.size(), isKeyframe };
+		m_entries.push_back(entry);
+		return entry.id;
+	}
+
+	bool SnapshotRing::restore(uint64_t _snapshot)
+	{
+		std::vector<uint8_t> image;
+		std::vector<std::vector<uint8_t>> blobs;
+		if (!reconstruct(_snapshot, image, blobs))
+			return false;
+
+		for (const Range& range : m_ranges)
+		{
+			memcpy(range.data, image.data() + range.imageOffset, range.size);
+		}
+		for (size_t i = 0; i < m_blobs.size(); ++i)
+		{
+			const Blob& blob = m_blobs[i];
+			size_t count = blobs[i].size() / blob.elementSize;
+			blob.type->resize(blob.sequence, count);
+			if (count > 0)
+			{
+				memcpy(blob.type->getData(blob.sequence), blobs[i].data(), blobs[i].size());
+			}
+		}
+		return true;
+	}
+
+	bool SnapshotRing::discardAfter(uint64_t _snapshot)
+	{
+		if (!isRetained(_snapshot))
+			return false;
+
+		if (_snapshot != getNewestSnapshot())
+		{
+			reconstruct(_snapshot, m_shadowImage, m_shadowBlobs);
+			while (m_entries.back().id != _snapshot)
+			{
+				m_entries.pop_back();
+			}
+
+			m_capturesSinceKeyframe = 0;
+			for (auto it = m_entries.rbegin(); !it->isKeyframe; ++it)
+			{
+				++m_capturesSinceKeyframe;
+			}
+		}
+		m_nextId = _snapshot + 1;
+		return true;
+	}
+
+	void SnapshotRing::clear()
+	{
+		m_entries.clear();
+		m_capturesSinceKeyframe = 0;
+	}
+
+	bool SnapshotRing::isRetained(uint64_t _snapshot) const
+	{
+		return !m_entries.empty() && _snapshot >= m_entries.front().id && _snapshot <= m_entries.back().id;
+	}
+
+	size_t SnapshotRing::getUsedSize() const
+	{
+		size_t size = 0;
+		for (const Entry& entry : m_entries)
+		{
+			size += entry.size;
+		}
+		return size;
+	}
+
+	void SnapshotRing::collect(const Type* _type, uint8_t* _data)
+	{
+		if (_type == nullptr)
+			return;
+
+		if (_type->isTriviallyCopyable())
+		{
+			// Contiguous ranges are merged
+			if (!m_ranges.empty() && m_ranges.back().data + m_ranges.back().size == _data)
+			{
+				m_ranges.back().size += _type->getSize();
+			}
+			else
+			{
+				m_ranges.push_back({ _data, _type->getSize(), m_imageSize });
+			}
+			m_imageSize += _type->getSize();
+			return;
+		}
+
+		switch (_type->getTypeInfo())
+		{
+			case TypeInfo_Class:
+			{
+				for (ClassMember* member : _type->asClass()->getMembers())
+				{
+					collect(member->getType(), _data + member->getOffset());
+				}
+			}
+			break;
+
+			case TypeInfo_FixedSizeArray:
+			{
+				const FixedSizeArray* fixedSizeArray = _type->asFixedSizeArray();
+				const Type* subType = fixedSizeArray->getSubType();
+				for (size_t i = 0; subType != nullptr && i < fixedSizeArray->getElementCount(); ++i)
+				{
+					collect(subType, _data + i * subType->getSize());
+				}
+			}
+			break;
+
+			case TypeInfo_Sequence:
+			{
+				const Sequence* sequence = _type->asSequence();
+				const Type* subType = sequence->getSubType();
+				if (subType == nullptr)
+					break;
+
+				if (sequence->isFixedSize())
+				{
+					for (size_t i = 0; i < sequence->getFixedCount(); ++i)
+					{
+						collect(subType, _data + i * sequence->getElementStride());
+					}
+				}
+				else if (subType->isTriviallyCopyable() && subType->getSize() == sequence->getElementStride() && sequence->m_functions.resize != nullptr)
+				{
+					m_blobs.push_back({ _data, sequence, subType->getSize() });
+				}
+			}
+			break;
+
+			default:
+				break;
+		}
+	}
+
+	// Keyframe: the whole image, then the size and bytes of every blob
+	void SnapshotRing::encodeKeyframe(std::vector<uint8_t>& _out) const
+	{
+		_out.resize(m_imageSize);
+		for (const Range& range : m_ranges)
+		{
+			memcpy(_out.data() + range.imageOffset, range.data, range.size);
+		}
+
+		for (const Blob& blob : m_blobs)
+		{
+			size_t size = blob.type->getCount(blob.sequence) * blob.elementSize;
+			Snapshot::Append<uint64_t>(_out, size);
+			const uint8_t* data = static_cast<const uint8_t*>(blob.type->getData(blob.sequence));
+			_out.insert(_out.end(), data, data + size);
+		}
+	}
+
+	// Delta: the changed runs of the image (offset, size, bytes), then the changed blobs (index, size, bytes)
+	void SnapshotRing::encodeDelta(std::vector<uint8_t>& _out) const
+	{
+		using namespace Snapshot;
+
+		_out.clear();
+		Append<uint32_t>(_out, 0);
+		uint32_t runCount = 0;
+		for (const Range& range : m_ranges)
+		{
+			const uint8_t* shadow = m_shadowImage.data() + range.imageOffset;
+			if (memcmp(range.data, shadow, range.size) == 0)
+				continue;
+
+			// Consecutive changed blocks make a run
+			size_t runStart = SIZE_MAX;
+			for (size_t offset = 0; offset < range.size + s_blockSize; offset += s_blockSize)
+			{
+				bool isChanged = offset < range.size && memcmp(range.data + offset, shadow + offset, std::min(s_blockSize, range.size - offset)) != 0;
+				if (isChanged && runStart == SIZE_MAX)
+				{
+					runStart = offset;
+				}
+				else if (!isChanged && runStart != SIZE_MAX)
+				{
+					size_t runEnd = std::min(offset, range.size);
+					Append<uint64_t>(_out, range.imageOffset + runStart);
+					Append<uint64_t>(_out, runEnd - runStart);
+					_out.insert(_out.end(), range.data + runStart, range.data + runEnd);
+					runStart = SIZE_MAX;
+					++runCount;
+				}
+			}
+		}
+		memcpy(_out.data(), &runCount, sizeof(runCount));
+
+		size_t blobCountOffset = _out.size();
+		Append<uint32_t>(_out, 0);
+		uint32_t blobCount = 0;
+		for (size_t i = 0; i < m_blobs.size(); ++i)
+		{
+			const Blob& blob = m_blobs[i];
+			size_t size = blob.type->getCount(blob.sequence) * blob.elementSize;
+			const uint8_t* data = static_cast<const uint8_t*>(blob.type->getData(blob.sequence));
+			const std::vector<uint8_t>& shadow = m_shadowBlobs[i];
+			if (size == shadow.size() && (size == 0 || memcmp(data, shadow.data(), size) == 0))
+				continue;
+
+			Append<uint32_t>(_out, uint32_t(i));
+			Append<uint64_t>(_out, size);
+			_out.insert(_out.end(), data, data + size);
+			++blobCount;
+		}
+		memcpy(_out.data() + blobCountOffset, &blobCount, sizeof(blobCount));
+	}
+
+	void SnapshotRing::updateShadow(const std::vector<uint8_t>& _data, bool _isKeyframe)
+	{
+		apply(_data.data(), _data.size(), _isKeyframe, m_shadowImage, m_shadowBlobs);
+	}
+
+	void SnapshotRing::apply(const uint8_t* _data, size_t _size, bool _isKeyframe, std::vector<uint8_t>& _image, std::vector<std::vector<uint8_t>>& _blobs) const
+	{
+		using namespace Snapshot;
+
+		_image.resize(m_imageSize);
+		_blobs.resize(m_blobs.size());
+		const uint8_t* data = _data;
+		if (_isKeyframe)
+		{
+			if (m_imageSize > 0)
+			{
+				memcpy(_image.data(), data, m_imageSize);
+			}
+			data += m_imageSize;
+			for (std::vector<uint8_t>& blob : _blobs)
+			{
+				size_t size = size_t(Read<uint64_t>(data));
+				blob.assign(data, data + size);
+				data += size;
+			}
+		}
+		else
+		{
+			uint32_t runCount = Read<uint32_t>(data);
+			for (uint32_t i = 0; i < runCount; ++i)
+			{
+				size_t offset = size_t(Read<uint64_t>(data));
+				size_t size = size_t(Read<uint64_t>(data));
+				memcpy(_image.data() + offset, data, size);
+				data += size;
+			}
+
+			uint32_t blobCount = Read<uint32_t>(data);
+			for (uint32_t i = 0; i < blobCount; ++i)
+			{
+				uint32_t index = Read<uint32_t>(data);
+				size_t size = size_t(Read<uint64_t>(data));
+				_blobs[index].assign(data, data + size);
+				data += size;
+			}
+		}
+		assert(data == _data + _size);
+	}
+
+	bool SnapshotRing::reconstruct(uint64_t _snapshot, std::vector<uint8_t>& _outImage, std::vector<std::vector<uint8_t>>& _outBlobs) const
+	{
+		if (!isRetained(_snapshot))
+			return false;
+
+		// The oldest snapshot is always a keyframe
+		size_t last = size_t(_snapshot - m_entries.front().id);
+		size_t first = last;
+		while (!m_entries[first].isKeyframe)
+		{
+			--first;
+		}
+
+		for (size_t i = first; i <= last; ++i)
+		{
+			const Entry& entry = m_entries[i];
+			apply(m_ring.data() + entry.offset, entry.size, entry.isKeyframe, _outImage, _outBlobs);
+		}
+		return true;
+	}
+
+	bool SnapshotRing::allocate(size_t _size, bool _canEvictNewest, size_t& _outOffset)
+	{
+		if (_size > m_ring.size())
+			return false;
+
+		while (!m_entries.empty())
+		{
+			const Entry& oldest = m_entries.front();
+			const Entry& newest = m_entries.back();
+			size_t end = newest.offset + newest.size;
+			if (newest.offset >= oldest.offset)
+			{
+				// Used space is [oldest, end), free space is after it and before it
+				if (m_ring.size() - end >= _size)
+				{
+					_outOffset = end;
+					return true;
+				}
+				if (oldest.offset >= _size)
+				{
+					_outOffset = 0;
+					return true;
+				}
+			}
+			else if (oldest.offset - end >= _size)
+			{
+				// Used space wraps around, free space is [end, oldest)
+				_outOffset = end;
+				return true;
+			}
+
+			// The group of the newest snapshot can only be evicted for a keyframe
+			bool isNewestGroup = std::find_if(m_entries.begin() + 1, m_entries.end(), [](const Entry& _entry) { return _entry.isKeyframe; }) == m_entries.end();
+			if (isNewestGroup && !_canEvictNewest)
+				return false;
+
+			evictOldestGroup();
+		}
+
+		_outOffset = 0;
+		return true;
+	}
+
+	void SnapshotRing::evictOldestGroup()
+	{
+		assert(!m_entries.empty() && m_entries.front().isKeyframe);
+		m_entries.pop_front();
+		while (!m_entries.empty() && !m_entries.front().isKeyframe)
+		{
+			m_entries.pop_front();
+		}
+	}
+
+} // namespace mirror
+
+#endif
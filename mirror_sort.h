@@ -0,0 +1,433 @@
+#pragma once
+
+//*****************************************************************************
+// mirror sort - sorting arrays of reflected instances by member keys
+//*****************************************************************************
+/*
+Sorts arrays of instances of a reflected class by one or more members chosen at runtime.
+Members are resolved once, when the keys are added, and keys are then read directly at
+their offsets.
+
+When every key is a number (integers, floats, bools, chars and enums), keys are turned
+into order preserving unsigned integers and sorted with an LSD radix sort, one byte per
+pass, least significant key first. Sequences of numbers (such as std::string and
+std::vector<int>) are compared lexicographically with a stable comparison sort instead.
+Both sorts are stable, and are split across threads for large inputs.
+
+	mirror::InstanceSorter sorter(mirror::GetClass<Row>());
+	sorter.addKey("team");
+	sorter.addKey("score", true); // descending
+	sorter.sort(rows.data(), rows.size());
+
+Floats are ordered by their bits: -0.0 comes before 0.0 and NaNs go to the ends.
+
+Like mirror.h, the implementation is compiled in the file that defines MIRROR_IMPLEMENTATION.
+*/
+
+#include "mirror.h"
+
+namespace mirror {
+
+	class MIRROR_API InstanceSorter
+	{
+	public:
+		InstanceSorter(const Class* _class);
+
+		// Keys are sorted in the order they are added. Returns false if the member is not found or its type can't be sorted.
+		bool addKey(const char* _memberName, bool _descending = false);
+		bool addKey(const ClassMember* _member, bool _descending = false);
+		void clearKeys();
+
+		void setThreadCount(size_t _threadCount); // 0 uses the hardware concurrency
+		void setParallelThreshold(size_t _count); // inputs smaller than this are sorted on the calling thread
+
+		// Fills _outIndices with the indices of the instances in sorted order. _stride defaults to the class size.
+		void sortIndices(const void* _instances, size_t _count, uint32_t* _outIndices, size_t _stride = 0) const;
+		// Reorders a contiguous array of instances
+		void sort(void* _instances, size_t _count) const;
+
+	// internal
+		enum KeyKind
+		{
+			KeyKind_Unsigned,
+			KeyKind_Signed,
+			KeyKind_Float,
+			KeyKind_Sequence,
+		};
+
+		struct Key
+		{
+			size_t offset;
+			KeyKind kind;
+			size_t size; // scalar size, or element size of sequences
+			KeyKind elementKind; // sequences only
+			const Sequence* sequence;
+			bool descending;
+		};
+
+		struct KeyedIndex
+		{
+			uint64_t key;
+			uint32_t index;
+		};
+
+		static bool GetScalarKind(const Type* _type, KeyKind& _outKind);
+		static uint64_t EncodeScalar(const void* _data, size_t _size, KeyKind _kind);
+		int compare(const uint8_t* _a, const uint8_t* _b) const;
+		void radixSort(const Key& _key, const uint8_t* _instances, size_t _stride, uint32_t* _indices, size_t _count) const;
+		void comparisonSort(const uint8_t* _instances, size_t _stride, uint32_t* _indices, size_t _count) const;
+		size_t getThreadCount(size_t _count) const;
+
+		const Class* m_class;
+		std::vector<Key> m_keys;
+		size_t m_threadCount = 0;
+		size_t m_parallelThreshold = 1 << 16;
+	};
+
+} // namespace mirror
+
+//*****************************************************************************
+// Implementation
+//*****************************************************************************
+
+#ifdef MIRROR_IMPLEMENTATION
+
+#include <cstring>
+#include <algorithm>
+#include <thread>
+
+namespace mirror {
+
+	InstanceSorter::InstanceSorter(const Class* _class)
+		: m_class(_class)
+	{
+		assert(_class != nullptr);
+	}
+
+	bool InstanceSorter::addKey(const char* _memberName, bool _descending)
+	{
+		return addKey(m_class->findMemberByName(_memberName), _descending);
+	}
+
+	bool InstanceSorter::addKey(const ClassMember* _member, bool _descending)
+	{
+		if (_member == nullptr || _member->getType() == nullptr)
+			return false;
+		assert(m_class->isChildOf(_member->getOwnerClass()));
+
+		Key key = {};
+		key.offset = _member->getOffset();
+		key.descending = _descending;
+
+		const Type* type = _member->getType();
+		if (GetScalarKind(type, key.kind))
+		{
+			key.size = type->getSize();
+		}
+		else if (type->getTypeInfo() == TypeInfo_Sequence)
+		{
+			key.kind = KeyKind_Sequence;
+			key.sequence = type->asSequence();
+			key.size = key.sequence->getElementStride();
+			if (!GetScalarKind(key.sequence->getSubType(), key.elementKind))
+				return false;
+		}
+		else
+		{
+			return false;
+		}
+
+		m_keys.push_back(key);
+		return true;
+	}
+
+	void InstanceSorter::clearKeys()
+	{
+		m_keys.clear();
+	}
+
+	void InstanceSorter::setThreadCount(size_t _threadCount)
+	{
+		m_threadCount = _threadCount;
+	}
+
+	void InstanceSorter::setParallelThreshold(size_t _count)
+	{
+		m_parallelThreshold = _count;
+	}
+
+	void InstanceSorter::sortIndices(const void* _instances, size_t _count, uint32_t* _outIndices, size_t _stride) const
+	{
+		assert(_count <= UINT32_MAX);
+		size_t stride = _stride != 0 ? _stride : m_class->getSize();
+		const uint8_t* instances = static_cast<const uint8_t*>(_instances);
+
+		for (size_t i = 0; i < _count; ++i)
+		{
+			_outIndices[i] = uint32_t(i);
+		}
+		if (_count < 2 || m_keys.empty())
+			return;
+
+		bool canRadixSort = true;
+		for (const Key& key : m_keys)
+		{
+			canRadixSort = canRadixSort && key.kind != KeyKind_Sequence;
+		}
+
+		if (canRadixSort)
+		{
+			// Least significant key first, each pass being stable
+			for (size_t i = m_keys.size(); i > 0; --i)
+			{
+				radixSort(m_keys[i - 1], instances, stride, _outIndices, _count);
+			}
+		}
+		else
+		{
+			comparisonSort(instances, stride, _outIndices, _count);
+		}
+	}
+
+	void InstanceSorter::sort(void* _instances, size_t _count) const
+	{
+		std::vector<uint32_t> indices(_count);
+		sortIndices(_instances, _count, indices.data());
+
+		size_t stride = m_class->getSize();
+		uint8_t* instances = static_cast<uint8_t*>(_instances);
+		uint8_t* sorted = static_cast<uint8_t*>(::operator new(_count * stride, std::align_val_t(m_class->getAlignment())));
+		if (m_class->isTriviallyCopyable())
+		{
+			for (size_t i = 0; i < _count; ++i)
+			{
+				memcpy(sorted + i * stride, instances + size_t(indices[i]) * stride, stride);
+			}
+			memcpy(instances, sorted, _count * stride);
+		}
+		else
+		{
+			assert(m_class->isCopyConstructible());
+			for (size_t i = 0; i < _count; ++i)
+			{
+				m_class->copyConstruct(sorted + i * stride, instances + size_t(indices[i]) * stride);
+			}
+			m_class->destruct(instances, _count);
+			m_class->copyConstruct(instances, sorted, _count);
+			m_class->destruct(sorted, _count);
+		}
+		::operator delete(sorted, std::align_val_t(m_class->getAlignment()));
+	}
+
+	bool InstanceSorter::GetScalarKind(const Type* _type, KeyKind& _outKind)
+	{
+		if (_type == nullptr)
+			return false;
+
+		switch (_type->getTypeInfo())
+		{
+			case TypeInfo_bool:
+			case TypeInfo_uint8:
+			case TypeInfo_uint16:
+			case TypeInfo_uint32:
+			case TypeInfo_uint64:
+				_outKind = KeyKind_Unsigned;
+				return true;
+
+			case TypeInfo_char:
+				_outKind = std::is_signed<char>::value ? KeyKind_Signed : KeyKind_Unsigned;
+				return true;
+
+			case TypeInfo_int8:
+			case TypeInfo_int16:
+			case TypeInfo_int32:
+			case TypeInfo_int64:
+				_outKind = KeyKind_Signed;
+				return true;
+
+			case TypeInfo_float:
+			case TypeInfo_double:
+				_outKind = KeyKind_Float;
+				return true;
+
+			case TypeInfo_Enum:
+				return GetScalarKind(_type->asEnum()->getSubType(), _outKind);
+
+			default:
+				return false;
+		}
+	}
+
+	uint64_t InstanceSorter::EncodeScalar(const void* _data, size_t _size, KeyKind _kind)
+	{
+		uint64_t value = 0;
+		switch (_size)
+		{
+			case 1: { uint8_t v; memcpy(&v, _data, 1); value = v; } break;
+			case 2: { uint16_t v; memcpy(&v, _data, 2); value = v; } break;
+			case 4: { uint32_t v; memcpy(&v, _data, 4); value = v; } break;
+			case 8: { uint64_t v; memcpy(&v, _data, 8); value = v; } break;
+			default: assert(false); break;
+		}
+
+		// Order preserving unsigned representation
+		uint64_t signBit = uint64_t(1) << (_size * 8 - 1);
+		uint64_t mask = signBit | (signBit - 1);
+		if (_kind == KeyKind_Signed)
+		{
+			value ^= signBit;
+		}
+		else if (_kind == KeyKind_Float)
+		{
+			value = (value & signBit) != 0 ? ~value & mask : value | signBit;
+		}
+		return value;
+	}
+
+	int InstanceSorter::compare(const uint8_t* _a, const uint8_t* _b) const
+	{
+		for (const Key& key : m_keys)
+		{
+			int result = 0;
+			if (key.kind != KeyKind_Sequence)
+			{
+				uint64_t a = EncodeScalar(_a + key.offset, key.size, key.kind);
+				uint64_t b = EncodeScalar(_b + key.offset, key.size, key.kind);
+				result = a < b ? -1 : (a > b ? 1 : 0);
+			}
+			else
+			{
+				SequenceSpan a = key.sequence->getSpan(const_cast<uint8_t*>(_a + key.offset));
+				SequenceSpan b = key.sequence->getSpan(const_cast<uint8_t*>(_b + key.offset));
+				size_t count = std::min(a.count, b.count);
+				for (size_t i = 0; i < count && result == 0; ++i)
+				{
+					uint64_t elementA = EncodeScalar(a.at(i), key.size, key.elementKind);
+					uint64_t elementB = EncodeScalar(b.at(i), key.size, key.elementKind);
+					result = elementA < elementB ? -1 : (elementA > elementB ? 1 : 0);
+				}
+				if (result == 0)
+				{
+					result = a.count < b.count ? -1 : (a.count > b.count ? 1 : 0);
+				}
+			}
+
+			if (result != 0)
+				return key.descending ? -result : result;
+		}
+		return 0;
+	}
+
+	void InstanceSorter::radixSort(const Key& _key, const uint8_t* _instances, size_t _stride, uint32_t* _indices, size_t _count) const
+	{
+		const size_t RADIX = 256;
+		size_t threadCount = getThreadCount(_count);
+		size_t chunkSize = (_count + threadCount - 1) / threadCount;
+
+		std::vector<KeyedIndex> items(_count);
+		std::vector<KeyedIndex> buffer(_count);
+		uint64_t descendingMask = _key.descending ? ~uint64_t(0) : 0;
+		RunParallel(threadCount, [&](size_t _thread)
+		{
+			size_t end = std::min(_count, (_thread + 1) * chunkSize);
+			for (size_t i = _thread * chunkSize; i < end; ++i)
+			{
+				uint32_t index = _indices[i];
+				items[i].key = EncodeScalar(_instances + size_t(index) * _stride + _key.offset, _key.size, _key.kind) ^ descendingMask;
+				items[i].index = index;
+			}
+		}, threadCount);
+
+		// Each thread counts the digits of its chunk, then scatters it to its own range of each digit bucket, which keeps the sort stable
+		std::vector<size_t> histograms(threadCount * RADIX);
+		for (size_t byte = 0; byte < _key.size; ++byte)
+		{
+			size_t shift = byte * 8;
+			std::fill(histograms.begin(), histograms.end(), 0);
+			RunParallel(threadCount, [&](size_t _thread)
+			{
+				size_t* histogram = histograms.data() + _thread * RADIX;
+				size_t end = std::min(_count, (_thread + 1) * chunkSize);
+				for (size_t i = _thread * chunkSize; i < end; ++i)
+				{
+					++histogram[(items[i].key >> shift) & 0xff];
+				}
+			}, threadCount);
+
+			size_t offset = 0;
+			bool isSingleDigit = false;
+			for (size_t digit = 0; digit < RADIX; ++digit)
+			{
+				size_t digitStart = offset;
+				for (size_t thread = 0; thread < threadCount; ++thread)
+				{
+					size_t count = histograms[thread * RADIX + digit];
+					histograms[thread * RADIX + digit] = offset;
+					offset += count;
+				}
+				isSingleDigit = isSingleDigit || offset - digitStart == _count;
+			}
+			if (isSingleDigit)
+				continue;
+
+			RunParallel(threadCount, [&](size_t _thread)
+			{
+				size_t* offsets = histograms.data() + _thread * RADIX;
+				size_t end = std::min(_count, (_thread + 1) * chunkSize);
+				for (size_t i = _thread * chunkSize; i < end; ++i)
+				{
+					buffer[offsets[(items[i].key >> shift) & 0xff]++] = items[i];
+				}
+			}, threadCount);
+			items.swap(buffer);
+		}
+
+		for (size_t i = 0; i < _count; ++i)
+		{
+			_indices[i] = items[i].index;
+		}
+	}
+
+	void InstanceSorter::comparisonSort(const uint8_t* _instances, size_t _stride, uint32_t* _indices, size_t _count) const
+	{
+		auto less = [&](uint32_t _a, uint32_t _b)
+		{
+			return compare(_instances + size_t(_a) * _stride, _instances + size_t(_b) * _stride) < 0;
+		};
+
+		// Chunks are sorted in parallel, then merged two by two
+		size_t threadCount = getThreadCount(_count);
+		size_t chunkSize = (_count + threadCount - 1) / threadCount;
+		RunParallel(threadCount, [&](size_t _thread)
+		{
+			size_t begin = std::min(_count, _thread * chunkSize);
+			size_t end = std::min(_count, begin + chunkSize);
+			std::stable_sort(_indices + begin, _indices + end, less);
+		}, threadCount);
+
+		for (size_t width = chunkSize; width < _count; width *= 2)
+		{
+			size_t mergeCount = (_count + 2 * width - 1) / (2 * width);
+			RunParallel(mergeCount, [&](size_t _merge)
+			{
+				size_t begin = _merge * 2 * width;
+				size_t middle = std::min(_count, begin + width);
+				size_t end = std::min(_count, begin + 2 * width);
+				std::inplace_merge(_indices + begin, _indices + middle, _indices + end, less);
+			}, threadCount);
+		}
+	}
+
+	size_t InstanceSorter::getThreadCount(size_t _count) const
+	{
+		if (_count < m_parallelThreshold)
+			return 1;
+
+		size_t threadCount = m_threadCount != 0 ? m_threadCount : std::thread::hardware_concurrency();
+		return std::max<size_t>(1, std::min(threadCount, _count / 1024 + 1));
+	}
+
+
+} // namespace mirror
+
+#endif
@@ -0,0 +1,577 @@
+#pragma once
+
+//*****************************************************************************
+// mirror traverse - parallel traversal of reflected object graphs
+//*****************************************************************************
+/*
+Walks the object graph reachable from a set of roots through reflected members (classes,
+fixed size arrays, sequences, associative containers, optionals, pointers and custom types)
+on several threads, and calls a visitor for every object reached: the roots, the pointees
+and the elements of dynamic containers. The visitor receives the path through which the
+object was first reached ("world.entities[3].target") and can return false to stop the walk
+below an object.
+
+Every object is visited once, the first time it is reached, so cycles and shared objects are
+fine: objects are identified by their address and type, which lets a pointer to an element of
+a container or to the first member of a class reach the same address as another object. Work is
+spread over the threads with work stealing: each thread walks its own queue depth first and
+steals the oldest pending allocations of the others when it runs out. Large containers are
+split so that their elements can be stolen too.
+
+Roots and pointees of polymorphic classes declaring MIRROR_GETCLASS_VIRTUAL() are visited and
+walked with their dynamic class.
+
+The visitor is called concurrently from all the threads, and the order of the visits and the
+path of objects reachable in several ways vary from one run to another.
+
+	bool Validate(const mirror::Type* _type, void* _instance, const char* _path, void* _userData)
+	{
+		if (_type == mirror::GetType<Entity>() && !static_cast<Entity*>(_instance)->isValid())
+			printf("invalid entity at %s\n", _path);
+		return true;
+	}
+
+	mirror::GraphTraversal traversal;
+	traversal.setVisitor(&Validate);
+	traversal.addRoot(&world, "world");
+	traversal.run();
+
+Custom types are opaque to mirror, like with mirror_census.h they need a visitor that gives
+their content to the traversal context:
+
+	void VisitArray(mirror::TraversalContext& _context, const mirror::Type* _type, void* _instance, void* _userData)
+	{
+		const ArrayType* arrayType = (const ArrayType*)_type;
+		_context.visitAllocation(arrayType->getSubType(), arrayType->getData(_instance), arrayType->getSize(_instance), true);
+	}
+	traversal.setCustomTypeVisitor("Array", &VisitArray);
+
+Like mirror.h, the implementation is compiled in the file that defines MIRROR_IMPLEMENTATION.
+*/
+
+#include "mirror.h"
+
+#include <deque>
+
+namespace mirror {
+
+	class GraphTraversal;
+
+	// Given to custom type visitors, one per thread
+	class MIRROR_API TraversalContext
+	{
+	public:
+		// A value embedded in the instance being visited, _name is appended to its path (".member", "[2]"...)
+		void visitValue(const Type* _type, void* _instance, const char* _name = "");
+		// A memory block owned or referenced by the instance being visited. Elements of arrays get their index appended to their path.
+		void visitAllocation(const Type* _type, void* _data, size_t _count = 1, bool _isArray = false);
+
+		const char* getPath() const { return m_path.c_str(); }
+
+	// internal
+		bool mayReference(const Type* _type);
+
+		GraphTraversal* m_traversal = nullptr;
+		size_t m_workerIndex = 0;
+		std::string m_path;
+		std::unordered_map<const Type*, bool> m_mayReference;
+	};
+
+	class MIRROR_API GraphTraversal
+	{
+	public:
+		// Return false to stop the walk below _instance
+		typedef bool (*Visitor)(const Type* _type, void* _instance, const char* _path, void* _userData);
+		typedef void (*CustomTypeVisitor)(TraversalContext& _context, const Type* _type, void* _instance, void* _userData);
+
+		void addRoot(const Type* _type, void* _instance, const char* _name = "root");
+		template <typename T> void addRoot(T* _instance, const char* _name = "root") { addRoot(GetType<T>(), _instance, _name); }
+
+		void setVisitor(Visitor _visitor, void* _userData = nullptr);
+		void setCustomTypeVisitor(const char* _customTypeName, CustomTypeVisitor _visitor, void* _userData = nullptr);
+		void setThreadCount(uint32_t _threadCount); // 0 (default) uses every hardware thread, 1 walks on the calling thread
+		void setBuildPaths(bool _buildPaths); // paths are empty when disabled, which saves string building
+
+		// Walks the graph from the roots, returns the number of visited objects. Can be called again after the graph changed.
+		size_t run();
+		void clear();
+
+	// internal
+		struct WorkItem
+		{
+			const Type* type;
+			uint8_t* data;
+			size_t count;
+			size_t firstIndex;
+			bool isArray;
+			std::string path;
+		};
+
+		struct WorkerQueue
+		{
+			std::mutex mutex;
+			std::deque<WorkItem> items;
+		};
+
+		struct VisitedHash
+		{
+			size_t operator()(const std::pair<const void*, const Type*>& _key) const
+			{
+				uintptr_t address = reinterpret_cast<uintptr_t>(_key.first);
+				return size_t(address ^ (address >> 17) ^ (reinterpret_cast<uintptr_t>(_key.second) * 31));
+			}
+		};
+
+		struct VisitedShard
+		{
+			std::mutex mutex;
+			std::unordered_set<std::pair<const void*, const Type*>, VisitedHash> objects;
+		};
+
+		struct Root
+		{
+			const Type* type;
+			void* instance;
+			std::string name;
+		};
+
+		struct CustomVisitor
+		{
+			CustomTypeVisitor visitor;
+			void* userData;
+		};
+
+		static const size_t VISITED_SHARD_COUNT = 64;
+		static const size_t SPLIT_THRESHOLD = 1024;
+
+		bool markVisited(const void* _address, const Type* _type);
+		void push(size_t _workerIndex, WorkItem&& _item);
+		bool pop(size_t _workerIndex, WorkItem& _outItem);
+		void runWorker(size_t _workerIndex);
+		void process(TraversalContext& _context, WorkItem& _item);
+		void walk(TraversalContext& _context, const Type* _type, void* _instance);
+
+		std::vector<Root> m_roots;
+		Visitor m_visitor = nullptr;
+		void* m_visitorUserData = nullptr;
+		std::unordered_map<uint32_t, CustomVisitor> m_customVisitors;
+		uint32_t m_threadCount = 0;
+		bool m_buildPaths = true;
+
+		std::vector<WorkerQueue> m_queues;
+		VisitedShard m_visited[VISITED_SHARD_COUNT];
+		std::atomic<size_t> m_pendingCount = { 0 };
+		std::atomic<size_t> m_visitedCount = { 0 };
+	};
+
+} // namespace mirror
+
+//*****************************************************************************
+// Implementation
+//*****************************************************************************
+
+#ifdef MIRROR_IMPLEMENTATION
+
+#include <algorithm>
+
+namespace mirror {
+
+	//-----------------------------------------------------------------------------
+	// TraversalContext
+	//-----------------------------------------------------------------------------
+
+	void TraversalContext::visitValue(const Type* _type, void* _instance, const char* _name)
+	{
+		if (_type == nullptr || _instance == nullptr)
+			return;
+
+		size_t pathSize = m_path.size();
+		if (m_traversal->m_buildPaths)
+		{
+			m_path += _name;
+		}
+		m_traversal->walk(*this, _type, _instance);
+		m_path.resize(pathSize);
+	}
+
+	void TraversalContext::visitAllocation(const Type* _type, void* _data, size_t _count, bool _isArray)
+	{
+		if (_type == nullptr || _data == nullptr || _count == 0)
+			return;
+
+		// void and function pointees have no size, they can't be walked. Elements of arrays are marked when they are visited.
+		if (_type->getSize() == 0 || (!_isArray && !m_traversal->markVisited(_data, _type)))
+			return;
+
+		m_traversal->push(m_workerIndex, { _type, static_cast<uint8_t*>(_data), _count, 0, _isArray, m_path });
+	}
+
+	bool TraversalContext::mayReference(const Type* _type)
+	{
+		auto it = m_mayReference.find(_type);
+		if (it != m_mayReference.end())
+			return it->second;
+
+		// Break recursion on self referencing classes, they will be answered by their pointer members anyway
+		m_mayReference[_type] = true;
+
+		bool result = false;
+		switch (_type->getTypeInfo())
+		{
+			case TypeInfo_Class:
+			{
+				for (ClassMember* member : _type->asClass()->getMembers())
+				{
+					Type* memberType = member->getType();
+					if (memberType != nullptr && mayReference(memberType))
+					{
+						result = true;
+						break;
+					}
+				}
+			}
+			break;
+
+			case TypeInfo_FixedSizeArray:
+			{
+				Type* subType = _type->asFixedSizeArray()->getSubType();
+				result = subType != nullptr && mayReference(subType);
+			}
+			break;
+
+			case TypeInfo_Pointer:
+			case TypeInfo_Associative:
+				result = true;
+				break;
+
+			case TypeInfo_Sequence:
+			{
+				const Sequence* sequence = _type->asSequence();
+				Type* subType = sequence->getSubType();
+				result = !sequence->isFixedSize() || (subType != nullptr && mayReference(subType));
+			}
+			break;
+
+			case TypeInfo_Optional:
+			{
+				Type* subType = _type->asOptional()->getSubType();
+				result = subType != nullptr && mayReference(subType);
+			}
+			break;
+
+			case TypeInfo_Custom:
+				result = _type->getCustomTypeName() != nullptr && m_traversal->m_customVisitors.find(HashCString(_type->getCustomTypeName())) != m_traversal->m_customVisitors.end();
+				break;
+
+			default:
+				break;
+		}
+
+		m_mayReference[_type] = result;
+		return result;
+	}
+
+	//-----------------------------------------------------------------------------
+	// GraphTraversal
+	//-----------------------------------------------------------------------------
+
+	void GraphTraversal::addRoot(const Type* _type, void* _instance, const char* _name)
+	{
+		assert(_type != nullptr && _name != nullptr);
+		if (_instance == nullptr)
+			return;
+
+		m_roots.push_back({ _type, _instance, _name });
+	}
+
+	void GraphTraversal::setVisitor(Visitor _visitor, void* _userData)
+	{
+		m_visitor = _visitor;
+		m_visitorUserData = _userData;
+	}
+
+	void GraphTraversal::setCustomTypeVisitor(const char* _customTypeName, CustomTypeVisitor _visitor, void* _userData)
+	{
+		assert(_customTypeName != nullptr);
+		m_customVisitors[HashCString(_customTypeName)] = { _visitor, _userData };
+	}
+
+	void GraphTraversal::setThreadCount(uint32_t _threadCount)
+	{
+		m_threadCount = _threadCount;
+	}
+
+	void GraphTraversal::setBuildPaths(bool _buildPaths)
+	{
+		m_buildPaths = _buildPaths;
+	}
+
+	size_t GraphTraversal::run()
+	{
+		size_t threadCount = m_threadCount != 0 ? m_threadCount : std::max(1u, std::thread::hardware_concurrency());
+
+		for (VisitedShard& shard : m_visited)
+		{
+			shard.objects.clear();
+		}
+		m_queues = std::vector<WorkerQueue>(threadCount);
+		m_pendingCount = 0;
+		m_visitedCount = 0;
+
+		// Roots are spread over the queues, threads steal from each other anyway
+		for (size_t i = 0; i < m_roots.size(); ++i)
+		{
+			const Root& root = m_roots[i];
+			const Type* type = GetDynamicType(root.type, root.instance);
+			if (type->getSize() > 0 && markVisited(root.instance, type))
+			{
+				push(i % threadCount, { type, static_cast<uint8_t*>(root.instance), 1, 0, false, m_buildPaths ? root.name : std::string() });
+			}
+		}
+
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < threadCount; ++i)
+		{
+			threads.emplace_back(&GraphTraversal::runWorker, this, i);
+		}
+		runWorker(0);
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		m_queues.clear();
+		return m_visitedCount;
+	}
+
+	void GraphTraversal::clear()
+	{
+		m_roots.clear();
+		for (VisitedShard& shard : m_visited)
+		{
+			shard.objects.clear();
+		}
+	}
+
+	bool GraphTraversal::markVisited(const void* _address, const Type* _type)
+	{
+		uintptr_t address = reinterpret_cast<uintptr_t>(_address);
+		size_t shardIndex = ((address >> 4) ^ (address >> 12)) % VISITED_SHARD_COUNT;
+		VisitedShard& shard = m_visited[shardIndex];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		return shard.objects.insert(std::make_pair(_address, _type)).second;
+	}
+
+	void GraphTraversal::push(size_t _workerIndex, WorkItem&& _item)
+	{
+		// Counted before being visible, so that no thread sees an empty graph while items are in flight
+		++m_pendingCount;
+		WorkerQueue& queue = m_queues[_workerIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.items.push_back(std::move(_item));
+	}
+
+	bool GraphTraversal::pop(size_t _workerIndex, WorkItem& _outItem)
+	{
+		// Newest own item first (depth first), then oldest item of the other queues
+		{
+			WorkerQueue& queue = m_queues[_workerIndex];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.items.empty())
+			{
+				_outItem = std::move(queue.items.back());
+				queue.items.pop_back();
+				return true;
+			}
+		}
+
+		for (size_t i = 1; i < m_queues.size(); ++i)
+		{
+			WorkerQueue& queue = m_queues[(_workerIndex + i) % m_queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.items.empty())
+			{
+				_outItem = std::move(queue.items.front());
+				queue.items.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void GraphTraversal::runWorker(size_t _workerIndex)
+	{
+		TraversalContext context;
+		context.m_traversal = this;
+		context.m_workerIndex = _workerIndex;
+
+		WorkItem item;
+		while (m_pendingCount.load() > 0)
+		{
+			if (!pop(_workerIndex, item))
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			process(context, item);
+			--m_pendingCount;
+		}
+	}
+
+	void GraphTraversal::process(TraversalContext& _context, WorkItem& _item)
+	{
+		// The second half of large arrays is left to be stolen
+		while (_item.count > SPLIT_THRESHOLD)
+		{
+			size_t half = _item.count / 2;
+			size_t elementSize = _item.type->getSize();
+			push(_context.m_workerIndex, { _item.type, _item.data + half * elementSize, _item.count - half, _item.firstIndex + half, _item.isArray, _item.path });
+			_item.count = half;
+		}
+
+		size_t elementSize = _item.type->getSize();
+		for (size_t i = 0; i < _item.count; ++i)
+		{
+			uint8_t* instance = _item.data + i * elementSize;
+			if (_item.isArray && !markVisited(instance, _item.type))
+				continue;
+
+			_context.m_path = _item.path;
+			if (_item.isArray && m_buildPaths)
+			{
+				_context.m_path += "[" + std::to_string(_item.firstIndex + i) + "]";
+			}
+
+			++m_visitedCount;
+			if (m_visitor != nullptr && !m_visitor(_item.type, instance, _context.m_path.c_str(), m_visitorUserData))
+				continue;
+
+			walk(_context, _item.type, instance);
+		}
+	}
+
+	void GraphTraversal::walk(TraversalContext& _context, const Type* _type, void* _instance)
+	{
+		if (!_context.mayReference(_type))
+			return;
+
+		switch (_type->getTypeInfo())
+		{
+			case TypeInfo_Class:
+			{
+				for (ClassMember* member : _type->asClass()->getMembers())
+				{
+					if (m_buildPaths)
+					{
+						std::string name = std::string(".") + member->getName();
+						_context.visitValue(member->getType(), member->getInstanceMemberPointer(_instance), name.c_str());
+					}
+					else
+					{
+						_context.visitValue(member->getType(), member->getInstanceMemberPointer(_instance));
+					}
+				}
+			}
+			break;
+
+			case TypeInfo_FixedSizeArray:
+			{
+				const FixedSizeArray* fixedSizeArray = _type->asFixedSizeArray();
+				for (size_t i = 0; i < fixedSizeArray->getElementCount(); ++i)
+				{
+					std::string name = m_buildPaths ? "[" + std::to_string(i) + "]" : std::string();
+					_context.visitValue(fixedSizeArray->getSubType(), fixedSizeArray->getDataAt(_instance, i), name.c_str());
+				}
+			}
+			break;
+
+			case TypeInfo_Pointer:
+			{
+				void* pointee = *reinterpret_cast<void**>(_instance);
+				_context.visitAllocation(GetDynamicType(_type->asPointer()->getSubType(), pointee), pointee, 1, false);
+			}
+			break;
+
+			case TypeInfo_Sequence:
+			{
+				const Sequence* sequence = _type->asSequence();
+				SequenceSpan span = sequence->getSpan(_instance);
+				if (sequence->isFixedSize())
+				{
+					for (size_t i = 0; i < span.count; ++i)
+					{
+						std::string name = m_buildPaths ? "[" + std::to_string(i) + "]" : std::string();
+						_context.visitValue(sequence->getSubType(), span.at(i), name.c_str());
+					}
+				}
+				else
+				{
+					_context.visitAllocation(sequence->getSubType(), span.data, span.count, true);
+				}
+			}
+			break;
+
+			case TypeInfo_Associative:
+			{
+				// Entries are separate allocations
+				const Associative* associative = _type->asAssociative();
+				const Type* keyType = associative->getKeyType();
+				const Type* valueType = associative->getValueType();
+				AssociativeCursor cursor(associative, _instance);
+				const void* keys[64];
+				void* values[64];
+				size_t index = 0;
+				size_t pathSize = _context.m_path.size();
+				while (size_t count = cursor.read(keys, values, 64))
+				{
+					for (size_t i = 0; i < count; ++i, ++index)
+					{
+						if (m_buildPaths)
+						{
+							_context.m_path += "[" + std::to_string(index) + "].key";
+						}
+						_context.visitAllocation(keyType, const_cast<void*>(keys[i]), 1, false);
+						if (m_buildPaths)
+						{
+							_context.m_path.resize(_context.m_path.size() - 3);
+							_context.m_path += "value";
+						}
+						_context.visitAllocation(valueType, values[i], 1, false);
+						_context.m_path.resize(pathSize);
+					}
+				}
+			}
+			break;
+
+			case TypeInfo_Optional:
+			{
+				const Optional* optional = _type->asOptional();
+				if (optional->hasValue(_instance))
+				{
+					_context.visitValue(optional->getSubType(), optional->getValue(_instance));
+				}
+			}
+			break;
+
+			case TypeInfo_Custom:
+			{
+				if (_type->getCustomTypeName() == nullptr)
+					break;
+
+				auto it = m_customVisitors.find(HashCString(_type->getCustomTypeName()));
+				if (it != m_customVisitors.end())
+				{
+					it->second.visitor(_context, _type, _instance, it->second.userData);
+				}
+			}
+			break;
+
+			default:
+				break;
+		}
+	}
+
+} // namespace mirror
+
+#endif
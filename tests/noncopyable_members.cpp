@@ -0,0 +1,83 @@
+//*****************************************************************************
+// Reflection of move-only members
+//*****************************************************************************
+/*
+std::is_copy_constructible is true for containers of move-only types and for classes holding
+them, but their copy constructor does not compile. Reflecting them must not instantiate it.
+Compiling this file is the check:
+
+	g++ -std=c++17 -I.. noncopyable_members.cpp -o noncopyable_members
+	./noncopyable_members
+*/
+
+#define MIRROR_IMPLEMENTATION
+#include <mirror.h>
+
+#include <cstdio>
+#include <memory>
+
+struct H
+{
+	std::vector<std::unique_ptr<int>> items;
+};
+MIRROR_CLASS(H)
+(
+	MIRROR_MEMBER(items);
+);
+
+struct Registry
+{
+	std::map<int, std::unique_ptr<int>> byID;
+	std::unordered_map<std::string, H> byName;
+};
+MIRROR_CLASS(Registry)
+(
+	MIRROR_MEMBER(byID);
+	MIRROR_MEMBER(byName);
+);
+
+struct Outer
+{
+	std::vector<H> children;
+};
+MIRROR_CLASS(Outer)
+(
+	MIRROR_MEMBER(children);
+);
+
+struct Node
+{
+	int value;
+	std::vector<Node> children;
+};
+MIRROR_CLASS(Node)
+(
+	MIRROR_MEMBER(value);
+	MIRROR_MEMBER(children);
+);
+
+static_assert(!mirror::IsCopyConstructible<std::vector<std::unique_ptr<int>>>(), "vector of move-only elements");
+static_assert(!mirror::IsCopyConstructible<H>(), "class with a move-only member");
+static_assert(!mirror::IsCopyConstructible<Outer>(), "class with a vector of classes with move-only members");
+static_assert(!mirror::IsCopyConstructible<Registry>(), "class with maps of move-only values");
+static_assert(mirror::IsCopyConstructible<Node>(), "recursive copyable class");
+static_assert(mirror::IsCopyConstructible<std::vector<std::string>>(), "vector of copyable elements");
+
+int main()
+{
+	if (mirror::GetClass<H>()->isCopyConstructible() || mirror::GetClass<Outer>()->isCopyConstructible() || !mirror::GetClass<Node>()->isCopyConstructible())
+	{
+		printf("noncopyable_members: wrong copyability\n");
+		return 1;
+	}
+	// Entries of maps of move-only values can't be inserted by copy
+	const mirror::Associative* byID = mirror::GetType<std::map<int, std::unique_ptr<int>>>()->asAssociative();
+	if (byID->m_functions.insert != nullptr || mirror::GetType<std::map<int, int>>()->asAssociative()->m_functions.insert == nullptr)
+	{
+		printf("noncopyable_members: wrong associative insert\n");
+		return 1;
+	}
+
+	printf("noncopyable_members: ok\n");
+	return 0;
+}
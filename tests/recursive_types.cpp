@@ -0,0 +1,133 @@
+//*****************************************************************************
+// Tools on self-referencing types
+//*****************************************************************************
+/*
+Types compiled by the tools can refer to themselves through containers, e.g. a Node holding
+a std::vector<Node>. Compiling them must terminate, and the compiled structures must walk
+the instances to any depth:
+
+	g++ -std=c++17 -I.. recursive_types.cpp -o recursive_types -lpthread
+	./recursive_types
+*/
+
+#define MIRROR_IMPLEMENTATION
+#include <mirror.h>
+#include <mirror_hashtable.h>
+#include <mirror_bitpack.h>
+
+#include <cstdio>
+
+struct Node
+{
+	int value;
+	std::vector<Node> children;
+};
+MIRROR_CLASS(Node)
+(
+	MIRROR_MEMBER(value);
+	MIRROR_MEMBER(children);
+);
+
+static int s_errorCount = 0;
+
+#define CHECK(_condition) \
+	if (!(_condition)) \
+	{ \
+		printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #_condition); \
+		++s_errorCount; \
+	}
+
+static Node MakeTree(int _value, int _depth)
+{
+	Node node = { _value, {} };
+	for (int i = 0; _depth > 0 && i < 3; ++i)
+	{
+		node.children.push_back(MakeTree(_value * 10 + i, _depth - 1));
+	}
+	return node;
+}
+
+static void TestHashTable()
+{
+	mirror::InstanceHasher hasher(mirror::GetClass<Node>());
+	Node a = MakeTree(1, 4);
+	Node b = MakeTree(1, 4);
+	CHECK(hasher.equals(&a, &b));
+	CHECK(hasher.hash(&a) == hasher.hash(&b));
+
+	// A difference deep in the tree
+	b.children[2].children[1].children[0].value = -1;
+	CHECK(!hasher.equals(&a, &b));
+
+	mirror::ReflectedHashTable table(mirror::GetClass<Node>());
+	table.insert(&a);
+	table.insert(&b);
+	Node c = MakeTree(1, 4);
+	CHECK(table.getCount() == 2);
+	CHECK(table.find(&c) != nullptr);
+}
+
+static bool IsSameTree(const Node& _a, const Node& _b)
+{
+	if (_a.value != _b.value || _a.children.size() != _b.children.size())
+	{
+		return false;
+	}
+	for (size_t i = 0; i < _a.children.size(); ++i)
+	{
+		if (!IsSameTree(_a.children[i], _b.children[i]))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static void TestBitPack()
+{
+	std::shared_ptr<const mirror::BitPackCodec> codec = mirror::GetBitPackCodec(mirror::GetType<Node>());
+	Node tree = MakeTree(1, 4);
+
+	mirror::BitWriter writer;
+	codec->encode(&tree, writer);
+	writer.flush();
+	mirror::BitReader reader(writer.getData(), writer.getByteCount());
+	Node decoded = {};
+	CHECK(codec->decode(reader, &decoded));
+	CHECK(IsSameTree(tree, decoded));
+
+	mirror::BitWriter sparseWriter;
+	codec->encodeSparse(&tree, sparseWriter);
+	sparseWriter.flush();
+	mirror::BitReader sparseReader(sparseWriter.getData(), sparseWriter.getByteCount());
+	Node sparseDecoded = {};
+	CHECK(codec->decodeSparse(sparseReader, &sparseDecoded));
+	CHECK(IsSameTree(tree, sparseDecoded));
+
+	// One byte at a time
+	mirror::BitPackStreamDecoder decoder(codec);
+	Node streamed = {};
+	decoder.begin(&streamed);
+	const uint8_t* data = static_cast<const uint8_t*>(writer.getData());
+	for (size_t i = 0; i < writer.getByteCount() && decoder.step() == mirror::BitPackStreamDecoder::Status_NeedInput; ++i)
+	{
+		decoder.feed(data + i, 1);
+	}
+	decoder.endInput();
+	CHECK(decoder.step() == mirror::BitPackStreamDecoder::Status_Done);
+	CHECK(IsSameTree(tree, streamed));
+}
+
+int main()
+{
+	TestHashTable();
+	TestBitPack();
+
+	if (s_errorCount > 0)
+	{
+		printf("recursive_types: %d check(s) failed\n", s_errorCount);
+		return 1;
+	}
+	printf("recursive_types: ok\n");
+	return 0;
+}
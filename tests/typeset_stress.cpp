@@ -0,0 +1,148 @@
+//*****************************************************************************
+// TypeSet concurrency stress test
+//*****************************************************************************
+/*
+Several threads lazily create the same pointer and sequence types with GetType<T>(), while
+another thread keeps registering and removing classes derived from a reflected class, and
+others look types up by ID and by name and walk the class hierarchy, reading the names of the
+classes they find. Meant to be run under ThreadSanitizer:
+
+	g++ -std=c++17 -g -fsanitize=thread -I.. typeset_stress.cpp -o typeset_stress -lpthread
+	./typeset_stress
+*/
+
+#define MIRROR_IMPLEMENTATION
+#include <mirror.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+struct Base
+{
+	int id;
+};
+MIRROR_CLASS(Base)
+(
+	MIRROR_MEMBER(id);
+);
+
+template <int N> struct Element { int value; };
+template <int N> struct Dynamic : Base {};
+
+static const int LAZY_TYPE_COUNT = 64;
+static const int DYNAMIC_CLASS_COUNT = 16;
+static const int CHURN_ITERATION_COUNT = 500;
+static const int LOOKUP_THREAD_COUNT = 4;
+
+static std::atomic<int> s_errorCount = { 0 };
+
+#define CHECK(_condition) \
+	if (!(_condition)) \
+	{ \
+		printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #_condition); \
+		++s_errorCount; \
+	}
+
+template <int... N>
+void GetLazyTypes(std::vector<mirror::Type*>& _outTypes, std::integer_sequence<int, N...>)
+{
+	_outTypes = { mirror::GetType<Element<N>*>()..., mirror::GetType<std::vector<Element<N>>>()... };
+}
+
+template <int... N>
+void CreateDynamicClasses(std::vector<mirror::Class*>& _outClasses, std::integer_sequence<int, N...>)
+{
+	(void)std::initializer_list<int>{ (_outClasses.push_back(new mirror::Class(("Dynamic" + std::to_string(N)).c_str(), "")), 0)... };
+	(void)std::initializer_list<int>{ (_outClasses[N]->createVirtualTypeWrapper<Dynamic<N>>(), 0)... };
+	for (mirror::Class* clss : _outClasses)
+	{
+		clss->addParent(mirror::GetTypeID<Base>());
+	}
+}
+
+int main()
+{
+	mirror::Class* base = mirror::GetClass<Base>();
+	std::atomic<bool> stop = { false };
+
+	std::vector<std::vector<mirror::Type*>> lazyTypes(LOOKUP_THREAD_COUNT);
+	std::vector<std::thread> threads;
+	for (int i = 0; i < LOOKUP_THREAD_COUNT; ++i)
+	{
+		threads.emplace_back([&lazyTypes, i]()
+		{
+			GetLazyTypes(lazyTypes[i], std::make_integer_sequence<int, LAZY_TYPE_COUNT>());
+		});
+	}
+
+	// Removed classes are only deleted at the end, other threads may still be using them
+	std::vector<mirror::Class*> dynamicClasses;
+	CreateDynamicClasses(dynamicClasses, std::make_integer_sequence<int, DYNAMIC_CLASS_COUNT>());
+	threads.emplace_back([&stop, &dynamicClasses]()
+	{
+		for (int i = 0; i < CHURN_ITERATION_COUNT; ++i)
+		{
+			for (mirror::Class* clss : dynamicClasses)
+			{
+				mirror::GetTypeSet().addType(clss);
+			}
+			for (mirror::Class* clss : dynamicClasses)
+			{
+				mirror::GetTypeSet().removeType(clss);
+			}
+		}
+		stop = true;
+	});
+
+	for (int i = 0; i < 2; ++i)
+	{
+		threads.emplace_back([&stop, base]()
+		{
+			while (!stop)
+			{
+				CHECK(mirror::FindTypeByID(mirror::GetTypeID<Base>()) == base);
+				CHECK(mirror::FindTypeByName("Base") == base);
+
+				std::set<mirror::TypeID> children = base->getChildren();
+				CHECK(children.size() <= size_t(DYNAMIC_CLASS_COUNT));
+				for (mirror::TypeID childID : children)
+				{
+					// The child may have been removed in the meantime, its name stays valid
+					mirror::Class* child = mirror::AsClass(childID);
+					CHECK(child == nullptr || (child->isChildOf(base) && strncmp(child->getName(), "Dynamic", 7) == 0));
+				}
+			}
+		});
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	for (mirror::Class* clss : dynamicClasses)
+	{
+		delete clss;
+	}
+
+	// Every thread got the same registered types
+	for (const std::vector<mirror::Type*>& types : lazyTypes)
+	{
+		CHECK(types.size() == size_t(LAZY_TYPE_COUNT * 2));
+		for (size_t i = 0; i < types.size(); ++i)
+		{
+			CHECK(types[i] != nullptr && types[i] == lazyTypes[0][i]);
+			CHECK(types[i] == mirror::FindTypeByID(types[i]->getTypeID()));
+		}
+	}
+	CHECK(base->getChildren().empty());
+
+	if (s_errorCount > 0)
+	{
+		printf("typeset_stress: %d check(s) failed\n", s_errorCount.load());
+		return 1;
+	}
+	printf("typeset_stress: ok\n");
+	return 0;
+}